@@ -187,12 +187,19 @@ rcl_guard_condition_get_default_options(void);
  *
  * A guard condition can be triggered from any thread.
  *
+ * Triggering a guard condition which was created by rcl_guard_condition_init()
+ * again, before rcl_wait() waited on it, only costs an atomic operation and
+ * does not reach the middleware.
+ * Guard conditions created with rcl_guard_condition_init_from_rmw() are
+ * always triggered in the middleware, since they may be waited on without
+ * rcl_wait().
+ *
  * <hr>
  * Attribute          | Adherence
  * ------------------ | -------------
  * Allocates Memory   | Yes
  * Thread-Safe        | No [1]
- * Uses Atomics       | No
+ * Uses Atomics       | Yes
  * Lock-Free          | Yes
  * <i>[1] it can be called concurrently with itself, even on the same guard condition</i>
  *
@@ -0,0 +1,92 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file
+
+#ifndef RCL__INTRA_PROCESS_H_
+#define RCL__INTRA_PROCESS_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "rcl/macros.h"
+#include "rcl/visibility_control.h"
+
+/// Reference counted ROS message delivered within a process, see rcl_publish_shared().
+/**
+ * A shared message is delivered by reference to every intra-process
+ * subscription of the same context which matches its publisher, without
+ * being serialized.
+ * Each subscription which takes it owns a reference, which must be given up
+ * with rcl_shared_message_release().
+ * The ROS message is finalized by its deleter once the last reference is
+ * released.
+ */
+typedef struct rcl_shared_message_s rcl_shared_message_t;
+
+/// Function finalizing and deallocating a ROS message published with rcl_publish_shared().
+/**
+ * \param[in] ros_message the ROS message to delete
+ * \param[in] state the deleter state given to rcl_publish_shared()
+ */
+typedef void (* rcl_shared_message_deleter_t)(void * ros_message, void * state);
+
+/// Return the ROS message referenced by a shared message.
+/**
+ * The ROS message must not be modified, as it may be read concurrently by
+ * other subscriptions and by the middleware.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] shared_message the shared message
+ * \return the ROS message, or `NULL` if `shared_message` is `NULL`.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+const void *
+rcl_shared_message_get_ros_message(const rcl_shared_message_t * shared_message);
+
+/// Give up a reference to a shared message.
+/**
+ * The ROS message is passed to its deleter, from the calling thread, when the
+ * last reference is released.
+ * The shared message must not be used after this call.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[in] shared_message the shared message to release, ignored if `NULL`
+ */
+RCL_PUBLIC
+void
+rcl_shared_message_release(rcl_shared_message_t * shared_message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__INTRA_PROCESS_H_
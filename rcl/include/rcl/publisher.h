@@ -24,6 +24,7 @@ extern "C"
 
 #include "rosidl_runtime_c/message_type_support_struct.h"
 
+#include "rcl/intra_process.h"
 #include "rcl/macros.h"
 #include "rcl/node.h"
 #include "rcl/visibility_control.h"
@@ -51,8 +52,32 @@ typedef struct rcl_publisher_options_s
   rmw_publisher_options_t rmw_publisher_options;
   /// Disable flag to LoanedMessage, initialized via environmental variable.
   bool disable_loaned_message;
+  /// Number of messages loaned by rcl when the middleware cannot loan, or 0 for none.
+  /**
+   * The messages are allocated and initialized at rcl_publisher_init() and
+   * recycled once published or returned, so rcl_borrow_loaned_message() does
+   * not allocate memory with any middleware.
+   * The message type must have a C introspection type support, otherwise
+   * initialization fails with #RCL_RET_UNSUPPORTED.
+   */
+  size_t loaned_message_pool_size;
+  /// Deliver messages published with rcl_publish_shared() by reference within the context.
+  bool enable_intra_process;
 } rcl_publisher_options_t;
 
+/// Counts of the messages published by a publisher, see rcl_publisher_get_statistics().
+typedef struct rcl_publisher_statistics_s
+{
+  /// Number of messages published, by any of the rcl_publish*() functions.
+  uint64_t published_count;
+  /// Number of bytes published as serialized messages.
+  uint64_t published_serialized_bytes;
+  /// Number of messages whose publication failed.
+  uint64_t publish_error_count;
+  /// Number of messages loaned with rcl_borrow_loaned_message().
+  uint64_t loaned_message_count;
+} rcl_publisher_statistics_t;
+
 /// Return a rcl_publisher_t struct with members set to `NULL`.
 /**
  * Should be called to get a null rcl_publisher_t before passing to
@@ -197,6 +222,8 @@ rcl_publisher_fini(rcl_publisher_t * publisher, rcl_node_t * node);
  * - allocator = rcl_get_default_allocator()
  * - rmw_publisher_options = rmw_get_default_publisher_options()
  * - disable_loaned_message = false, true only if ROS_DISABLE_LOANED_MESSAGES=1
+ * - loaned_message_pool_size = 0
+ * - enable_intra_process = false
  *
  * \return A structure with the default publisher options.
  */
@@ -210,6 +237,13 @@ rcl_publisher_get_default_options(void);
  * The memory allocated for the ros message belongs to the middleware and must not be deallocated
  * other than by a call to \sa rcl_return_loaned_message_from_publisher.
  *
+ * If the middleware cannot loan messages and the publisher was created with a
+ * rcl_publisher_options_t::loaned_message_pool_size, the message is borrowed
+ * from the pool of the publisher instead, and may still hold the content it was
+ * last published with.
+ * The pooled messages have the type of the publisher, so `type_support` must
+ * be a type support of that same type.
+ *
  * <hr>
  * Attribute          | Adherence
  * ------------------ | -------------
@@ -225,7 +259,8 @@ rcl_publisher_get_default_options(void);
  * \param[out] ros_message The pointer to be filled to a valid ros message by the middleware.
  * \return #RCL_RET_OK if the ros message was correctly initialized, or
  * \return #RCL_RET_PUBLISHER_INVALID if the passed publisher is invalid, or
- * \return #RCL_RET_INVALID_ARGUMENT if an argument other than the ros message is null, or
+ * \return #RCL_RET_INVALID_ARGUMENT if an argument other than the ros message is null,
+ *   or if the message is borrowed from the pool and `type_support` is of another type, or
  * \return #RCL_RET_BAD_ALLOC if the ros message could not be correctly created, or
  * \return #RCL_RET_UNSUPPORTED if the middleware does not support that feature, or
  * \return #RCL_RET_ERROR if an unexpected error occured.
@@ -332,6 +367,50 @@ rcl_publish(
   const void * ros_message,
   rmw_publisher_allocation_t * allocation);
 
+/// Publish an array of ROS messages on a topic using a publisher.
+/**
+ * This function behaves like calling rcl_publish() on each message in order,
+ * but the publisher and its context are validated once for the whole batch
+ * instead of once per message.
+ * It is meant for publishers which emit bursts of messages, e.g. the tiles of
+ * a point cloud or the frames of a CAN bus.
+ *
+ * A message which fails to be published does not stop the batch, the
+ * remaining messages are still published.
+ * If `results` is not `NULL`, it must hold `count` elements, and each element
+ * is set to the value rcl_publish() would have returned for the message at
+ * the same index.
+ * When several messages fail, the error message of the last failure is kept.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes [1]
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ * <i>[1] for unique pairs of publishers and messages, see rcl_publish()</i>
+ *
+ * \param[in] publisher handle to the publisher which will do the publishing
+ * \param[in] ros_messages array of type-erased pointers to the ROS messages
+ * \param[in] count number of messages in `ros_messages`
+ * \param[out] results the result of publishing each message (may be NULL)
+ * \param[in] allocation structure pointer, used for memory preallocation (may be NULL)
+ * \return #RCL_RET_OK if all the messages were published successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_PUBLISHER_INVALID if the publisher is invalid, or
+ * \return #RCL_RET_ERROR if any message failed to be published.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_publish_batch(
+  const rcl_publisher_t * publisher,
+  const void * const * ros_messages,
+  size_t count,
+  rcl_ret_t * results,
+  rmw_publisher_allocation_t * allocation);
+
 /// Publish a serialized message on a topic using a publisher.
 /**
  * It is the job of the caller to ensure that the type of the serialized message
@@ -372,6 +451,41 @@ rcl_publish_serialized_message(
   const rcl_serialized_message_t * serialized_message,
   rmw_publisher_allocation_t * allocation);
 
+/// Publish an array of serialized messages on a topic using a publisher.
+/**
+ * This function is to rcl_publish_serialized_message() what
+ * rcl_publish_batch() is to rcl_publish().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes [1]
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ * <i>[1] for unique pairs of publishers and messages, see rcl_publish()</i>
+ *
+ * \param[in] publisher handle to the publisher which will do the publishing
+ * \param[in] serialized_messages array of the already serialized messages in raw form
+ * \param[in] count number of messages in `serialized_messages`
+ * \param[out] results the result of publishing each message (may be NULL)
+ * \param[in] allocation structure pointer, used for memory preallocation (may be NULL)
+ * \return #RCL_RET_OK if all the messages were published successfully, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed for any message, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_PUBLISHER_INVALID if the publisher is invalid, or
+ * \return #RCL_RET_ERROR if any message failed to be published.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_publish_serialized_batch(
+  const rcl_publisher_t * publisher,
+  const rcl_serialized_message_t * serialized_messages,
+  size_t count,
+  rcl_ret_t * results,
+  rmw_publisher_allocation_t * allocation);
+
 /// Publish a loaned message on a topic using a publisher.
 /**
  * A previously borrowed loaned message can be sent via this call to rcl_publish_loaned_message().
@@ -384,6 +498,8 @@ rcl_publish_serialized_message(
  *
  * Apart from this, the `publish_loaned_message` function has the same behavior as rcl_publish()
  * except that no serialization step is done.
+ * A message borrowed from the pool of the publisher is published with a copy
+ * and goes back to the pool, even if publishing failed.
  *
  * <hr>
  * Attribute          | Adherence
@@ -413,6 +529,70 @@ rcl_publish_loaned_message(
   void * ros_message,
   rmw_publisher_allocation_t * allocation);
 
+/// Publish a ROS message by reference to the subscriptions of the same context.
+/**
+ * The publisher must have been initialized with
+ * rcl_publisher_options_t::enable_intra_process set.
+ *
+ * The message is wrapped into a reference counted rcl_shared_message_t, which
+ * is pushed into the queue of every subscription of the same context which
+ * has intra-process enabled, and matches the topic and type of the publisher
+ * with a compatible quality of service.
+ * Those subscriptions take it with rcl_take_shared(), without the message
+ * being copied or serialized.
+ * The queue of a subscription holds as many messages as the depth of its
+ * quality of service, and the oldest message is dropped when it is full.
+ *
+ * The message is only handed to the middleware when subscriptions outside of
+ * the intra-process subscriptions are matched, e.g. in other processes.
+ * Their number is queried from the middleware at most every 100 milliseconds,
+ * and whenever the intra-process subscriptions of the publisher change.
+ * As during discovery, a subscription matched meanwhile may miss messages,
+ * and so may one matched before the middleware matched every intra-process
+ * subscription.
+ *
+ * Intra-process subscriptions drop the copies the middleware delivers from
+ * the publishers which deliver to them by reference, so no message is
+ * received twice.
+ * For the same reason, they do not receive the messages published with
+ * rcl_publish() and the other publish functions by such a publisher, while
+ * they do receive those of any other publisher.
+ *
+ * The ownership of the message is transferred to rcl, even if an error is
+ * returned.
+ * It must not be modified after this call, and it is passed to `deleter`
+ * once every subscription has released it.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | No [1]
+ * <i>[1] the subscriptions are matched when they are created, so delivering to
+ * them does not lock, but the middleware may lock</i>
+ *
+ * \param[in] publisher handle to the publisher which will do the publishing
+ * \param[in] ros_message type-erased pointer to the ROS message, owned by rcl afterwards
+ * \param[in] deleter function finalizing and deallocating the message (may be NULL)
+ * \param[in] deleter_state state passed to the deleter (may be NULL)
+ * \return #RCL_RET_OK if the message was published successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_PUBLISHER_INVALID if the publisher is invalid, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed, or
+ * \return #RCL_RET_ERROR if intra-process is not enabled for the publisher,
+ *   or if an unspecified error occurs.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_publish_shared(
+  const rcl_publisher_t * publisher,
+  void * ros_message,
+  rcl_shared_message_deleter_t deleter,
+  void * deleter_state);
+
 /// Manually assert that this Publisher is alive (for RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC)
 /**
  * If the rmw Liveliness policy is set to RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC, the creator of
@@ -685,11 +865,45 @@ rcl_publisher_get_actual_qos(const rcl_publisher_t * publisher);
 /**
  * Depending on the middleware and the message type, this will return true if the middleware
  * can allocate a ROS message instance.
+ * It also returns true if the publisher loans messages from its own pool, see
+ * rcl_publisher_options_t::loaned_message_pool_size.
  */
 RCL_PUBLIC
 bool
 rcl_publisher_can_loan_messages(const rcl_publisher_t * publisher);
 
+/// Retrieve the counts of the messages published by the publisher.
+/**
+ * The counts are kept from rcl_publisher_init() on, for every publisher, at
+ * the cost of a relaxed atomic increment per published message.
+ * Messages published as ROS messages are counted but their size is not, as it
+ * is only known to the middleware once serialized.
+ *
+ * The counters can be removed by building rcl with `RCL_DISABLE_STATISTICS`,
+ * in which case this function always fails with #RCL_RET_UNSUPPORTED.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[in] publisher the handle to the publisher
+ * \param[out] statistics the struct to which the counts are copied
+ * \return #RCL_RET_OK if the counts were successfully retrieved, or
+ * \return #RCL_RET_PUBLISHER_INVALID if the publisher is invalid, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_UNSUPPORTED if rcl was built without the counters.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_publisher_get_statistics(
+  const rcl_publisher_t * publisher,
+  rcl_publisher_statistics_t * statistics);
+
 #ifdef __cplusplus
 }
 #endif
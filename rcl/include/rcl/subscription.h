@@ -25,6 +25,8 @@ extern "C"
 #include "rosidl_runtime_c/message_type_support_struct.h"
 
 #include "rcl/event_callback.h"
+#include "rcl/guard_condition.h"
+#include "rcl/intra_process.h"
 #include "rcl/macros.h"
 #include "rcl/node.h"
 #include "rcl/visibility_control.h"
@@ -54,8 +56,61 @@ typedef struct rcl_subscription_options_s
   rmw_subscription_options_t rmw_subscription_options;
   /// Disable flag to LoanedMessage, initialized via environmental variable.
   bool disable_loaned_message;
+  /// Number of messages loaned by rcl when the middleware cannot loan, or 0 for none.
+  /**
+   * The messages are allocated and initialized at rcl_subscription_init() and
+   * recycled once returned, so rcl_take_loaned_message() does not allocate
+   * memory with any middleware.
+   * The message type must have a C introspection type support, otherwise
+   * initialization fails with #RCL_RET_UNSUPPORTED.
+   */
+  size_t loaned_message_pool_size;
+  /// Number of serialized messages pooled by the subscription, or 0 for no pool.
+  /**
+   * Pooled serialized messages are borrowed with
+   * rcl_subscription_borrow_serialized_message() or filled by
+   * rcl_take_serialized_sequence(), and keep their buffers once returned.
+   */
+  size_t serialized_message_pool_size;
+  /// Initial capacity in bytes of the buffer of each pooled serialized message.
+  /**
+   * A buffer grows when a larger message is taken into it, so this is only a
+   * hint to avoid growing the buffers while the first messages are taken.
+   */
+  size_t serialized_message_capacity;
+  /// Receive messages published with rcl_publish_shared() by reference within the context.
+  /**
+   * The take functions then drop the messages the middleware delivers from
+   * publishers which also deliver to the subscription by reference.
+   */
+  bool enable_intra_process;
 } rcl_subscription_options_t;
 
+/// Maximum number of messages dropped by rcl in one take.
+/**
+ * rcl drops the messages which do not match a content filter it evaluates, see
+ * rcl_subscription_set_content_filter(), and the messages it already delivered
+ * with rcl_publish_shared().
+ * A take which drops this many messages returns `RCL_RET_SUBSCRIPTION_TAKE_FAILED`,
+ * leaving the next messages to the next takes.
+ */
+#define RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE 64u
+
+/// Counts of the messages taken by a subscription, see rcl_subscription_get_statistics().
+typedef struct rcl_subscription_statistics_s
+{
+  /// Number of messages taken, by any of the rcl_take*() functions.
+  uint64_t taken_count;
+  /// Number of bytes taken as serialized messages.
+  uint64_t taken_serialized_bytes;
+  /// Number of takes which found no message, typically after a spurious wake up.
+  uint64_t take_failed_count;
+  /// Number of messages taken with rcl_take_loaned_message().
+  uint64_t loaned_message_count;
+  /// Number of messages dropped by rcl, see #RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE.
+  uint64_t dropped_count;
+} rcl_subscription_statistics_t;
+
 typedef struct rcl_subscription_content_filter_options_s
 {
   rmw_subscription_content_filter_options_t rmw_subscription_content_filter_options;
@@ -210,6 +265,10 @@ rcl_subscription_fini(rcl_subscription_t * subscription, rcl_node_t * node);
  * - allocator = rcl_get_default_allocator()
  * - rmw_subscription_options = rmw_get_default_subscription_options();
  * - disable_loaned_message = true, false only if ROS_DISABLE_LOANED_MESSAGES=0
+ * - loaned_message_pool_size = 0
+ * - serialized_message_pool_size = 0
+ * - serialized_message_capacity = 0
+ * - enable_intra_process = false
  *
  * \return A structure containing the default options for a subscription.
  */
@@ -369,6 +428,8 @@ rcl_subscription_content_filter_options_fini(
 /// Check if the content filtered topic feature is enabled in the subscription.
 /**
  * Depending on the middleware and whether cft is enabled in the subscription.
+ * If the middleware cannot filter messages, rcl evaluates the filter itself, see
+ * rcl_subscription_set_content_filter().
  *
  * \return `true` if the content filtered topic of `subscription` is enabled, otherwise `false`
  */
@@ -382,6 +443,20 @@ rcl_subscription_is_cft_enabled(const rcl_subscription_t * subscription);
  * This function will set a filter expression and an array of expression parameters
  * for the given subscription.
  *
+ * If the middleware does not support content filtering, the expression is
+ * compiled and evaluated by rcl on every message taken from the subscription,
+ * before it is handed out, and messages which do not match it are dropped.
+ * This requires the C introspection type support of the message type.
+ * rcl supports the comparison operators, `LIKE`, `BETWEEN`, `AND`, `OR`, `NOT`
+ * and parentheses of the DDS-SQL filter grammar, on fields of primitive and
+ * string types which may be nested in messages, but not in arrays.
+ * Messages delivered by rcl_publish_shared() are not filtered.
+ * A take drops at most #RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE messages,
+ * and then returns `RCL_RET_SUBSCRIPTION_TAKE_FAILED`.
+ * If rcl cannot compile the expression, this function returns
+ * `RCL_RET_INVALID_ARGUMENT`, not the `RCL_RET_UNSUPPORTED` of the middleware,
+ * and the subscription keeps its previous filter, if any.
+ *
  * <hr>
  * Attribute          | Adherence
  * ------------------ | -------------
@@ -395,7 +470,8 @@ rcl_subscription_is_cft_enabled(const rcl_subscription_t * subscription);
  * \return `RCL_RET_OK` if the query was successful, or
  * \return `RCL_RET_INVALID_ARGUMENT` if `subscription` is NULL, or
  * \return `RCL_RET_INVALID_ARGUMENT` if `options` is NULL, or
- * \return `RCL_RET_UNSUPPORTED` if the implementation does not support content filter topic, or
+ * \return `RCL_RET_INVALID_ARGUMENT` if rcl cannot compile the filter expression, or
+ * \return `RCL_RET_UNSUPPORTED` if neither the implementation nor rcl can filter the type, or
  * \return `RCL_RET_ERROR` if an unspecified error occurs.
  */
 RCL_PUBLIC
@@ -437,6 +513,42 @@ rcl_subscription_get_content_filter(
   rcl_subscription_content_filter_options_t * options
 );
 
+/// Counters of the content filter evaluated by rcl for a subscription.
+typedef struct rcl_subscription_content_filter_statistics_s
+{
+  /// Number of taken messages which matched the filter.
+  uint64_t matched_count;
+  /// Number of taken messages which did not match the filter, and were dropped.
+  uint64_t filtered_count;
+} rcl_subscription_content_filter_statistics_t;
+
+/// Retrieve the counters of the content filter evaluated by rcl.
+/**
+ * Only messages filtered by rcl, rather than by the middleware, are counted,
+ * see rcl_subscription_set_content_filter().
+ * The counters are kept when the filter expression changes.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[in] subscription The subscription object to inspect.
+ * \param[out] statistics The counters of the filter.
+ * \return `RCL_RET_OK` if the query was successful, or
+ * \return `RCL_RET_SUBSCRIPTION_INVALID` if `subscription` is invalid, or
+ * \return `RCL_RET_INVALID_ARGUMENT` if `statistics` is NULL.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_subscription_get_content_filter_statistics(
+  const rcl_subscription_t * subscription,
+  rcl_subscription_content_filter_statistics_t * statistics);
+
 /// Take a ROS message from a topic using a rcl subscription.
 /**
  * It is the job of the caller to ensure that the type of the ros_message
@@ -600,6 +712,176 @@ rcl_take_serialized_message(
   rmw_message_info_t * message_info,
   rmw_subscription_allocation_t * allocation);
 
+/// Take a sequence of serialized messages into pooled buffers of a rcl subscription.
+/**
+ * In contrast to rcl_take_serialized_message(), this function can take
+ * multiple messages at the same time, and takes them into serialized messages
+ * borrowed from the pool of the subscription instead of caller owned ones.
+ * The subscription must have been initialized with a non-zero
+ * rcl_subscription_options_t::serialized_message_pool_size.
+ *
+ * Up to `count` messages are taken, but no more than the number of pooled
+ * serialized messages which are not borrowed.
+ * For each taken message, a pointer to its pooled serialized message is
+ * stored in `serialized_messages`, and its meta-data is stored at the same
+ * index of `message_info_sequence`, whose `size` member is set to the number
+ * of messages taken.
+ * The taken serialized messages are borrowed, and must be given back with
+ * rcl_subscription_return_serialized_message() once they are no longer
+ * used, which keeps their buffers for later takes.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Maybe [1]
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ * <i>[1] only if a pooled buffer is too small for a taken message</i>
+ *
+ * \param[in] subscription the handle to the subscription from which to take
+ * \param[in] count number of messages to attempt to take
+ * \param[out] serialized_messages array of at least `count` pointers, set to the taken messages
+ * \param[inout] message_info_sequence pointer to a (pre-allocated) message info sequence
+ * \param[in] allocation structure pointer used for memory preallocation (may be NULL)
+ * \return #RCL_RET_OK if one or more messages was taken, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_SUBSCRIPTION_INVALID if the subscription is invalid, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed, or
+ * \return #RCL_RET_SUBSCRIPTION_TAKE_FAILED if take failed but no error
+ *         occurred in the middleware, or
+ * \return #RCL_RET_ERROR if the subscription has no pool, if all of its
+ *         serialized messages are borrowed, or if an unspecified error occurs.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_take_serialized_sequence(
+  const rcl_subscription_t * subscription,
+  size_t count,
+  rcl_serialized_message_t ** serialized_messages,
+  rmw_message_info_sequence_t * message_info_sequence,
+  rmw_subscription_allocation_t * allocation);
+
+/// Borrow a serialized message from the pool of a rcl subscription.
+/**
+ * The borrowed serialized message keeps the buffer it had when it was last
+ * returned, and can be passed to rcl_take_serialized_message().
+ * It must be given back with rcl_subscription_return_serialized_message(),
+ * and must not be used after the subscription is finalized.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] subscription the handle to the subscription which owns the pool
+ * \param[out] serialized_message set to the borrowed serialized message
+ * \return #RCL_RET_OK if a serialized message was borrowed, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_SUBSCRIPTION_INVALID if the subscription is invalid, or
+ * \return #RCL_RET_ERROR if the subscription has no pool, or if all of its
+ *         serialized messages are borrowed.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_subscription_borrow_serialized_message(
+  const rcl_subscription_t * subscription,
+  rcl_serialized_message_t ** serialized_message);
+
+/// Give a borrowed serialized message back to the pool of a rcl subscription.
+/**
+ * The length of the serialized message is reset, but its buffer is kept so
+ * that later takes into it do not allocate.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] subscription the handle to the subscription which owns the pool
+ * \param[in] serialized_message the serialized message to give back
+ * \return #RCL_RET_OK if the serialized message was given back, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or if the
+ *         serialized message is not a borrowed message of this pool, or
+ * \return #RCL_RET_SUBSCRIPTION_INVALID if the subscription is invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_subscription_return_serialized_message(
+  const rcl_subscription_t * subscription,
+  rcl_serialized_message_t * serialized_message);
+
+/// Take a shared message published within the same context using a rcl subscription.
+/**
+ * The subscription must have been initialized with
+ * rcl_subscription_options_t::enable_intra_process set.
+ * The oldest message of its intra-process queue is taken, see
+ * rcl_publish_shared().
+ *
+ * The taken message is referenced rather than copied, and must be released
+ * with rcl_shared_message_release() once it is no longer used.
+ * Messages from other publishers, in the context or outside of it, are still
+ * taken with rcl_take() and the other take functions.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[in] subscription the handle to the subscription from which to take
+ * \param[out] shared_message set to the taken message
+ * \return #RCL_RET_OK if a message was taken, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_SUBSCRIPTION_INVALID if the subscription is invalid, or
+ * \return #RCL_RET_SUBSCRIPTION_TAKE_FAILED if no message was queued, or
+ * \return #RCL_RET_ERROR if intra-process is not enabled for the subscription.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_take_shared(
+  const rcl_subscription_t * subscription,
+  rcl_shared_message_t ** shared_message);
+
+/// Return the guard condition triggered when a shared message is queued for a subscription.
+/**
+ * Messages published with rcl_publish_shared() do not make the subscription
+ * ready in rcl_wait(), as they bypass the middleware.
+ * This guard condition should be added to the wait set next to the
+ * subscription, and rcl_take_shared() called when it is ready.
+ *
+ * The guard condition is owned by the subscription, and is valid until the
+ * subscription is finalized.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] subscription the handle to the subscription
+ * \return the guard condition, or
+ * \return `NULL` if the subscription is invalid or intra-process is not enabled for it.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+const rcl_guard_condition_t *
+rcl_subscription_get_intra_process_guard_condition(const rcl_subscription_t * subscription);
+
 /// Take a dynamic type message from a topic using a rcl subscription.
 /**
  * In contrast to rcl_take(), this function takes a dynamic type message with dynamic data taken
@@ -646,6 +928,12 @@ rcl_take_dynamic_message(
  * The user must not destroy the message, but rather has to return it with a call to
  * \sa rcl_return_loaned_message to the middleware.
  *
+ * If the middleware cannot loan messages and the subscription was created with
+ * a rcl_subscription_options_t::loaned_message_pool_size, the message is taken
+ * into a message borrowed from the pool of the subscription instead, which
+ * must be returned the same way.
+ * #RCL_RET_BAD_ALLOC is returned if all the messages of the pool are borrowed.
+ *
  * <hr>
  * Attribute          | Adherence
  * ------------------ | -------------
@@ -870,6 +1158,8 @@ rcl_subscription_get_actual_qos(const rcl_subscription_t * subscription);
 /**
  * Depending on the middleware and the message type, this will return true if the middleware
  * can allocate a ROS message instance.
+ * It also returns true if the subscription loans messages from its own pool, see
+ * rcl_subscription_options_t::loaned_message_pool_size.
  *
  * \param[in] subscription The subscription instance to check for the ability to loan messages
  * \return `true` if the subscription instance can loan messages, `false` otherwise.
@@ -878,6 +1168,40 @@ RCL_PUBLIC
 bool
 rcl_subscription_can_loan_messages(const rcl_subscription_t * subscription);
 
+/// Retrieve the counts of the messages taken by the subscription.
+/**
+ * The counts are kept from rcl_subscription_init() on, for every
+ * subscription, at the cost of a relaxed atomic increment per take.
+ * A take of a sequence of messages counts all of them at once.
+ * Messages dropped by rcl are not counted as taken, but as dropped, and the
+ * ones dropped by a content filter evaluated by rcl are also counted by
+ * rcl_subscription_get_content_filter_statistics().
+ *
+ * The counters can be removed by building rcl with `RCL_DISABLE_STATISTICS`,
+ * in which case this function always fails with #RCL_RET_UNSUPPORTED.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[in] subscription the handle to the subscription
+ * \param[out] statistics the struct to which the counts are copied
+ * \return #RCL_RET_OK if the counts were successfully retrieved, or
+ * \return #RCL_RET_SUBSCRIPTION_INVALID if the subscription is invalid, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_UNSUPPORTED if rcl was built without the counters.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_subscription_get_statistics(
+  const rcl_subscription_t * subscription,
+  rcl_subscription_statistics_t * statistics);
+
 /// Set the on new message callback function for the subscription.
 /**
  * This API sets the callback function to be called whenever the
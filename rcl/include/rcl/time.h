@@ -142,6 +142,8 @@ typedef struct rcl_clock_s
   rcl_jump_callback_info_t * jump_callbacks;
   /// Number of callbacks in jump_callbacks.
   size_t num_jump_callbacks;
+  /// Number of callbacks jump_callbacks has room for.
+  size_t jump_callbacks_capacity;
   /// Pointer to get_now function
   rcl_ret_t (* get_now)(void * data, rcl_time_point_value_t * now);
   // void (*set_now) (rcl_time_point_value_t);
@@ -149,6 +151,12 @@ typedef struct rcl_clock_s
   void * data;
   /// Custom allocator used for internal allocations.
   rcl_allocator_t allocator;
+  /// Guard condition shared by the timers on this clock which opted into it, or NULL.
+  struct rcl_guard_condition_s * timer_guard_condition;
+  /// Number of timers using timer_guard_condition.
+  size_t num_timer_guard_condition_users;
+  /// Timers on this clock which react to time jumps, managed by the timers, or NULL.
+  struct rcl_timer_registry_s * timer_registry;
 } rcl_clock_t;
 
 /// A single point in time, measured in nanoseconds, the reference point is based on the source.
@@ -160,6 +168,19 @@ typedef struct rcl_time_point_s
   rcl_clock_type_t clock_type;
 } rcl_time_point_t;
 
+typedef struct rcl_ros_time_source_impl_s rcl_ros_time_source_impl_t;
+
+/// A source of ROS time which many #RCL_ROS_TIME clocks can share.
+/**
+ * Clocks attached to the source read its override state and time instead of their own,
+ * so a single update reaches all of them.
+ */
+typedef struct rcl_ros_time_source_s
+{
+  /// Private implementation pointer.
+  rcl_ros_time_source_impl_t * impl;
+} rcl_ros_time_source_t;
+
 // typedef struct rcl_rate_t
 // {
 //   rcl_time_point_value_t trigger_time;
@@ -372,6 +393,55 @@ rcl_steady_clock_init(
   rcl_clock_t * clock,
   rcl_allocator_t * allocator);
 
+/// Initialize a clock as a #RCL_STEADY_TIME time source read from the TSC when possible.
+/**
+ * On Linux x86_64 with an invariant time stamp counter, the clock converts the
+ * counter to steady time instead of calling `clock_gettime()` for each sample.
+ * The counter frequency is measured against the steady clock once per process,
+ * which takes about 10 milliseconds, and each clock starts in sync with the
+ * steady clock.
+ * The clock may then drift from it by the calibration error, a few tens of
+ * parts per million, so it is meant for frequent, short lived time stamps.
+ *
+ * Everywhere else, or if the counter is not invariant or fails calibration,
+ * this is the same as rcl_steady_clock_init().
+ * Either way the clock is finalized with rcl_steady_clock_fini().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No [1]
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * <i>[1] Function is reentrant, but concurrent calls on the same `clock` object are not safe.
+ *        Thread-safety is also affected by that of the `allocator` object.</i>
+ *
+ * \param[in] clock the handle to the clock which is being initialized
+ * \param[in] allocator The allocator to use for allocations
+ * \return #RCL_RET_OK if the time source was successfully initialized, or
+ * \return #RCL_RET_BAD_ALLOC if a memory allocation failed, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_fast_steady_clock_init(
+  rcl_clock_t * clock,
+  rcl_allocator_t * allocator);
+
+/// Check if a clock reads the time stamp counter.
+/**
+ * \param[in] clock The clock to query.
+ * \return `true` if the clock was initialized by rcl_fast_steady_clock_init() and
+ *   uses the time stamp counter, otherwise `false`.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+bool
+rcl_clock_uses_tsc(const rcl_clock_t * clock);
+
 /// Finalize a clock as a #RCL_STEADY_TIME time source.
 /**
  * Finalize the clock as a #RCL_STEADY_TIME time source.
@@ -533,6 +603,8 @@ rcl_clock_get_now(rcl_clock_t * clock, rcl_time_point_value_t * time_point_value
  * This method will enable the ROS time abstraction override values,
  * such that the time source will report the set value instead of falling
  * back to system time.
+ * If the clock is attached to a shared ROS time source, the source is enabled instead,
+ * as with rcl_ros_time_source_enable_override().
  *
  * This function is not thread-safe with rcl_clock_add_jump_callback(),
  * nor rcl_clock_remove_jump_callback() functions when used on the same
@@ -564,6 +636,8 @@ rcl_enable_ros_time_override(rcl_clock_t * clock);
  * This method will disable the #RCL_ROS_TIME time abstraction override values,
  * such that the time source will report the system time even if a custom
  * value has been set.
+ * If the clock is attached to a shared ROS time source, the source is disabled instead,
+ * as with rcl_ros_time_source_disable_override().
  *
  * This function is not thread-safe with rcl_clock_add_jump_callback(),
  * nor rcl_clock_remove_jump_callback() functions when used on the same
@@ -628,6 +702,9 @@ rcl_is_enabled_ros_time_override(
  * time source.
  * If queried and override enabled the time source will return this value,
  * otherwise it will return the system time.
+ * If the clock is attached to a shared ROS time source, the time of the source is set
+ * instead, as with rcl_ros_time_source_set_override(), so every clock attached to it
+ * moves along.
  *
  * This function is not thread-safe with rcl_clock_add_jump_callback(),
  * nor rcl_clock_remove_jump_callback() functions when used on the same
@@ -656,12 +733,239 @@ rcl_ret_t
 rcl_set_ros_time_override(
   rcl_clock_t * clock, rcl_time_point_value_t time_value);
 
+/// Return a zero initialized ROS time source.
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ros_time_source_t
+rcl_get_zero_initialized_ros_time_source(void);
+
+/// Initialize a ROS time source, which can be shared by many #RCL_ROS_TIME clocks.
+/**
+ * The source starts with the override disabled and a time of zero, like a new
+ * #RCL_ROS_TIME clock.
+ * Clocks are attached to it with rcl_clock_attach_ros_time_source().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[inout] source The zero initialized time source to initialize.
+ * \param[in] allocator The allocator to use for allocations.
+ * \return #RCL_RET_OK if the time source was initialized successfully, or
+ * \return #RCL_RET_ALREADY_INIT if the time source was already initialized, or
+ * \return #RCL_RET_BAD_ALLOC if a memory allocation failed, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_ros_time_source_init(rcl_ros_time_source_t * source, rcl_allocator_t * allocator);
+
+/// Finalize a ROS time source.
+/**
+ * Clocks still attached to the source are detached, keeping its last override state
+ * and time.
+ * The memory of the source is freed, so no clock attached to it may be read,
+ * nor have its override changed, while the source is finalized.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[inout] source The time source to finalize.
+ * \return #RCL_RET_OK if the time source was finalized successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_ros_time_source_fini(rcl_ros_time_source_t * source);
+
+/// Enable the ROS time override of a time source and of the clocks attached to it.
+/**
+ * Like rcl_enable_ros_time_override(), but the jump callbacks of every attached clock
+ * are called around the change.
+ *
+ * Updates of a time source, and attaching or detaching its clocks, are serialized by a
+ * lock of the source, which is held while the jump callbacks are called.
+ * Hence the jump callbacks of attached clocks must not update the source, nor attach or
+ * detach clocks.
+ * This function is not thread-safe with rcl_clock_add_jump_callback() or
+ * rcl_clock_remove_jump_callback() on attached clocks.
+ * Reading the time of attached clocks is safe from any thread.
+ *
+ * <hr>
+ * Attribute          | Adherence [1]
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ *
+ * <i>[1] Only applies to the function itself, as jump callbacks may not abide to it.</i>
+ *
+ * \param[in] source The time source to enable.
+ * \return #RCL_RET_OK if the override was enabled successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_ros_time_source_enable_override(rcl_ros_time_source_t * source);
+
+/// Disable the ROS time override of a time source and of the clocks attached to it.
+/**
+ * Like rcl_disable_ros_time_override(), but the jump callbacks of every attached clock
+ * are called around the change.
+ *
+ * This function has the same thread-safety constraints as
+ * rcl_ros_time_source_enable_override().
+ *
+ * <hr>
+ * Attribute          | Adherence [1]
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ *
+ * <i>[1] Only applies to the function itself, as jump callbacks may not abide to it.</i>
+ *
+ * \param[in] source The time source to disable.
+ * \return #RCL_RET_OK if the override was disabled successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_ros_time_source_disable_override(rcl_ros_time_source_t * source);
+
+/// Check if a time source has the ROS time override enabled.
+/**
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes
+ *
+ * \param[in] source The time source to query.
+ * \param[out] is_enabled Whether the override is enabled.
+ * \return #RCL_RET_OK if the time source was queried successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_ros_time_source_is_override_enabled(rcl_ros_time_source_t * source, bool * is_enabled);
+
+/// Set the current time of a time source and of the clocks attached to it.
+/**
+ * The override state and the time are published together with a sequence lock, so
+ * readers never see one updated without the other, and the update costs the same
+ * however many clocks share the source.
+ * The jump callbacks of attached clocks are still called around the update, as
+ * rcl_set_ros_time_override() would.
+ *
+ * This function has the same thread-safety constraints as
+ * rcl_ros_time_source_enable_override().
+ *
+ * <hr>
+ * Attribute          | Adherence [1]
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ *
+ * <i>[1] Only applies to the function itself, as jump callbacks may not abide to it.</i>
+ *
+ * \param[in] source The time source to update.
+ * \param[in] time_value The new current time.
+ * \return #RCL_RET_OK if the time was set successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_ros_time_source_set_override(
+  rcl_ros_time_source_t * source, rcl_time_point_value_t time_value);
+
+/// Make an #RCL_ROS_TIME clock read its override state and time from a shared time source.
+/**
+ * If the values of the source differ from those of the clock, the jump callbacks of the
+ * clock are called as for any other clock change or time jump.
+ * While attached, rcl_enable_ros_time_override(), rcl_disable_ros_time_override() and
+ * rcl_set_ros_time_override() on the clock update the source instead.
+ * The clock is detached when it is finalized.
+ *
+ * This function is thread-safe with updates of the source and with attaching or
+ * detaching other clocks, see rcl_ros_time_source_enable_override().
+ *
+ * <hr>
+ * Attribute          | Adherence [1]
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ *
+ * <i>[1] Only applies to the function itself, as jump callbacks may not abide to it.</i>
+ *
+ * \param[in] clock The clock to attach.
+ * \param[in] source The time source to attach the clock to.
+ * \return #RCL_RET_OK if the clock was attached successfully, or
+ * \return #RCL_RET_BAD_ALLOC if a memory allocation failed, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_ERROR if the clock is not an #RCL_ROS_TIME clock or is already attached.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_clock_attach_ros_time_source(rcl_clock_t * clock, rcl_ros_time_source_t * source);
+
+/// Make an #RCL_ROS_TIME clock use its own override state and time again.
+/**
+ * The clock keeps the last values of the source, so no jump callbacks are called.
+ *
+ * This function is thread-safe with updates of the source and with attaching or
+ * detaching other clocks, see rcl_ros_time_source_enable_override().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ *
+ * \param[in] clock The clock to detach.
+ * \return #RCL_RET_OK if the clock was detached successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_ERROR if the clock is not attached to a time source.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_clock_detach_ros_time_source(rcl_clock_t * clock);
+
 /// Add a callback to be called when a time jump exceeds a threshold.
 /**
  * The callback is called twice when the threshold is exceeded: once before the clock is
  * updated, and once after.
  * The user_data pointer is passed to the callback as the last argument.
  * A callback and user_data pair must be unique among the callbacks added to a clock.
+ * The callback storage grows geometrically, so adding many callbacks is amortized
+ * constant time apart from the uniqueness check.
  *
  * This function is not thread-safe with rcl_clock_remove_jump_callback(),
  * rcl_enable_ros_time_override(), rcl_disable_ros_time_override() nor
@@ -697,6 +1001,10 @@ rcl_clock_add_jump_callback(
 
 /// Remove a previously added time jump callback.
 /**
+ * The last added callback takes the place of the removed one, so the order in which the
+ * remaining callbacks are called may change.
+ * Storage is not shrunk until the last callback is removed.
+ *
  * This function is not thread-safe with rcl_clock_add_jump_callback()
  * rcl_enable_ros_time_override(), rcl_disable_ros_time_override() nor
  * rcl_set_ros_time_override() functions when used on the same clock object.
@@ -704,7 +1012,7 @@ rcl_clock_add_jump_callback(
  * <hr>
  * Attribute          | Adherence
  * ------------------ | -------------
- * Allocates Memory   | Yes
+ * Allocates Memory   | No
  * Thread-Safe        | No [1]
  * Uses Atomics       | No
  * Lock-Free          | Yes
@@ -717,7 +1025,6 @@ rcl_clock_add_jump_callback(
  * \param[in] callback The callback to call.
  * \param[in] user_data A pointer to be passed to the callback.
  * \return #RCL_RET_OK if the callback was added successfully, or
- * \return #RCL_RET_BAD_ALLOC if a memory allocation failed, or
  * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
  * \return #RCL_RET_ERROR the callback was not found or an unspecified error occurs.
  */
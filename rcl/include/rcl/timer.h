@@ -23,6 +23,7 @@ extern "C"
 #endif
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "rcl/allocator.h"
 #include "rcl/context.h"
@@ -73,6 +74,75 @@ typedef struct rcl_timer_call_info_s
  */
 typedef void (* rcl_timer_callback_t)(rcl_timer_t *, int64_t);
 
+/// Options available for a rcl timer.
+typedef struct rcl_timer_options_s
+{
+  /// Custom allocator for the timer, used for internal allocations.
+  rcl_allocator_t allocator;
+  /// If false, the timer is initialized in the canceled state.
+  bool autostart;
+  /// If true, the timer wakes wait sets with a guard condition owned by its clock.
+  /**
+   * All timers on the same clock which set this option share that guard
+   * condition, so a wait set holding any number of them waits on a single rmw
+   * guard condition.
+   * Resetting one of these timers wakes wait sets holding any of the others,
+   * which then see that those timers are not ready yet.
+   * All timers sharing a clock guard condition must use the same context.
+   * Timers on the same clock may create and destroy the shared guard condition
+   * while they are initialized and finalized concurrently.
+   */
+  bool share_clock_guard_condition;
+  /// If true, the timer records the statistics returned by rcl_timer_get_statistics().
+  bool statistics;
+  /// Nanoseconds by which waking up for the timer may be delayed, must not be negative.
+  /**
+   * Wait sets and timer engines wake up at the earliest deadline plus slack
+   * of their timers rather than at the earliest deadline, so that timers due
+   * within each other's slack are served by a single wake up.
+   * The timer is never called earlier than its deadline.
+   */
+  int64_t slack;
+} rcl_timer_options_t;
+
+/// Number of buckets in the lateness histogram of rcl_timer_statistics_t.
+/**
+ * Bucket `0` counts the values below `1`, bucket `i` counts the values in
+ * `[2^(i-1), 2^i)`, and the last bucket also counts all the larger values.
+ */
+#define RCL_TIMER_STATISTICS_HISTOGRAM_SIZE 24
+
+/// Statistics recorded by a timer, if enabled in its options.
+/**
+ * The lateness of a call is the time at which the timer was called minus the
+ * time at which it was expected to be called, i.e. `actual_call_time` minus
+ * `expected_call_time` in rcl_timer_call_info_t.
+ * Its spread between calls is the jitter of the timer.
+ */
+typedef struct rcl_timer_statistics_s
+{
+  /// Number of calls of the timer.
+  uint64_t call_count;
+  /// Number of periods which were skipped because the timer was called too late for them.
+  uint64_t skipped_periods;
+  /// Smallest lateness of a call, in nanoseconds.
+  int64_t min_lateness;
+  /// Largest lateness of a call, in nanoseconds.
+  int64_t max_lateness;
+  /// Mean lateness of the calls, in nanoseconds.
+  int64_t mean_lateness;
+  /// Histogram of the lateness of each call, in microseconds.
+  uint64_t lateness_histogram[RCL_TIMER_STATISTICS_HISTOGRAM_SIZE];
+  /// Number of callback durations given to rcl_timer_record_callback_duration().
+  uint64_t callback_count;
+  /// Shortest callback duration, in nanoseconds.
+  int64_t min_callback_duration;
+  /// Longest callback duration, in nanoseconds.
+  int64_t max_callback_duration;
+  /// Mean callback duration, in nanoseconds.
+  int64_t mean_callback_duration;
+} rcl_timer_statistics_t;
+
 /// Return a zero initialized timer.
 RCL_PUBLIC
 RCL_WARN_UNUSED
@@ -100,6 +170,11 @@ rcl_get_zero_initialized_timer(void);
  *
  * The clock handle must be a pointer to an initialized rcl_clock_t struct.
  * The life time of the clock must exceed the life time of the timer.
+ * The first timer on a clock of type #RCL_ROS_TIME adds a jump callback to the
+ * clock, so, like rcl_clock_add_jump_callback(), it is not thread-safe with
+ * rcl_enable_ros_time_override(), rcl_disable_ros_time_override() nor
+ * rcl_set_ros_time_override() on that clock.
+ * Later timers on the clock, and rcl_timer_fini(), are.
  *
  * The period is a non-negative duration (rather an absolute time in the
  * future).
@@ -178,6 +253,69 @@ rcl_timer_init2(
   rcl_allocator_t allocator,
   bool autostart);
 
+/// Return the default timer options in a rcl_timer_options_t.
+/**
+ * The defaults are:
+ *
+ * - allocator = rcl_get_default_allocator()
+ * - autostart = true
+ * - share_clock_guard_condition = false
+ * - statistics = false
+ * - slack = 0
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_timer_options_t
+rcl_timer_get_default_options(void);
+
+/// Initialize a timer with the given options.
+/**
+ * This function is identical to rcl_timer_init2(), except that the allocator
+ * and the autostart state come from the options, which also allow the timer to
+ * share a guard condition with the other timers on its clock.
+ *
+ * When `share_clock_guard_condition` is set, the first timer to set it on a
+ * clock creates the shared guard condition, and the last one to be finalized
+ * destroys it, using the allocator of the clock.
+ * rcl_timer_get_guard_condition() returns the shared guard condition for these
+ * timers, and rcl_wait() passes it to the middleware only once per wait.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes [1][2][3]
+ * <i>[1] if `atomic_is_lock_free()` returns true for `atomic_uintptr_t`</i>
+ *
+ * <i>[2] if `atomic_is_lock_free()` returns true for `atomic_uint_least64_t`</i>
+ *
+ * <i>[3] if `atomic_is_lock_free()` returns true for `atomic_bool`</i>
+ *
+ * \param[inout] timer the timer handle to be initialized
+ * \param[in] clock the clock providing the current time
+ * \param[in] context the context that this timer is to be associated with
+ * \param[in] period the duration between calls to the callback in nanoseconds
+ * \param[in] callback the user defined function to be called every period
+ * \param[in] options the timer's options
+ * \return #RCL_RET_OK if the timer was initialized successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_ALREADY_INIT if the timer was already initialized, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_init_with_options(
+  rcl_timer_t * timer,
+  rcl_clock_t * clock,
+  rcl_context_t * context,
+  int64_t period,
+  const rcl_timer_callback_t callback,
+  const rcl_timer_options_t * options);
+
 /**
  * \deprecated `rcl_timer_init` implementation was removed.
  *   Refer to `rcl_timer_init2`.
@@ -296,6 +434,54 @@ RCL_WARN_UNUSED
 rcl_ret_t
 rcl_timer_call_with_info(rcl_timer_t * timer, rcl_timer_call_info_t * call_info);
 
+/// Call many timers which use the same clock, against a single sample of that clock.
+/**
+ * Same as calling rcl_timer_call_with_info() on each of the timers in order,
+ * except that the given time is used as the current time for all of them,
+ * instead of reading the clock once per timer.
+ * The timers therefore share the same `actual_call_time`, and missed periods
+ * are skipped the same way as in rcl_timer_call().
+ *
+ * `NULL` entries in the array are ignored.
+ * Canceled timers are not called, and their entries are set to `NULL`, the
+ * same way rcl_wait() prunes the timers which are not ready.
+ * A timer canceled by the callback of an earlier timer in the array is
+ * treated the same way.
+ * The call info of an entry which is `NULL` on return is left unchanged.
+ *
+ * All of the timers must use the same clock, and the given time would
+ * typically be read from it with rcl_clock_get_now() just before this call.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes [1]
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes [2]
+ * <i>[1] user callback might not be thread-safe</i>
+ *
+ * <i>[2] if `atomic_is_lock_free()` returns true for `atomic_int_least64_t`</i>
+ *
+ * \param[inout] timers array of handles to the timers to call
+ * \param[in] count the number of entries in the timers array
+ * \param[in] now the current time of the clock of the timers
+ * \param[out] call_infos array of `count` structs in which the call times are stored
+ * \return #RCL_RET_OK if the timers were called successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or if the
+ *   timers do not all use the same clock, or
+ * \return #RCL_RET_TIMER_INVALID if any timer->impl is invalid, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_call_batch(
+  rcl_timer_t ** timers,
+  size_t count,
+  rcl_time_point_value_t now,
+  rcl_timer_call_info_t * call_infos);
+
 /// Retrieve the clock of the timer.
 /**
  * This function retrieves the clock pointer and copies it into the given variable.
@@ -387,6 +573,117 @@ RCL_WARN_UNUSED
 rcl_ret_t
 rcl_timer_get_time_until_next_call(const rcl_timer_t * timer, int64_t * time_until_next_call);
 
+/// Retrieve the time when the next call to rcl_timer_call() is due, in nanoseconds.
+/**
+ * This function retrieves the absolute time, as measured by the timer's clock,
+ * at which the timer becomes ready.
+ * Unlike rcl_timer_get_time_until_next_call(), it does not query the clock, so
+ * it can be used to compare many timers against a single sample of their clock.
+ *
+ * The `next_call_time` argument must point to an allocated int64_t, as the
+ * next call time is copied into that instance.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | Yes
+ * Lock-Free          | Yes [1]
+ * <i>[1] if `atomic_is_lock_free()` returns true for `atomic_int_least64_t`</i>
+ *
+ * \param[in] timer the handle to the timer that is being queried
+ * \param[out] next_call_time the output variable for the result
+ * \return #RCL_RET_OK if the next call time was successfully retrieved, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_TIMER_INVALID if the timer->impl is invalid, or
+ * \return #RCL_RET_TIMER_CANCELED if the timer is canceled, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_get_next_call_time(const rcl_timer_t * timer, int64_t * next_call_time);
+
+/// Retrieve the statistics recorded by the timer.
+/**
+ * The statistics are only recorded if the timer was initialized with the
+ * `statistics` option, with rcl_timer_init_with_options().
+ * Every call of the timer, with rcl_timer_call(), rcl_timer_call_with_info()
+ * or rcl_timer_call_batch(), records its lateness and the number of periods
+ * it skipped.
+ * The callback durations are only recorded when given to
+ * rcl_timer_record_callback_duration().
+ * The minimums, maximums and means are 0 until something is recorded.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No [1]
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ * <i>[1] calls of the same timer from several threads at once may lose samples</i>
+ *
+ * \param[in] timer the handle to the timer
+ * \param[out] statistics the struct to which the statistics are copied
+ * \return #RCL_RET_OK if the statistics were successfully retrieved, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_TIMER_INVALID if the timer->impl is invalid, or
+ * \return #RCL_RET_ERROR if statistics are not enabled for the timer.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_get_statistics(const rcl_timer_t * timer, rcl_timer_statistics_t * statistics);
+
+/// Reset the statistics recorded by the timer.
+/**
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] timer the handle to the timer
+ * \return #RCL_RET_OK if the statistics were successfully reset, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_TIMER_INVALID if the timer->impl is invalid, or
+ * \return #RCL_RET_ERROR if statistics are not enabled for the timer.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_reset_statistics(rcl_timer_t * timer);
+
+/// Record how long the callback of the timer took, for its statistics.
+/**
+ * Callers which run the work of a timer themselves, after calling the timer
+ * with rcl_timer_call_with_info(), can measure that work and record its
+ * duration here.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] timer the handle to the timer
+ * \param[in] duration the duration of the callback, in nanoseconds
+ * \return #RCL_RET_OK if the duration was successfully recorded, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_TIMER_INVALID if the timer->impl is invalid, or
+ * \return #RCL_RET_ERROR if statistics are not enabled for the timer.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_record_callback_duration(rcl_timer_t * timer, int64_t duration);
+
 /// Retrieve the time since the previous call to rcl_timer_call() occurred.
 /**
  * This function calculates the time since the last call and copies it into
@@ -446,6 +743,27 @@ RCL_WARN_UNUSED
 rcl_ret_t
 rcl_timer_get_period(const rcl_timer_t * timer, int64_t * period);
 
+/// Retrieve the slack the timer was initialized with.
+/**
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] timer the handle to the timer which is being queried
+ * \param[out] slack the int64_t in which the slack is stored
+ * \return #RCL_RET_OK if the slack was retrieved successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_TIMER_INVALID if the timer->impl is invalid.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_get_slack(const rcl_timer_t * timer, int64_t * slack);
+
 /// Exchange the period of the timer and return the previous period.
 /**
  * This function exchanges the period in the timer and copies the old one into
@@ -635,6 +953,9 @@ rcl_timer_get_allocator(const rcl_timer_t * timer);
 
 /// Retrieve a guard condition used by the timer to wake the waitset when using ROSTime.
 /**
+ * If the timer was initialized with `share_clock_guard_condition`, this is the
+ * guard condition shared by the timers on its clock.
+ *
  * <hr>
  * Attribute          | Adherence
  * ------------------ | -------------
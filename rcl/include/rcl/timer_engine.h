@@ -0,0 +1,190 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file
+
+#ifndef RCL__TIMER_ENGINE_H_
+#define RCL__TIMER_ENGINE_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "rcl/allocator.h"
+#include "rcl/macros.h"
+#include "rcl/timer.h"
+#include "rcl/types.h"
+#include "rcl/visibility_control.h"
+
+typedef struct rcl_timer_engine_impl_s rcl_timer_engine_impl_t;
+
+/// Structure which encapsulates a timer engine.
+/**
+ * A timer engine owns a thread which triggers the guard condition of each of
+ * its timers when that timer's deadline expires.
+ * rcl_wait() does not derive its timeout from the timers driven by an engine,
+ * so it may block without a timeout and still wake up on time, with the
+ * precision of the operating system timers rather than the precision of the
+ * middleware's timeout.
+ *
+ * Timer engines are only supported on Linux, where they are backed by
+ * `timerfd`, with deadlines relative to the steady time for steady clocks and
+ * absolute deadlines for system clocks.
+ * Only timers using a RCL_STEADY_TIME or a RCL_SYSTEM_TIME clock can be driven
+ * by an engine.
+ */
+typedef struct rcl_timer_engine_s
+{
+  /// Private implementation pointer.
+  rcl_timer_engine_impl_t * impl;
+} rcl_timer_engine_t;
+
+/// Return a zero initialized timer engine.
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_timer_engine_t
+rcl_get_zero_initialized_timer_engine(void);
+
+/// Initialize a timer engine and start its thread.
+/**
+ * The engine handle must be a pointer to an allocated and zero initialized
+ * rcl_timer_engine_t struct.
+ * Calling this function on an already initialized engine will fail.
+ *
+ * A client library would typically create a single engine per context, and
+ * add to it the timers of every node in that context.
+ *
+ * Expected usage:
+ *
+ * ```c
+ * #include <rcl/timer_engine.h>
+ *
+ * rcl_timer_t timer;  // initialized previously with a steady clock...
+ * rcl_timer_engine_t engine = rcl_get_zero_initialized_timer_engine();
+ * rcl_ret_t ret = rcl_timer_engine_init(&engine, rcl_get_default_allocator());
+ * // ... error handling
+ * ret = rcl_timer_engine_add_timer(&engine, &timer);
+ * // ... error handling, then wait on the timer with rcl_wait() as usual
+ * ret = rcl_timer_engine_fini(&engine);
+ * // ... error handling
+ * ```
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] engine the timer engine handle to be initialized
+ * \param[in] allocator the allocator to use for allocations
+ * \return #RCL_RET_OK if the engine was initialized successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_ALREADY_INIT if the engine was already initialized, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed, or
+ * \return #RCL_RET_UNSUPPORTED if timer engines are not supported on this platform, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_engine_init(rcl_timer_engine_t * engine, rcl_allocator_t allocator);
+
+/// Stop the thread of a timer engine and finalize it.
+/**
+ * The timers still driven by the engine are released, and rcl_wait() derives
+ * its timeout from them again.
+ *
+ * An engine that is already invalid (zero initialized) or `NULL` will not fail.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] engine the handle to the timer engine to be finalized
+ * \return #RCL_RET_OK if the engine was finalized successfully, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_engine_fini(rcl_timer_engine_t * engine);
+
+/// Have the timer engine drive a timer.
+/**
+ * A timer can be driven by at most one engine at a time.
+ * Finalizing a timer removes it from its engine.
+ * Only steady and system time clocks are supported, and not the steady clocks
+ * reading the time stamp counter, see rcl_clock_uses_tsc().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | Yes [1]
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ * <i>[1] with respect to the other rcl_timer_engine_* functions called on the same
+ * engine, except for rcl_timer_engine_init() and rcl_timer_engine_fini()</i>
+ *
+ * \param[inout] engine the timer engine
+ * \param[in] timer the timer to be driven by the engine
+ * \return #RCL_RET_OK if the timer was added successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or if the
+ *   timer is already driven by an engine, or
+ * \return #RCL_RET_TIMER_INVALID if the timer is invalid, or
+ * \return #RCL_RET_UNSUPPORTED if the clock of the timer is not supported, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_engine_add_timer(rcl_timer_engine_t * engine, const rcl_timer_t * timer);
+
+/// Stop having the timer engine drive a timer.
+/**
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | Yes [1]
+ * Uses Atomics       | Yes
+ * Lock-Free          | No
+ * <i>[1] with respect to the other rcl_timer_engine_* functions called on the same
+ * engine, except for rcl_timer_engine_init() and rcl_timer_engine_fini()</i>
+ *
+ * \param[inout] engine the timer engine
+ * \param[in] timer the timer to be removed from the engine
+ * \return #RCL_RET_OK if the timer was removed successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_NOT_FOUND if the timer is not driven by the engine, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_timer_engine_remove_timer(rcl_timer_engine_t * engine, const rcl_timer_t * timer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__TIMER_ENGINE_H_
@@ -24,7 +24,9 @@ extern "C"
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
+#include "rcl/allocator.h"
 #include "rcl/client.h"
 #include "rcl/guard_condition.h"
 #include "rcl/macros.h"
@@ -37,6 +39,15 @@ extern "C"
 
 typedef struct rcl_wait_set_impl_s rcl_wait_set_impl_t;
 
+/// Dense list of the indexes of the ready entities of one kind.
+typedef struct rcl_wait_set_ready_list_s
+{
+  /// Indexes into the corresponding entity array, in ascending order.
+  size_t * indices;
+  /// Number of valid entries in indices.
+  size_t size;
+} rcl_wait_set_ready_list_t;
+
 /// Container for subscription's, guard condition's, etc to be waited on.
 typedef struct rcl_wait_set_s
 {
@@ -64,16 +75,169 @@ typedef struct rcl_wait_set_s
   const rcl_event_t ** events;
   /// Number of events
   size_t size_of_events;
+  /// Ready subscriptions, only filled by rcl_wait() if ready lists are enabled.
+  rcl_wait_set_ready_list_t ready_subscriptions;
+  /// Ready guard conditions, only filled by rcl_wait() if ready lists are enabled.
+  rcl_wait_set_ready_list_t ready_guard_conditions;
+  /// Ready timers, only filled by rcl_wait() if ready lists are enabled.
+  rcl_wait_set_ready_list_t ready_timers;
+  /// Ready clients, only filled by rcl_wait() if ready lists are enabled.
+  rcl_wait_set_ready_list_t ready_clients;
+  /// Ready services, only filled by rcl_wait() if ready lists are enabled.
+  rcl_wait_set_ready_list_t ready_services;
+  /// Ready events, only filled by rcl_wait() if ready lists are enabled.
+  rcl_wait_set_ready_list_t ready_events;
   /// Implementation specific storage.
   rcl_wait_set_impl_t * impl;
 } rcl_wait_set_t;
 
+/// Options available for a rcl wait set.
+typedef struct rcl_wait_set_options_s
+{
+  /// If `true`, entities stay in the wait set across calls to rcl_wait() until removed.
+  bool persistent;
+  /// If `true`, rcl_wait() also fills the `ready_*` lists of the wait set.
+  bool ready_lists;
+  /// If `true`, rcl_wait() records the statistics returned by rcl_wait_set_get_statistics().
+  bool statistics;
+  /// Longest time in nanoseconds that rcl_wait() polls the middleware before blocking.
+  /**
+   * If positive, rcl_wait() repeatedly checks for readiness without blocking
+   * for up to this long, then blocks for the remainder of its timeout.
+   * This trades CPU time for the latency of waking a blocked thread.
+   * A zero timeout given to rcl_wait() is never spun on.
+   */
+  int64_t spin_budget;
+  /// If `true`, rcl_wait() only spins as long as recent waits suggest is useful.
+  /**
+   * The spin time then follows a moving average of how long recent calls to
+   * rcl_wait() waited, and is zero while that exceeds `spin_budget`.
+   */
+  bool adaptive_spin;
+  /// If `true`, rcl_wait() orders the ready entities by the priorities set on them.
+  bool priorities;
+  /// #RCL_ROS_TIME clock which rcl_wait() advances itself, or `NULL`.
+  /**
+   * While its ROS time override is enabled, rcl_wait() does not sleep until the
+   * timers of this clock are due, but sets the clock to the earliest of their
+   * next call times when nothing else is ready, so time driven code runs as
+   * fast as possible, e.g. in simulation or when replaying logs.
+   */
+  rcl_clock_t * virtual_time_clock;
+  /// Custom allocator for the wait set, used for internal allocations.
+  rcl_allocator_t allocator;
+} rcl_wait_set_options_t;
+
+/// Number of buckets in each histogram of rcl_wait_set_statistics_t.
+/**
+ * Bucket `0` counts the values below `1`, bucket `i` counts the values in
+ * `[2^(i-1), 2^i)`, and the last bucket also counts all the larger values.
+ */
+#define RCL_WAIT_SET_STATISTICS_HISTOGRAM_SIZE 24
+
+/// Statistics recorded by rcl_wait() for a wait set, if enabled in its options.
+/**
+ * Only the calls to rcl_wait() which reach the middleware are recorded, and
+ * each of them counts as exactly one kind of wakeup.
+ */
+typedef struct rcl_wait_set_statistics_s
+{
+  /// Number of recorded calls to rcl_wait().
+  uint64_t wait_count;
+  /// Wakeups with a ready subscription, guard condition, client, service or event.
+  uint64_t entity_wakeups;
+  /// Wakeups with ready timers only.
+  uint64_t timer_wakeups;
+  /// Wakeups with nothing ready, because the given timeout expired.
+  uint64_t timeout_wakeups;
+  /// Wakeups with nothing ready, before the given timeout expired.
+  uint64_t spurious_wakeups;
+  /// Number of ready subscriptions, summed over all wakeups.
+  uint64_t ready_subscriptions;
+  /// Number of ready guard conditions, summed over all wakeups.
+  uint64_t ready_guard_conditions;
+  /// Number of ready timers, summed over all wakeups.
+  uint64_t ready_timers;
+  /// Number of ready clients, summed over all wakeups.
+  uint64_t ready_clients;
+  /// Number of ready services, summed over all wakeups.
+  uint64_t ready_services;
+  /// Number of ready events, summed over all wakeups.
+  uint64_t ready_events;
+  /// Time spent blocked in the middleware, in nanoseconds.
+  int64_t blocked_time;
+  /// Time spent in rcl_wait() outside of the middleware, in nanoseconds.
+  int64_t processing_time;
+  /// Histogram of the time blocked in the middleware per wait, in microseconds.
+  uint64_t blocked_time_histogram[RCL_WAIT_SET_STATISTICS_HISTOGRAM_SIZE];
+  /// Histogram of the time spent outside of the middleware per wait, in microseconds.
+  uint64_t processing_time_histogram[RCL_WAIT_SET_STATISTICS_HISTOGRAM_SIZE];
+  /// Histogram of the number of ready entities of any kind per wakeup.
+  uint64_t ready_entities_histogram[RCL_WAIT_SET_STATISTICS_HISTOGRAM_SIZE];
+} rcl_wait_set_statistics_t;
+
+/// Kind of an entity in a wait set.
+typedef enum rcl_wait_set_entity_type_e
+{
+  /// A subscription, see rcl_wait_set_t::subscriptions.
+  RCL_WAIT_SET_SUBSCRIPTION,
+  /// A guard condition, see rcl_wait_set_t::guard_conditions.
+  RCL_WAIT_SET_GUARD_CONDITION,
+  /// A timer, see rcl_wait_set_t::timers.
+  RCL_WAIT_SET_TIMER,
+  /// A client, see rcl_wait_set_t::clients.
+  RCL_WAIT_SET_CLIENT,
+  /// A service, see rcl_wait_set_t::services.
+  RCL_WAIT_SET_SERVICE,
+  /// An event, see rcl_wait_set_t::events.
+  RCL_WAIT_SET_EVENT,
+} rcl_wait_set_entity_type_t;
+
+/// Priority of the entities of a wait set for which none was set.
+#define RCL_WAIT_SET_DEFAULT_PRIORITY 0
+
+/// Deadline of the entities of a wait set for which none was set.
+#define RCL_WAIT_SET_NO_DEADLINE INT64_MAX
+
+/// Ready entity of a wait set, as reported by rcl_wait_set_get_prioritized_ready().
+typedef struct rcl_wait_set_ready_entity_s
+{
+  /// Kind of the entity.
+  rcl_wait_set_entity_type_t type;
+  /// Index into the entity array of the wait set which matches the kind.
+  size_t index;
+  /// Priority of the entity, larger values are more important.
+  int32_t priority;
+  /// Deadline of the entity, smaller values are more urgent.
+  int64_t deadline;
+} rcl_wait_set_ready_entity_t;
+
 /// Return a rcl_wait_set_t struct with members set to `NULL`.
 RCL_PUBLIC
 RCL_WARN_UNUSED
 rcl_wait_set_t
 rcl_get_zero_initialized_wait_set(void);
 
+/// Return the default wait set options in a rcl_wait_set_options_t.
+/**
+ * The defaults are:
+ *
+ * - persistent = false
+ * - ready_lists = false
+ * - statistics = false
+ * - spin_budget = 0
+ * - adaptive_spin = false
+ * - priorities = false
+ * - virtual_time_clock = NULL
+ * - allocator = rcl_get_default_allocator()
+ *
+ * \return A structure with the default wait set options.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_wait_set_options_t
+rcl_wait_set_get_default_options(void);
+
 /// Initialize a rcl wait set with space for items to be waited on.
 /**
  * This function allocates space for the subscriptions and other wait-able
@@ -142,6 +306,85 @@ rcl_wait_set_init(
   rcl_context_t * context,
   rcl_allocator_t allocator);
 
+/// Initialize a rcl wait set with the given options.
+/**
+ * Same as rcl_wait_set_init(), but takes a rcl_wait_set_options_t instead of
+ * only an allocator.
+ *
+ * If `options->persistent` is `true`, the wait set keeps track of the entities
+ * added to it, and they remain members across calls to rcl_wait() until they
+ * are removed with one of the `rcl_wait_set_remove_*` functions, or until
+ * rcl_wait_set_clear() or rcl_wait_set_resize() is called.
+ * Before blocking, rcl_wait() only resets the readiness state of the members,
+ * so there is no need to clear and re-add the entities for every wait.
+ * In this mode the entity arrays in the rcl_wait_set_t, e.g.
+ * `wait_set->subscriptions`, only report readiness after rcl_wait() returns.
+ *
+ * If `options->ready_lists` is `true`, rcl_wait() additionally stores the
+ * indexes of the ready entities of each kind in the `ready_*` members of the
+ * wait set, e.g. `wait_set->ready_subscriptions`, while pruning the entity
+ * arrays.
+ * Callers can then visit only the ready entities instead of scanning every
+ * slot of the entity arrays.
+ *
+ * If `options->priorities` is `true`, rcl_wait() additionally orders the ready
+ * entities of all kinds by the priorities and deadlines set with
+ * rcl_wait_set_set_priority(), see rcl_wait_set_get_prioritized_ready().
+ *
+ * Expected usage:
+ *
+ * ```c
+ * #include <rcl/wait.h>
+ *
+ * rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+ * rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+ * options.persistent = true;
+ * rcl_ret_t ret = rcl_wait_set_init_with_options(
+ *   &wait_set, 42, 42, 42, 42, 42, 42, &context, &options);
+ * // ... error handling, add the entities once, then wait repeatedly
+ * ret = rcl_wait_set_fini(&wait_set);
+ * // ... error handling
+ * ```
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] wait_set the wait set struct to be initialized
+ * \param[in] number_of_subscriptions non-zero size of the subscriptions set
+ * \param[in] number_of_guard_conditions non-zero size of the guard conditions set
+ * \param[in] number_of_timers non-zero size of the timers set
+ * \param[in] number_of_clients non-zero size of the clients set
+ * \param[in] number_of_services non-zero size of the services set
+ * \param[in] number_of_events non-zero size of the events set
+ * \param[in] context the context that the wait set should be associated with
+ * \param[in] options the wait set's options
+ * \return #RCL_RET_OK if the wait set is initialized successfully, or
+ * \return #RCL_RET_ALREADY_INIT if the wait set is not zero initialized, or
+ * \return #RCL_RET_NOT_INIT if the given context is invalid, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is not destroyed properly, or
+ * \return #RCL_RET_ERROR if an unspecified error occurs.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_init_with_options(
+  rcl_wait_set_t * wait_set,
+  size_t number_of_subscriptions,
+  size_t number_of_guard_conditions,
+  size_t number_of_timers,
+  size_t number_of_clients,
+  size_t number_of_services,
+  size_t number_of_events,
+  rcl_context_t * context,
+  const rcl_wait_set_options_t * options);
+
 /// Finalize a rcl wait set.
 /**
  * Deallocates any memory in the wait set that was allocated in
@@ -239,6 +482,8 @@ rcl_wait_set_add_subscription(
  * Sets all of the entries in the underlying rmw array to `NULL`, and sets the
  * count in the rmw array to `0`.
  *
+ * For a persistent wait set this also removes all of its members.
+ *
  * Calling this on an uninitialized (zero initialized) wait set will fail.
  *
  * <hr>
@@ -375,6 +620,98 @@ rcl_wait_set_add_event(
   const rcl_event_t * event,
   size_t * index);
 
+/// Remove the given subscription from a persistent wait set.
+/**
+ * The subscription stops being a member of the wait set.
+ * To keep the members contiguous, the last member of the subscriptions set is
+ * moved into the slot of the removed subscription, so indexes previously
+ * returned by rcl_wait_set_add_subscription() may change.
+ * The readiness state of both affected slots is reset to `NULL` until the next
+ * call to rcl_wait().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] wait_set persistent wait set from which the subscription is removed
+ * \param[in] subscription the subscription to be removed from the wait set
+ * \return #RCL_RET_OK if removed successfully, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is zero initialized or not persistent, or
+ * \return #RCL_RET_NOT_FOUND if the subscription is not a member of the wait set, or
+ * \return #RCL_RET_ERROR if an unspecified error occurs.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_remove_subscription(
+  rcl_wait_set_t * wait_set,
+  const rcl_subscription_t * subscription);
+
+/// Remove the given guard condition from a persistent wait set.
+/**
+ * This function behaves exactly the same as for subscriptions.
+ * \see rcl_wait_set_remove_subscription
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_remove_guard_condition(
+  rcl_wait_set_t * wait_set,
+  const rcl_guard_condition_t * guard_condition);
+
+/// Remove the given timer from a persistent wait set.
+/**
+ * This function behaves exactly the same as for subscriptions.
+ * \see rcl_wait_set_remove_subscription
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_remove_timer(
+  rcl_wait_set_t * wait_set,
+  const rcl_timer_t * timer);
+
+/// Remove the given client from a persistent wait set.
+/**
+ * This function behaves exactly the same as for subscriptions.
+ * \see rcl_wait_set_remove_subscription
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_remove_client(
+  rcl_wait_set_t * wait_set,
+  const rcl_client_t * client);
+
+/// Remove the given service from a persistent wait set.
+/**
+ * This function behaves exactly the same as for subscriptions.
+ * \see rcl_wait_set_remove_subscription
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_remove_service(
+  rcl_wait_set_t * wait_set,
+  const rcl_service_t * service);
+
+/// Remove the given event from a persistent wait set.
+/**
+ * This function behaves exactly the same as for subscriptions.
+ * \see rcl_wait_set_remove_subscription
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_remove_event(
+  rcl_wait_set_t * wait_set,
+  const rcl_event_t * event);
+
 /// Block until the wait set is ready or until the timeout has been exceeded.
 /**
  * This function will collect the items in the rcl_wait_set_t and pass them
@@ -425,6 +762,12 @@ rcl_wait_set_add_event(
  *       // The subscription is ready...
  *     }
  *   }
+ *   // Or, if the wait set was initialized with ready lists enabled:
+ *   for (size_t i = 0; i < wait_set.ready_subscriptions.size; ++i) {
+ *     const rcl_subscription_t * sub =
+ *       wait_set.subscriptions[wait_set.ready_subscriptions.indices[i]];
+ *     // The subscription is ready...
+ *   }
  * } while(check_some_condition());
  * // ... fini node, and subscriptions and guard conditions...
  * ret = rcl_wait_set_fini(&wait_set);
@@ -433,6 +776,8 @@ rcl_wait_set_add_event(
  *
  * The wait set struct must be allocated, initialized, and should have been
  * cleared and then filled with items, e.g. subscriptions and guard conditions.
+ * A persistent wait set, see rcl_wait_set_init_with_options(), does not need
+ * to be cleared and refilled: its members are restored before every wait.
  * Passing a wait set with no wait-able items in it will fail.
  * `NULL` items in the sets are ignored, e.g. it is valid to have as input:
  *  - `subscriptions[0]` = valid pointer
@@ -452,6 +797,22 @@ rcl_wait_set_add_event(
  * comes first.
  * Passing a timeout struct with uninitialized memory is undefined behavior.
  *
+ * If the wait set was initialized with a positive `spin_budget` option and the
+ * timeout is not 0, this function first polls the wait set without blocking
+ * for up to that budget, never exceeding the timeout, and only then blocks
+ * for the rest of the timeout.
+ *
+ * If the wait set was initialized with a `virtual_time_clock` option whose ROS
+ * time override is enabled, the timeout is not 0 and nothing is ready, this
+ * function sets that clock to the earliest next call time of the timers using
+ * it, instead of blocking.
+ * The timers due at that time are then ready, and so is anything else which
+ * became ready in the meantime.
+ * Since the clock is updated with rcl_set_ros_time_override(), the same
+ * thread-safety constraints apply to it during the wait.
+ * If the clock is attached to a shared ROS time source, the source is advanced,
+ * and with it every clock attached to it.
+ *
  * This function is thread-safe for unique wait sets with unique contents.
  * This function cannot operate on the same wait set in multiple threads, and
  * the wait sets may not share content.
@@ -472,6 +833,41 @@ RCL_WARN_UNUSED
 rcl_ret_t
 rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout);
 
+/// Block until the wait set is ready or until the given steady time is reached.
+/**
+ * Same as rcl_wait(), but takes an absolute deadline on the steady clock, as
+ * returned by rcutils_steady_time_now() or by rcl_clock_get_now() on a clock of
+ * type #RCL_STEADY_TIME, instead of a relative timeout.
+ * Loops which wait repeatedly until the same deadline can pass it unchanged,
+ * rather than recomputing a shrinking timeout on every iteration.
+ *
+ * If the deadline has already passed, this function does not block, like
+ * rcl_wait() with a timeout of 0.
+ * If the deadline is negative, this function blocks indefinitely, like
+ * rcl_wait() with a negative timeout.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Yes
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] wait_set the set of things to be waited on and to be pruned if not ready
+ * \param[in] deadline the steady time at which to stop waiting, in nanoseconds
+ * \return #RCL_RET_OK something in the wait set became ready, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is zero initialized, or
+ * \return #RCL_RET_WAIT_SET_EMPTY if the wait set contains no items, or
+ * \return #RCL_RET_TIMEOUT if the deadline was reached before something was ready, or
+ * \return #RCL_RET_ERROR an unspecified error occur.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_until(rcl_wait_set_t * wait_set, rcl_time_point_value_t deadline);
+
 /// Return `true` if the wait set is valid, else `false`.
 /**
  * A wait set is invalid if:
@@ -495,6 +891,193 @@ RCL_PUBLIC
 bool
 rcl_wait_set_is_valid(const rcl_wait_set_t * wait_set);
 
+/// Retrieve the statistics recorded by rcl_wait() for the wait set.
+/**
+ * The statistics are only recorded if the wait set was initialized with the
+ * `statistics` option, in which case the cost of recording them is four
+ * reads of the steady clock per call to rcl_wait(), around the whole call and
+ * around the blocking wait of the middleware.
+ *
+ * The statistics are copied into the given struct, and keep accumulating
+ * until rcl_wait_set_reset_statistics() is called.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] wait_set the handle to the wait set
+ * \param[out] statistics the struct to which the statistics are copied
+ * \return #RCL_RET_OK if the statistics were successfully retrieved, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is invalid, or
+ * \return #RCL_RET_ERROR if statistics are not enabled for the wait set.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_get_statistics(
+  const rcl_wait_set_t * wait_set,
+  rcl_wait_set_statistics_t * statistics);
+
+/// Reset the statistics recorded by rcl_wait() for the wait set to zero.
+/**
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] wait_set the handle to the wait set
+ * \return #RCL_RET_OK if the statistics were successfully reset, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is invalid, or
+ * \return #RCL_RET_ERROR if statistics are not enabled for the wait set.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_reset_statistics(rcl_wait_set_t * wait_set);
+
+/// Set the priority and deadline of an entity in the wait set.
+/**
+ * The entity is identified by its kind and the index at which it was added,
+ * as returned by the `rcl_wait_set_add_*` functions.
+ * Entities are ordered by decreasing priority, then by increasing deadline.
+ * The unit of the deadline is up to the caller, e.g. the latency in
+ * nanoseconds within which the entity should be handled once ready.
+ *
+ * The priority and deadline are kept until the entity is removed from the
+ * wait set, or until rcl_wait_set_clear() or rcl_wait_set_resize() is called.
+ * Entities for which nothing was set have the #RCL_WAIT_SET_DEFAULT_PRIORITY
+ * and the #RCL_WAIT_SET_NO_DEADLINE.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[inout] wait_set the handle to the wait set
+ * \param[in] type the kind of the entity
+ * \param[in] index the index of the entity in the entity array of its kind
+ * \param[in] priority the priority of the entity, larger values are more important
+ * \param[in] deadline the deadline of the entity, smaller values are more urgent
+ * \return #RCL_RET_OK if the priority was successfully set, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or if no
+ *   entity of the given kind was added at the given index, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is invalid, or
+ * \return #RCL_RET_ERROR if priorities are not enabled for the wait set.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_set_priority(
+  rcl_wait_set_t * wait_set,
+  rcl_wait_set_entity_type_t type,
+  size_t index,
+  int32_t priority,
+  int64_t deadline);
+
+/// Retrieve the entities found ready by the last call to rcl_wait(), in priority order.
+/**
+ * The ready entities of all kinds are ordered by decreasing priority, then by
+ * increasing deadline, so that an executor can dispatch them in order without
+ * sorting them itself.
+ * Entities with the same priority and deadline keep the order of their kind
+ * in rcl_wait_set_entity_type_t, then of their index.
+ *
+ * The returned array is owned by the wait set, and is only valid until the
+ * next call to rcl_wait(), rcl_wait_set_clear() or rcl_wait_set_resize().
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | No
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ *
+ * \param[in] wait_set the handle to the wait set
+ * \param[out] entities set to the ordered array of ready entities
+ * \param[out] count set to the number of ready entities
+ * \return #RCL_RET_OK if the ready entities were successfully retrieved, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is invalid, or
+ * \return #RCL_RET_ERROR if priorities are not enabled for the wait set.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_wait_set_get_prioritized_ready(
+  const rcl_wait_set_t * wait_set,
+  const rcl_wait_set_ready_entity_t ** entities,
+  size_t * count);
+
+/// Take one ROS message from each subscription found ready by the last call to rcl_wait().
+/**
+ * This function behaves like calling rcl_take() on every non-`NULL` entry of
+ * `wait_set->subscriptions`, but it validates the wait set and its arguments
+ * once for the whole batch instead of once per subscription.
+ * The subscriptions were already validated when they were added to the wait
+ * set, so each entry is only checked for having been initialized.
+ *
+ * The `ros_messages`, `message_infos` and `results` arrays are indexed like
+ * `wait_set->subscriptions`, and must all hold at least
+ * `wait_set->size_of_subscriptions` elements.
+ * Each element of `ros_messages` should point to an already allocated ROS
+ * message of the type of the subscription at the same index; elements for
+ * subscriptions which were not ready may be `NULL`.
+ * It is the job of the caller to ensure that these types match.
+ *
+ * Passing `NULL` for `message_infos` will result in the meta-data being
+ * ignored.
+ * Otherwise each element is filled by the middleware when a message is taken,
+ * and is left untouched otherwise.
+ *
+ * Each element of `results` is set to the value rcl_take() would have
+ * returned for the subscription at the same index, or to
+ * #RCL_RET_SUBSCRIPTION_TAKE_FAILED if the subscription was not ready.
+ * When an element is set to an error, the error message of the last failing
+ * take is kept.
+ *
+ * <hr>
+ * Attribute          | Adherence
+ * ------------------ | -------------
+ * Allocates Memory   | Maybe [1]
+ * Thread-Safe        | No
+ * Uses Atomics       | No
+ * Lock-Free          | Yes
+ * <i>[1] only if required when filling the messages, avoided for fixed sizes</i>
+ *
+ * \param[in] wait_set the wait set which was last passed to rcl_wait()
+ * \param[inout] ros_messages type-erased ptrs to allocated ROS messages, one per subscription
+ * \param[out] message_infos rmw structs which contain meta-data for the messages (may be NULL)
+ * \param[out] results the result of the take for each subscription
+ * \param[out] taken_count set to the number of messages taken (may be NULL)
+ * \return #RCL_RET_OK if at least one message was taken, or
+ * \return #RCL_RET_INVALID_ARGUMENT if any arguments are invalid, or
+ * \return #RCL_RET_WAIT_SET_INVALID if the wait set is invalid, or
+ * \return #RCL_RET_SUBSCRIPTION_TAKE_FAILED if no message was taken, in which
+ *   case `results` tells whether any take failed with an error.
+ */
+RCL_PUBLIC
+RCL_WARN_UNUSED
+rcl_ret_t
+rcl_take_many(
+  const rcl_wait_set_t * wait_set,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  rcl_ret_t * results,
+  size_t * taken_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1077 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "./content_filter_impl.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rcl/error_handling.h"
+#include "rcutils/macros.h"
+#include "rmw/error_handling.h"
+#include "rmw/rmw.h"
+#include "rosidl_runtime_c/string.h"
+#include "rosidl_typesupport_introspection_c/field_types.h"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+
+// Deepest nesting of parentheses and NOT accepted in an expression.
+#define RCL_CONTENT_FILTER_MAX_DEPTH 64u
+
+typedef rosidl_typesupport_introspection_c__MessageMembers rcl_content_filter_members_t;
+typedef rosidl_typesupport_introspection_c__MessageMember rcl_content_filter_member_t;
+
+typedef enum rcl_content_filter_value_type_e
+{
+  RCL_CONTENT_FILTER_VALUE_INTEGER,
+  RCL_CONTENT_FILTER_VALUE_UNSIGNED,
+  RCL_CONTENT_FILTER_VALUE_FLOAT,
+  RCL_CONTENT_FILTER_VALUE_STRING,
+} rcl_content_filter_value_type_t;
+
+typedef struct rcl_content_filter_value_s
+{
+  rcl_content_filter_value_type_t type;
+  union
+  {
+    int64_t integer;
+    uint64_t unsigned_integer;
+    double floating;
+    struct
+    {
+      const char * data;
+      size_t size;
+    } string;
+  };
+} rcl_content_filter_value_t;
+
+typedef struct rcl_content_filter_operand_s
+{
+  /// Whether the operand is a field of the message, rather than a literal.
+  bool is_field;
+  uint8_t type_id;
+  /// Offset of the field from the start of the message.
+  size_t offset;
+  rcl_content_filter_value_t value;
+  /// Copy of the characters of a string literal, owned by the filter.
+  char * string_storage;
+} rcl_content_filter_operand_t;
+
+typedef enum rcl_content_filter_node_type_e
+{
+  RCL_CONTENT_FILTER_NODE_AND,
+  RCL_CONTENT_FILTER_NODE_OR,
+  RCL_CONTENT_FILTER_NODE_NOT,
+  RCL_CONTENT_FILTER_NODE_COMPARE,
+  RCL_CONTENT_FILTER_NODE_BETWEEN,
+  RCL_CONTENT_FILTER_NODE_LIKE,
+} rcl_content_filter_node_type_t;
+
+typedef enum rcl_content_filter_operator_e
+{
+  RCL_CONTENT_FILTER_OPERATOR_EQ,
+  RCL_CONTENT_FILTER_OPERATOR_NE,
+  RCL_CONTENT_FILTER_OPERATOR_LT,
+  RCL_CONTENT_FILTER_OPERATOR_LE,
+  RCL_CONTENT_FILTER_OPERATOR_GT,
+  RCL_CONTENT_FILTER_OPERATOR_GE,
+} rcl_content_filter_operator_t;
+
+struct rcl_content_filter_node_s
+{
+  rcl_content_filter_node_type_t type;
+  rcl_content_filter_operator_t comparison;
+  /// Nodes combined by AND, OR and NOT.
+  size_t children[2];
+  /// Operands of predicates, the field or value tested first.
+  rcl_content_filter_operand_t operands[3];
+};
+
+typedef struct rcl_content_filter_node_s rcl_content_filter_node_t;
+
+typedef enum rcl_content_filter_token_type_e
+{
+  RCL_CONTENT_FILTER_TOKEN_END,
+  RCL_CONTENT_FILTER_TOKEN_INVALID,
+  RCL_CONTENT_FILTER_TOKEN_FIELD,
+  RCL_CONTENT_FILTER_TOKEN_INTEGER,
+  RCL_CONTENT_FILTER_TOKEN_FLOAT,
+  RCL_CONTENT_FILTER_TOKEN_STRING,
+  RCL_CONTENT_FILTER_TOKEN_PARAMETER,
+  RCL_CONTENT_FILTER_TOKEN_TRUE,
+  RCL_CONTENT_FILTER_TOKEN_FALSE,
+  RCL_CONTENT_FILTER_TOKEN_LEFT_PARENTHESIS,
+  RCL_CONTENT_FILTER_TOKEN_RIGHT_PARENTHESIS,
+  RCL_CONTENT_FILTER_TOKEN_COMPARISON,
+  RCL_CONTENT_FILTER_TOKEN_AND,
+  RCL_CONTENT_FILTER_TOKEN_OR,
+  RCL_CONTENT_FILTER_TOKEN_NOT,
+  RCL_CONTENT_FILTER_TOKEN_BETWEEN,
+  RCL_CONTENT_FILTER_TOKEN_LIKE,
+} rcl_content_filter_token_type_t;
+
+typedef struct rcl_content_filter_token_s
+{
+  rcl_content_filter_token_type_t type;
+  rcl_content_filter_operator_t comparison;
+  const char * start;
+  size_t length;
+} rcl_content_filter_token_t;
+
+typedef struct rcl_content_filter_parser_s
+{
+  const char * expression;
+  const char * cursor;
+  rcl_content_filter_token_t token;
+  const rcl_content_filter_members_t * members;
+  size_t argc;
+  const char * const * argv;
+  rcl_allocator_t * allocator;
+  rcl_content_filter_node_t * nodes;
+  size_t node_count;
+  size_t node_capacity;
+  size_t depth;
+} rcl_content_filter_parser_t;
+
+static bool
+_rcl_content_filter_is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static bool
+_rcl_content_filter_is_identifier_start(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// Compare a token with an upper case keyword, ignoring the case of the token.
+static bool
+_rcl_content_filter_is_keyword(const char * start, size_t length, const char * keyword)
+{
+  if (strlen(keyword) != length) {
+    return false;
+  }
+  for (size_t i = 0u; i < length; ++i) {
+    char c = start[i];
+    if (c >= 'a' && c <= 'z') {
+      c = (char)(c - 'a' + 'A');
+    }
+    if (c != keyword[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static rcl_content_filter_token_t
+_rcl_content_filter_lex(const char ** cursor)
+{
+  const char * c = *cursor;
+  while (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r') {
+    ++c;
+  }
+  rcl_content_filter_token_t token;
+  token.type = RCL_CONTENT_FILTER_TOKEN_INVALID;
+  token.comparison = RCL_CONTENT_FILTER_OPERATOR_EQ;
+  token.start = c;
+
+  if ('\0' == *c) {
+    token.type = RCL_CONTENT_FILTER_TOKEN_END;
+  } else if (_rcl_content_filter_is_identifier_start(*c)) {
+    while (_rcl_content_filter_is_identifier_start(*c) || _rcl_content_filter_is_digit(*c) ||
+      *c == '.')
+    {
+      ++c;
+    }
+    size_t length = (size_t)(c - token.start);
+    token.type = RCL_CONTENT_FILTER_TOKEN_FIELD;
+    if (_rcl_content_filter_is_keyword(token.start, length, "AND")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_AND;
+    } else if (_rcl_content_filter_is_keyword(token.start, length, "OR")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_OR;
+    } else if (_rcl_content_filter_is_keyword(token.start, length, "NOT")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_NOT;
+    } else if (_rcl_content_filter_is_keyword(token.start, length, "BETWEEN")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_BETWEEN;
+    } else if (_rcl_content_filter_is_keyword(token.start, length, "LIKE")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_LIKE;
+    } else if (_rcl_content_filter_is_keyword(token.start, length, "TRUE")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_TRUE;
+    } else if (_rcl_content_filter_is_keyword(token.start, length, "FALSE")) {
+      token.type = RCL_CONTENT_FILTER_TOKEN_FALSE;
+    }
+  } else if (
+    _rcl_content_filter_is_digit(*c) ||
+    (*c == '.' && _rcl_content_filter_is_digit(c[1])) ||
+    ((*c == '-' || *c == '+') &&
+    (_rcl_content_filter_is_digit(c[1]) || (c[1] == '.' && _rcl_content_filter_is_digit(c[2])))))
+  {
+    token.type = RCL_CONTENT_FILTER_TOKEN_INTEGER;
+    if (*c == '-' || *c == '+') {
+      ++c;
+    }
+    while (_rcl_content_filter_is_digit(*c)) {
+      ++c;
+    }
+    if (*c == '.') {
+      token.type = RCL_CONTENT_FILTER_TOKEN_FLOAT;
+      ++c;
+      while (_rcl_content_filter_is_digit(*c)) {
+        ++c;
+      }
+    }
+    if (*c == 'e' || *c == 'E') {
+      token.type = RCL_CONTENT_FILTER_TOKEN_FLOAT;
+      ++c;
+      if (*c == '-' || *c == '+') {
+        ++c;
+      }
+      while (_rcl_content_filter_is_digit(*c)) {
+        ++c;
+      }
+    }
+  } else if (*c == '\'' || *c == '"') {
+    // Quotes are escaped by doubling them, as in SQL.
+    const char quote = *c++;
+    for (;; ++c) {
+      if ('\0' == *c) {
+        token.type = RCL_CONTENT_FILTER_TOKEN_INVALID;
+        break;
+      }
+      if (*c == quote) {
+        if (c[1] != quote) {
+          ++c;
+          token.type = RCL_CONTENT_FILTER_TOKEN_STRING;
+          break;
+        }
+        ++c;
+      }
+    }
+  } else if (*c == '%' && _rcl_content_filter_is_digit(c[1])) {
+    ++c;
+    while (_rcl_content_filter_is_digit(*c)) {
+      ++c;
+    }
+    token.type = RCL_CONTENT_FILTER_TOKEN_PARAMETER;
+  } else {
+    token.type = RCL_CONTENT_FILTER_TOKEN_COMPARISON;
+    switch (*c++) {
+      case '(':
+        token.type = RCL_CONTENT_FILTER_TOKEN_LEFT_PARENTHESIS;
+        break;
+      case ')':
+        token.type = RCL_CONTENT_FILTER_TOKEN_RIGHT_PARENTHESIS;
+        break;
+      case '=':
+        token.comparison = RCL_CONTENT_FILTER_OPERATOR_EQ;
+        break;
+      case '!':
+        if (*c == '=') {
+          ++c;
+          token.comparison = RCL_CONTENT_FILTER_OPERATOR_NE;
+        } else {
+          token.type = RCL_CONTENT_FILTER_TOKEN_INVALID;
+        }
+        break;
+      case '<':
+        token.comparison = RCL_CONTENT_FILTER_OPERATOR_LT;
+        if (*c == '=') {
+          ++c;
+          token.comparison = RCL_CONTENT_FILTER_OPERATOR_LE;
+        } else if (*c == '>') {
+          ++c;
+          token.comparison = RCL_CONTENT_FILTER_OPERATOR_NE;
+        }
+        break;
+      case '>':
+        token.comparison = RCL_CONTENT_FILTER_OPERATOR_GT;
+        if (*c == '=') {
+          ++c;
+          token.comparison = RCL_CONTENT_FILTER_OPERATOR_GE;
+        }
+        break;
+      default:
+        token.type = RCL_CONTENT_FILTER_TOKEN_INVALID;
+        break;
+    }
+  }
+  token.length = (size_t)(c - token.start);
+  *cursor = c;
+  return token;
+}
+
+static void
+_rcl_content_filter_advance(rcl_content_filter_parser_t * parser)
+{
+  parser->token = _rcl_content_filter_lex(&parser->cursor);
+}
+
+static rcl_ret_t
+_rcl_content_filter_syntax_error(const rcl_content_filter_parser_t * parser, const char * expected)
+{
+  RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+    "invalid filter expression, expected %s at offset %zu of '%s'",
+    expected, (size_t)(parser->token.start - parser->expression), parser->expression);
+  return RCL_RET_INVALID_ARGUMENT;
+}
+
+static rcl_ret_t
+_rcl_content_filter_predicate_error(
+  const rcl_content_filter_parser_t * parser,
+  const char * reason)
+{
+  RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+    "invalid filter expression, %s before offset %zu of '%s'",
+    reason, (size_t)(parser->token.start - parser->expression), parser->expression);
+  return RCL_RET_INVALID_ARGUMENT;
+}
+
+static void
+_rcl_content_filter_node_fini(rcl_content_filter_node_t * node, rcl_allocator_t * allocator)
+{
+  for (size_t i = 0u; i < 3u; ++i) {
+    allocator->deallocate(node->operands[i].string_storage, allocator->state);
+    node->operands[i].string_storage = NULL;
+  }
+}
+
+static rcl_ret_t
+_rcl_content_filter_add_node(
+  rcl_content_filter_parser_t * parser,
+  rcl_content_filter_node_t * node,
+  size_t * index)
+{
+  if (parser->node_count == parser->node_capacity) {
+    size_t capacity = parser->node_capacity ? 2u * parser->node_capacity : 8u;
+    rcl_content_filter_node_t * nodes = (rcl_content_filter_node_t *)parser->allocator->reallocate(
+      parser->nodes, capacity * sizeof(rcl_content_filter_node_t), parser->allocator->state);
+    if (NULL == nodes) {
+      _rcl_content_filter_node_fini(node, parser->allocator);
+      RCL_SET_ERROR_MSG("allocating memory for the filter expression failed");
+      return RCL_RET_BAD_ALLOC;
+    }
+    parser->nodes = nodes;
+    parser->node_capacity = capacity;
+  }
+  *index = parser->node_count;
+  parser->nodes[parser->node_count++] = *node;
+  return RCL_RET_OK;
+}
+
+static rcl_ret_t
+_rcl_content_filter_resolve_field(
+  rcl_content_filter_parser_t * parser,
+  const char * name,
+  size_t length,
+  rcl_content_filter_operand_t * operand)
+{
+  const rcl_content_filter_members_t * members = parser->members;
+  size_t offset = 0u;
+  const char * end = name + length;
+  for (;;) {
+    const char * dot = memchr(name, '.', (size_t)(end - name));
+    size_t name_length = (size_t)((dot ? dot : end) - name);
+    const rcl_content_filter_member_t * member = NULL;
+    for (uint32_t i = 0u; i < members->member_count_; ++i) {
+      const char * member_name = members->members_[i].name_;
+      if (0 == strncmp(member_name, name, name_length) && '\0' == member_name[name_length]) {
+        member = &members->members_[i];
+        break;
+      }
+    }
+    if (NULL == member) {
+      RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "invalid filter expression, '%.*s' is not a field of %s/%s",
+        (int)name_length, name, members->message_namespace_, members->message_name_);
+      return RCL_RET_INVALID_ARGUMENT;
+    }
+    offset += member->offset_;
+    if (member->is_array_) {
+      RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "invalid filter expression, array field '%s' cannot be filtered on", member->name_);
+      return RCL_RET_INVALID_ARGUMENT;
+    }
+    if (NULL == dot) {
+      if (
+        rosidl_typesupport_introspection_c__ROS_TYPE_MESSAGE == member->type_id_ ||
+        rosidl_typesupport_introspection_c__ROS_TYPE_WSTRING == member->type_id_)
+      {
+        RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "invalid filter expression, the type of field '%s' cannot be filtered on",
+          member->name_);
+        return RCL_RET_INVALID_ARGUMENT;
+      }
+      operand->is_field = true;
+      operand->type_id = member->type_id_;
+      operand->offset = offset;
+      return RCL_RET_OK;
+    }
+    if (rosidl_typesupport_introspection_c__ROS_TYPE_MESSAGE != member->type_id_) {
+      RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+        "invalid filter expression, field '%s' is not a message", member->name_);
+      return RCL_RET_INVALID_ARGUMENT;
+    }
+    members = (const rcl_content_filter_members_t *)member->members_->data;
+    name = dot + 1;
+  }
+}
+
+static rcl_ret_t
+_rcl_content_filter_parse_literal(
+  rcl_content_filter_parser_t * parser,
+  const rcl_content_filter_token_t * token,
+  rcl_content_filter_operand_t * operand)
+{
+  operand->is_field = false;
+  switch (token->type) {
+    case RCL_CONTENT_FILTER_TOKEN_TRUE:
+    case RCL_CONTENT_FILTER_TOKEN_FALSE:
+      operand->value.type = RCL_CONTENT_FILTER_VALUE_INTEGER;
+      operand->value.integer = RCL_CONTENT_FILTER_TOKEN_TRUE == token->type ? 1 : 0;
+      return RCL_RET_OK;
+    case RCL_CONTENT_FILTER_TOKEN_INTEGER:
+      errno = 0;
+      if ('-' == token->start[0]) {
+        operand->value.type = RCL_CONTENT_FILTER_VALUE_INTEGER;
+        operand->value.integer = strtoll(token->start, NULL, 10);
+      } else {
+        uint64_t value = strtoull(token->start, NULL, 10);
+        if (value <= INT64_MAX) {
+          operand->value.type = RCL_CONTENT_FILTER_VALUE_INTEGER;
+          operand->value.integer = (int64_t)value;
+        } else {
+          operand->value.type = RCL_CONTENT_FILTER_VALUE_UNSIGNED;
+          operand->value.unsigned_integer = value;
+        }
+      }
+      if (ERANGE == errno) {
+        RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+          "invalid filter expression, '%.*s' is out of range",
+          (int)token->length, token->start);
+        return RCL_RET_INVALID_ARGUMENT;
+      }
+      return RCL_RET_OK;
+    case RCL_CONTENT_FILTER_TOKEN_FLOAT:
+      operand->value.type = RCL_CONTENT_FILTER_VALUE_FLOAT;
+      operand->value.floating = strtod(token->start, NULL);
+      return RCL_RET_OK;
+    case RCL_CONTENT_FILTER_TOKEN_STRING:
+      {
+        // Strip the quotes and undouble the escaped ones.
+        char * storage =
+          (char *)parser->allocator->allocate(token->length, parser->allocator->state);
+        RCL_CHECK_FOR_NULL_WITH_MSG(
+          storage, "allocating memory for the filter expression failed", return RCL_RET_BAD_ALLOC);
+        size_t size = 0u;
+        for (size_t i = 1u; i + 1u < token->length; ++i) {
+          storage[size++] = token->start[i];
+          if (token->start[i] == token->start[0]) {
+            ++i;
+          }
+        }
+        storage[size] = '\0';
+        operand->string_storage = storage;
+        operand->value.type = RCL_CONTENT_FILTER_VALUE_STRING;
+        operand->value.string.data = storage;
+        operand->value.string.size = size;
+        return RCL_RET_OK;
+      }
+    case RCL_CONTENT_FILTER_TOKEN_PARAMETER:
+      {
+        size_t index = (size_t)strtoul(token->start + 1, NULL, 10);
+        if (index >= parser->argc) {
+          RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+            "invalid filter expression, expression parameter %%%zu is not given", index);
+          return RCL_RET_INVALID_ARGUMENT;
+        }
+        const char * cursor = parser->argv[index] ? parser->argv[index] : "";
+        rcl_content_filter_token_t literal = _rcl_content_filter_lex(&cursor);
+        if (
+          RCL_CONTENT_FILTER_TOKEN_PARAMETER == literal.type ||
+          RCL_CONTENT_FILTER_TOKEN_END != _rcl_content_filter_lex(&cursor).type)
+        {
+          literal.type = RCL_CONTENT_FILTER_TOKEN_INVALID;
+        }
+        switch (literal.type) {
+          case RCL_CONTENT_FILTER_TOKEN_TRUE:
+          case RCL_CONTENT_FILTER_TOKEN_FALSE:
+          case RCL_CONTENT_FILTER_TOKEN_INTEGER:
+          case RCL_CONTENT_FILTER_TOKEN_FLOAT:
+          case RCL_CONTENT_FILTER_TOKEN_STRING:
+            return _rcl_content_filter_parse_literal(parser, &literal, operand);
+          default:
+            RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+              "invalid filter expression, expression parameter %%%zu '%s' is not a literal",
+              index, parser->argv[index] ? parser->argv[index] : "");
+            return RCL_RET_INVALID_ARGUMENT;
+        }
+      }
+    default:
+      return _rcl_content_filter_syntax_error(parser, "a field or a value");
+  }
+}
+
+static rcl_ret_t
+_rcl_content_filter_parse_operand(
+  rcl_content_filter_parser_t * parser,
+  rcl_content_filter_operand_t * operand)
+{
+  rcl_ret_t ret;
+  if (RCL_CONTENT_FILTER_TOKEN_FIELD == parser->token.type) {
+    ret = _rcl_content_filter_resolve_field(
+      parser, parser->token.start, parser->token.length, operand);
+  } else {
+    ret = _rcl_content_filter_parse_literal(parser, &parser->token, operand);
+  }
+  if (RCL_RET_OK == ret) {
+    _rcl_content_filter_advance(parser);
+  }
+  return ret;
+}
+
+static bool
+_rcl_content_filter_is_string(const rcl_content_filter_operand_t * operand)
+{
+  if (operand->is_field) {
+    return rosidl_typesupport_introspection_c__ROS_TYPE_STRING == operand->type_id;
+  }
+  return RCL_CONTENT_FILTER_VALUE_STRING == operand->value.type;
+}
+
+// Check that a predicate tests a field against values of the same kind.
+static rcl_ret_t
+_rcl_content_filter_check_operands(
+  rcl_content_filter_parser_t * parser,
+  rcl_content_filter_node_t * node,
+  size_t count)
+{
+  bool has_field = false;
+  bool has_char_field = false;
+  for (size_t i = 0u; i < count; ++i) {
+    has_field |= node->operands[i].is_field;
+    has_char_field |= node->operands[i].is_field &&
+      rosidl_typesupport_introspection_c__ROS_TYPE_CHAR == node->operands[i].type_id;
+  }
+  if (!has_field) {
+    return _rcl_content_filter_predicate_error(parser, "a predicate must test a field");
+  }
+  // Character literals compare with char fields as their code.
+  for (size_t i = 0u; has_char_field && i < count; ++i) {
+    rcl_content_filter_operand_t * operand = &node->operands[i];
+    if (
+      !operand->is_field && RCL_CONTENT_FILTER_VALUE_STRING == operand->value.type &&
+      1u == operand->value.string.size)
+    {
+      int64_t code = (signed char)operand->value.string.data[0];
+      parser->allocator->deallocate(operand->string_storage, parser->allocator->state);
+      operand->string_storage = NULL;
+      operand->value.type = RCL_CONTENT_FILTER_VALUE_INTEGER;
+      operand->value.integer = code;
+    }
+  }
+  for (size_t i = 1u; i < count; ++i) {
+    if (_rcl_content_filter_is_string(&node->operands[i]) !=
+      _rcl_content_filter_is_string(&node->operands[0]))
+    {
+      return _rcl_content_filter_predicate_error(parser, "a string cannot be compared to a number");
+    }
+  }
+  if (
+    RCL_CONTENT_FILTER_NODE_LIKE == node->type &&
+    !_rcl_content_filter_is_string(node->operands))
+  {
+    return _rcl_content_filter_predicate_error(parser, "LIKE only applies to strings");
+  }
+  return RCL_RET_OK;
+}
+
+static rcl_ret_t
+_rcl_content_filter_parse_or(rcl_content_filter_parser_t * parser, size_t * index);
+
+static rcl_ret_t
+_rcl_content_filter_parse_predicate(rcl_content_filter_parser_t * parser, size_t * index)
+{
+  rcl_content_filter_node_t node;
+  memset(&node, 0, sizeof(node));
+  rcl_ret_t ret = _rcl_content_filter_parse_operand(parser, &node.operands[0]);
+  if (RCL_RET_OK != ret) {
+    return ret;
+  }
+  size_t operand_count = 2u;
+  bool negated = false;
+  if (RCL_CONTENT_FILTER_TOKEN_COMPARISON == parser->token.type) {
+    node.type = RCL_CONTENT_FILTER_NODE_COMPARE;
+    node.comparison = parser->token.comparison;
+    _rcl_content_filter_advance(parser);
+    ret = _rcl_content_filter_parse_operand(parser, &node.operands[1]);
+  } else {
+    if (RCL_CONTENT_FILTER_TOKEN_NOT == parser->token.type) {
+      negated = true;
+      _rcl_content_filter_advance(parser);
+    }
+    if (RCL_CONTENT_FILTER_TOKEN_LIKE == parser->token.type) {
+      node.type = RCL_CONTENT_FILTER_NODE_LIKE;
+      _rcl_content_filter_advance(parser);
+      ret = _rcl_content_filter_parse_operand(parser, &node.operands[1]);
+    } else if (RCL_CONTENT_FILTER_TOKEN_BETWEEN == parser->token.type) {
+      node.type = RCL_CONTENT_FILTER_NODE_BETWEEN;
+      operand_count = 3u;
+      _rcl_content_filter_advance(parser);
+      ret = _rcl_content_filter_parse_operand(parser, &node.operands[1]);
+      if (RCL_RET_OK == ret) {
+        if (RCL_CONTENT_FILTER_TOKEN_AND == parser->token.type) {
+          _rcl_content_filter_advance(parser);
+          ret = _rcl_content_filter_parse_operand(parser, &node.operands[2]);
+        } else {
+          ret = _rcl_content_filter_syntax_error(parser, "AND");
+        }
+      }
+    } else {
+      ret = _rcl_content_filter_syntax_error(parser, "a comparison, LIKE or BETWEEN");
+    }
+  }
+  if (RCL_RET_OK == ret) {
+    ret = _rcl_content_filter_check_operands(parser, &node, operand_count);
+  }
+  if (RCL_RET_OK == ret) {
+    ret = _rcl_content_filter_add_node(parser, &node, index);
+  } else {
+    _rcl_content_filter_node_fini(&node, parser->allocator);
+  }
+  if (RCL_RET_OK == ret && negated) {
+    memset(&node, 0, sizeof(node));
+    node.type = RCL_CONTENT_FILTER_NODE_NOT;
+    node.children[0] = *index;
+    ret = _rcl_content_filter_add_node(parser, &node, index);
+  }
+  return ret;
+}
+
+static rcl_ret_t
+_rcl_content_filter_parse_not(rcl_content_filter_parser_t * parser, size_t * index)
+{
+  if (++parser->depth > RCL_CONTENT_FILTER_MAX_DEPTH) {
+    return _rcl_content_filter_predicate_error(parser, "the expression is nested too deeply");
+  }
+  rcl_ret_t ret;
+  if (RCL_CONTENT_FILTER_TOKEN_NOT == parser->token.type) {
+    _rcl_content_filter_advance(parser);
+    rcl_content_filter_node_t node;
+    memset(&node, 0, sizeof(node));
+    node.type = RCL_CONTENT_FILTER_NODE_NOT;
+    ret = _rcl_content_filter_parse_not(parser, &node.children[0]);
+    if (RCL_RET_OK == ret) {
+      ret = _rcl_content_filter_add_node(parser, &node, index);
+    }
+  } else if (RCL_CONTENT_FILTER_TOKEN_LEFT_PARENTHESIS == parser->token.type) {
+    _rcl_content_filter_advance(parser);
+    ret = _rcl_content_filter_parse_or(parser, index);
+    if (RCL_RET_OK == ret) {
+      if (RCL_CONTENT_FILTER_TOKEN_RIGHT_PARENTHESIS == parser->token.type) {
+        _rcl_content_filter_advance(parser);
+      } else {
+        ret = _rcl_content_filter_syntax_error(parser, "')'");
+      }
+    }
+  } else {
+    ret = _rcl_content_filter_parse_predicate(parser, index);
+  }
+  --parser->depth;
+  return ret;
+}
+
+static rcl_ret_t
+_rcl_content_filter_parse_and(rcl_content_filter_parser_t * parser, size_t * index)
+{
+  rcl_ret_t ret = _rcl_content_filter_parse_not(parser, index);
+  while (RCL_RET_OK == ret && RCL_CONTENT_FILTER_TOKEN_AND == parser->token.type) {
+    _rcl_content_filter_advance(parser);
+    rcl_content_filter_node_t node;
+    memset(&node, 0, sizeof(node));
+    node.type = RCL_CONTENT_FILTER_NODE_AND;
+    node.children[0] = *index;
+    ret = _rcl_content_filter_parse_not(parser, &node.children[1]);
+    if (RCL_RET_OK == ret) {
+      ret = _rcl_content_filter_add_node(parser, &node, index);
+    }
+  }
+  return ret;
+}
+
+static rcl_ret_t
+_rcl_content_filter_parse_or(rcl_content_filter_parser_t * parser, size_t * index)
+{
+  rcl_ret_t ret = _rcl_content_filter_parse_and(parser, index);
+  while (RCL_RET_OK == ret && RCL_CONTENT_FILTER_TOKEN_OR == parser->token.type) {
+    _rcl_content_filter_advance(parser);
+    rcl_content_filter_node_t node;
+    memset(&node, 0, sizeof(node));
+    node.type = RCL_CONTENT_FILTER_NODE_OR;
+    node.children[0] = *index;
+    ret = _rcl_content_filter_parse_and(parser, &node.children[1]);
+    if (RCL_RET_OK == ret) {
+      ret = _rcl_content_filter_add_node(parser, &node, index);
+    }
+  }
+  return ret;
+}
+
+static rcl_content_filter_value_t
+_rcl_content_filter_read(const rcl_content_filter_operand_t * operand, const void * ros_message)
+{
+  if (!operand->is_field) {
+    return operand->value;
+  }
+  const char * field = (const char *)ros_message + operand->offset;
+  rcl_content_filter_value_t value;
+  value.type = RCL_CONTENT_FILTER_VALUE_INTEGER;
+  value.integer = 0;
+
+#define RCL_CONTENT_FILTER_READ(type_id, c_type, value_type, member) \
+  case rosidl_typesupport_introspection_c__ROS_TYPE_ ## type_id: \
+    { \
+      c_type field_value; \
+      memcpy(&field_value, field, sizeof(field_value)); \
+      value.type = RCL_CONTENT_FILTER_VALUE_ ## value_type; \
+      value.member = field_value; \
+      break; \
+    }
+
+  switch (operand->type_id) {
+    RCL_CONTENT_FILTER_READ(FLOAT, float, FLOAT, floating)
+    RCL_CONTENT_FILTER_READ(DOUBLE, double, FLOAT, floating)
+    RCL_CONTENT_FILTER_READ(LONG_DOUBLE, long double, FLOAT, floating)
+    RCL_CONTENT_FILTER_READ(CHAR, signed char, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(WCHAR, uint16_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(BOOLEAN, bool, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(OCTET, uint8_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(UINT8, uint8_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(INT8, int8_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(UINT16, uint16_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(INT16, int16_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(UINT32, uint32_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(INT32, int32_t, INTEGER, integer)
+    RCL_CONTENT_FILTER_READ(UINT64, uint64_t, UNSIGNED, unsigned_integer)
+    RCL_CONTENT_FILTER_READ(INT64, int64_t, INTEGER, integer)
+    case rosidl_typesupport_introspection_c__ROS_TYPE_STRING:
+      {
+        const rosidl_runtime_c__String * string = (const rosidl_runtime_c__String *)field;
+        value.type = RCL_CONTENT_FILTER_VALUE_STRING;
+        value.string.data = string->data ? string->data : "";
+        value.string.size = string->data ? string->size : 0u;
+        break;
+      }
+    default:
+      break;
+  }
+#undef RCL_CONTENT_FILTER_READ
+  return value;
+}
+
+static double
+_rcl_content_filter_to_double(const rcl_content_filter_value_t * value)
+{
+  switch (value->type) {
+    case RCL_CONTENT_FILTER_VALUE_INTEGER:
+      return (double)value->integer;
+    case RCL_CONTENT_FILTER_VALUE_UNSIGNED:
+      return (double)value->unsigned_integer;
+    default:
+      return value->floating;
+  }
+}
+
+// Compare two values of the same kind, returning false if they are unordered (NaN).
+static bool
+_rcl_content_filter_compare(
+  const rcl_content_filter_value_t * left,
+  const rcl_content_filter_value_t * right,
+  int * order)
+{
+  if (RCL_CONTENT_FILTER_VALUE_STRING == left->type) {
+    size_t size = left->string.size < right->string.size ? left->string.size : right->string.size;
+    int result = memcmp(left->string.data, right->string.data, size);
+    if (0 == result) {
+      result = (left->string.size > right->string.size) - (left->string.size < right->string.size);
+    }
+    *order = result;
+    return true;
+  }
+  if (
+    RCL_CONTENT_FILTER_VALUE_FLOAT == left->type ||
+    RCL_CONTENT_FILTER_VALUE_FLOAT == right->type)
+  {
+    double a = _rcl_content_filter_to_double(left);
+    double b = _rcl_content_filter_to_double(right);
+    if (a != a || b != b) {
+      return false;
+    }
+    *order = (a > b) - (a < b);
+    return true;
+  }
+  if (left->type == right->type) {
+    if (RCL_CONTENT_FILTER_VALUE_INTEGER == left->type) {
+      *order = (left->integer > right->integer) - (left->integer < right->integer);
+    } else {
+      *order = (left->unsigned_integer > right->unsigned_integer) -
+        (left->unsigned_integer < right->unsigned_integer);
+    }
+    return true;
+  }
+  // One value is signed and the other is beyond the range of signed values.
+  if (RCL_CONTENT_FILTER_VALUE_INTEGER == left->type) {
+    *order = -1;
+  } else {
+    *order = 1;
+  }
+  return true;
+}
+
+static bool
+_rcl_content_filter_like(const char * string, size_t size, const char * pattern, size_t length)
+{
+  // Match greedily, going back to the last '%' on a mismatch.
+  size_t s = 0u;
+  size_t p = 0u;
+  size_t last_wildcard = SIZE_MAX;
+  size_t last_match = 0u;
+  while (s < size) {
+    if (p < length && (pattern[p] == '_' || pattern[p] == string[s])) {
+      ++s;
+      ++p;
+    } else if (p < length && pattern[p] == '%') {
+      last_wildcard = p++;
+      last_match = s;
+    } else if (SIZE_MAX != last_wildcard) {
+      p = last_wildcard + 1u;
+      s = ++last_match;
+    } else {
+      return false;
+    }
+  }
+  while (p < length && pattern[p] == '%') {
+    ++p;
+  }
+  return p == length;
+}
+
+static bool
+_rcl_content_filter_evaluate(
+  const rcl_content_filter_t * filter,
+  size_t index,
+  const void * ros_message)
+{
+  const rcl_content_filter_node_t * node = &filter->nodes[index];
+  switch (node->type) {
+    case RCL_CONTENT_FILTER_NODE_AND:
+      return
+        _rcl_content_filter_evaluate(filter, node->children[0], ros_message) &&
+        _rcl_content_filter_evaluate(filter, node->children[1], ros_message);
+    case RCL_CONTENT_FILTER_NODE_OR:
+      return
+        _rcl_content_filter_evaluate(filter, node->children[0], ros_message) ||
+        _rcl_content_filter_evaluate(filter, node->children[1], ros_message);
+    case RCL_CONTENT_FILTER_NODE_NOT:
+      return !_rcl_content_filter_evaluate(filter, node->children[0], ros_message);
+    default:
+      break;
+  }
+  rcl_content_filter_value_t left = _rcl_content_filter_read(&node->operands[0], ros_message);
+  rcl_content_filter_value_t right = _rcl_content_filter_read(&node->operands[1], ros_message);
+  if (RCL_CONTENT_FILTER_NODE_LIKE == node->type) {
+    return _rcl_content_filter_like(
+      left.string.data, left.string.size, right.string.data, right.string.size);
+  }
+  int order = 0;
+  bool ordered = _rcl_content_filter_compare(&left, &right, &order);
+  if (RCL_CONTENT_FILTER_NODE_BETWEEN == node->type) {
+    rcl_content_filter_value_t upper = _rcl_content_filter_read(&node->operands[2], ros_message);
+    int upper_order = 0;
+    return
+      ordered && order >= 0 &&
+      _rcl_content_filter_compare(&left, &upper, &upper_order) && upper_order <= 0;
+  }
+  switch (node->comparison) {
+    case RCL_CONTENT_FILTER_OPERATOR_EQ:
+      return ordered && 0 == order;
+    case RCL_CONTENT_FILTER_OPERATOR_NE:
+      return !ordered || 0 != order;
+    case RCL_CONTENT_FILTER_OPERATOR_LT:
+      return ordered && order < 0;
+    case RCL_CONTENT_FILTER_OPERATOR_LE:
+      return ordered && order <= 0;
+    case RCL_CONTENT_FILTER_OPERATOR_GT:
+      return ordered && order > 0;
+    case RCL_CONTENT_FILTER_OPERATOR_GE:
+      return ordered && order >= 0;
+    default:
+      return false;
+  }
+}
+
+static void
+_rcl_content_filter_release(rcl_content_filter_t * filter, rcl_allocator_t * allocator)
+{
+  if (filter->nodes) {
+    for (size_t i = 0u; i < filter->node_count; ++i) {
+      _rcl_content_filter_node_fini(&filter->nodes[i], allocator);
+    }
+    allocator->deallocate(filter->nodes, allocator->state);
+  }
+  if (filter->scratch_message) {
+    filter->scratch_message_fini(filter->scratch_message);
+    allocator->deallocate(filter->scratch_message, allocator->state);
+  }
+  filter->nodes = NULL;
+  filter->node_count = 0u;
+  filter->root = 0u;
+  filter->scratch_message = NULL;
+  filter->scratch_message_fini = NULL;
+}
+
+void
+rcl_content_filter_init(rcl_content_filter_t * filter)
+{
+  filter->nodes = NULL;
+  filter->node_count = 0u;
+  filter->root = 0u;
+  filter->scratch_message = NULL;
+  filter->scratch_message_fini = NULL;
+  atomic_init(&filter->matched_count, 0u);
+  atomic_init(&filter->filtered_count, 0u);
+}
+
+rcl_ret_t
+rcl_content_filter_set(
+  rcl_content_filter_t * filter,
+  const rosidl_message_type_support_t * type_support,
+  const char * filter_expression,
+  size_t expression_parameters_argc,
+  const char * const * expression_parameter_argv,
+  rcl_allocator_t * allocator)
+{
+  rcl_content_filter_parser_t parser;
+  memset(&parser, 0, sizeof(parser));
+  parser.expression = filter_expression ? filter_expression : "";
+  parser.cursor = parser.expression;
+  _rcl_content_filter_advance(&parser);
+  if (RCL_CONTENT_FILTER_TOKEN_END == parser.token.type) {
+    _rcl_content_filter_release(filter, allocator);
+    return RCL_RET_OK;
+  }
+
+  const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+    type_support, rosidl_typesupport_introspection_c__identifier);
+  if (NULL == introspection) {
+    rcl_reset_error();
+    RCL_SET_ERROR_MSG("message type has no C introspection type support to filter messages");
+    return RCL_RET_UNSUPPORTED;
+  }
+  parser.members = (const rcl_content_filter_members_t *)introspection->data;
+  parser.argc = expression_parameters_argc;
+  parser.argv = expression_parameter_argv;
+  parser.allocator = allocator;
+
+  size_t root = 0u;
+  rcl_ret_t ret = _rcl_content_filter_parse_or(&parser, &root);
+  if (RCL_RET_OK == ret && RCL_CONTENT_FILTER_TOKEN_END != parser.token.type) {
+    ret = _rcl_content_filter_syntax_error(&parser, "AND, OR or the end");
+  }
+  void * scratch_message = NULL;
+  if (RCL_RET_OK == ret) {
+    scratch_message = allocator->zero_allocate(1u, parser.members->size_of_, allocator->state);
+    if (NULL == scratch_message) {
+      RCL_SET_ERROR_MSG("allocating memory for the filter expression failed");
+      ret = RCL_RET_BAD_ALLOC;
+    } else {
+      parser.members->init_function(scratch_message, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+    }
+  }
+  if (RCL_RET_OK != ret) {
+    for (size_t i = 0u; i < parser.node_count; ++i) {
+      _rcl_content_filter_node_fini(&parser.nodes[i], allocator);
+    }
+    allocator->deallocate(parser.nodes, allocator->state);
+    return ret;
+  }
+
+  _rcl_content_filter_release(filter, allocator);
+  filter->nodes = parser.nodes;
+  filter->node_count = parser.node_count;
+  filter->root = root;
+  filter->scratch_message = scratch_message;
+  filter->scratch_message_fini = parser.members->fini_function;
+  return RCL_RET_OK;
+}
+
+void
+rcl_content_filter_fini(rcl_content_filter_t * filter, rcl_allocator_t * allocator)
+{
+  _rcl_content_filter_release(filter, allocator);
+}
+
+bool
+rcl_content_filter_is_enabled(const rcl_content_filter_t * filter)
+{
+  return NULL != filter->nodes;
+}
+
+bool
+rcl_content_filter_accept(rcl_content_filter_t * filter, const void * ros_message)
+{
+  if (NULL == filter->nodes) {
+    return true;
+  }
+  bool matched = _rcl_content_filter_evaluate(filter, filter->root, ros_message);
+  uint_least64_t previous = 0u;
+  if (matched) {
+    rcutils_atomic_fetch_add(&filter->matched_count, previous, 1u);
+  } else {
+    rcutils_atomic_fetch_add(&filter->filtered_count, previous, 1u);
+  }
+  RCUTILS_UNUSED(previous);
+  return matched;
+}
+
+rcl_ret_t
+rcl_content_filter_accept_serialized(
+  rcl_content_filter_t * filter,
+  const rosidl_message_type_support_t * type_support,
+  const rcl_serialized_message_t * serialized_message,
+  bool * accepted)
+{
+  if (NULL == filter->nodes) {
+    *accepted = true;
+    return RCL_RET_OK;
+  }
+  rmw_ret_t rmw_ret = rmw_deserialize(serialized_message, type_support, filter->scratch_message);
+  if (RMW_RET_OK != rmw_ret) {
+    RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+    return RCL_RET_ERROR;
+  }
+  *accepted = rcl_content_filter_accept(filter, filter->scratch_message);
+  return RCL_RET_OK;
+}
+
+#ifdef __cplusplus
+}
+#endif
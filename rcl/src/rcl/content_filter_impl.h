@@ -0,0 +1,123 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__CONTENT_FILTER_IMPL_H_
+#define RCL__CONTENT_FILTER_IMPL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "rcl/allocator.h"
+#include "rcl/types.h"
+#include "rcl/visibility_control.h"
+#include "rcutils/stdatomic_helper.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct rcl_content_filter_node_s;
+
+/// Filter expression evaluated by rcl, for middlewares without content filtering.
+/**
+ * The expression is compiled once, when it is set, against the C introspection
+ * type support of the message type: field names are resolved to offsets in the
+ * message and expression parameters are substituted, so evaluating a message
+ * only reads its fields and compares them.
+ *
+ * The supported subset of the DDS-SQL filter grammar is made of comparisons
+ * (`=`, `<>`, `!=`, `<`, `<=`, `>`, `>=`), `LIKE` with the `%` and `_`
+ * wildcards, `BETWEEN`, combined with `AND`, `OR`, `NOT` and parentheses.
+ * Operands are fields of primitive or string type, possibly nested in
+ * messages with dotted names, literals and `%n` expression parameters.
+ */
+typedef struct rcl_content_filter_s
+{
+  /// Nodes of the compiled expression, or `NULL` if no filter is set.
+  struct rcl_content_filter_node_s * nodes;
+  size_t node_count;
+  size_t root;
+  /// Message of the filtered type to deserialize serialized messages into.
+  void * scratch_message;
+  void (* scratch_message_fini)(void *);
+  /// Number of messages which matched the filter.
+  atomic_uint_least64_t matched_count;
+  /// Number of messages which did not match the filter, and were dropped.
+  atomic_uint_least64_t filtered_count;
+} rcl_content_filter_t;
+
+/// Initialize a filter without expression.
+RCL_LOCAL
+void
+rcl_content_filter_init(rcl_content_filter_t * filter);
+
+/// Compile a filter expression and replace the current one with it.
+/**
+ * An empty expression removes the filter.
+ * The current expression is kept if the new one cannot be compiled, and the
+ * counters are kept in any case.
+ *
+ * \return #RCL_RET_OK if the expression was compiled, or
+ * \return #RCL_RET_INVALID_ARGUMENT if the expression is invalid for the type, or
+ * \return #RCL_RET_UNSUPPORTED if the type support has no C introspection, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed.
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_content_filter_set(
+  rcl_content_filter_t * filter,
+  const rosidl_message_type_support_t * type_support,
+  const char * filter_expression,
+  size_t expression_parameters_argc,
+  const char * const * expression_parameter_argv,
+  rcl_allocator_t * allocator);
+
+/// Remove the expression of the filter and deallocate it.
+RCL_LOCAL
+void
+rcl_content_filter_fini(rcl_content_filter_t * filter, rcl_allocator_t * allocator);
+
+/// Return whether an expression is set.
+RCL_LOCAL
+bool
+rcl_content_filter_is_enabled(const rcl_content_filter_t * filter);
+
+/// Evaluate the filter on a ROS message and count the result.
+/**
+ * \return `true` if the message matches the filter, or if no filter is set.
+ */
+RCL_LOCAL
+bool
+rcl_content_filter_accept(rcl_content_filter_t * filter, const void * ros_message);
+
+/// Deserialize a message and evaluate the filter on it, counting the result.
+/**
+ * \return #RCL_RET_OK if the filter was evaluated, or
+ * \return #RCL_RET_ERROR if the message could not be deserialized.
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_content_filter_accept_serialized(
+  rcl_content_filter_t * filter,
+  const rosidl_message_type_support_t * type_support,
+  const rcl_serialized_message_t * serialized_message,
+  bool * accepted);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__CONTENT_FILTER_IMPL_H_
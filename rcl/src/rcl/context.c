@@ -162,6 +162,9 @@ __cleanup_context(rcl_context_t * context)
       }
     }
 
+    // clean up the intra-process registry, whose publishers and subscriptions are finalized by now
+    rcl_intra_process_registry_fini(&(context->impl->intra_process_registry), &allocator);
+
     // clean up copy of argv if valid
     if (NULL != context->impl->argv) {
       int64_t i;
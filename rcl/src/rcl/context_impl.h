@@ -19,6 +19,7 @@
 #include "rcl/error_handling.h"
 
 #include "./init_options_impl.h"
+#include "./intra_process_impl.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -38,6 +39,8 @@ struct rcl_context_impl_s
   char ** argv;
   /// rmw context.
   rmw_context_t rmw_context;
+  /// Subscriptions which receive shared messages from publishers of this context.
+  rcl_intra_process_registry_t intra_process_registry;
 };
 
 RCL_LOCAL
@@ -0,0 +1,47 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__COUNTERS_IMPL_H_
+#define RCL__COUNTERS_IMPL_H_
+
+#include <stdint.h>
+
+#include "rcutils/stdatomic_helper.h"
+
+// Counters of the publisher and subscription hot paths.
+// They only count events, nothing is ordered by them, so they are updated
+// and read with relaxed atomics.
+// Building rcl with RCL_DISABLE_STATISTICS defined removes them entirely.
+#ifndef RCL_DISABLE_STATISTICS
+
+typedef atomic_uint_least64_t rcl_counter_t;
+
+#define RCL_COUNTER_INIT(counter) atomic_init((counter), 0u)
+
+#define RCL_COUNTER_ADD(counter, value) \
+  ((void)atomic_fetch_add_explicit((counter), (uint64_t)(value), memory_order_relaxed))
+
+#define RCL_COUNTER_LOAD(counter) \
+  ((uint64_t)atomic_load_explicit((counter), memory_order_relaxed))
+
+#else
+
+#define RCL_COUNTER_INIT(counter)
+
+// The value is still referenced, so that the locals accumulating it are not unused.
+#define RCL_COUNTER_ADD(counter, value) ((void)(value))
+
+#endif  // RCL_DISABLE_STATISTICS
+
+#endif  // RCL__COUNTERS_IMPL_H_
@@ -554,23 +554,27 @@ _rcl_wait_for_entities(
     goto cleanup;
   }
 
-  // Get current time
-  // We use system time to be consistent with the clock used by rcl_wait()
-  rcutils_time_point_value_t start;
-  rcutils_ret_t time_ret = rcutils_system_time_now(&start);
-  if (time_ret != RCUTILS_RET_OK) {
-    rcutils_error_string_t error = rcutils_get_error_string();
-    rcutils_reset_error();
-    RCL_SET_ERROR_MSG(error.str);
-    ret = RCL_RET_ERROR;
-    goto cleanup;
+  // Compute the deadline once, so that waking up repeatedly does not shorten
+  // or lengthen the overall timeout.
+  rcl_time_point_value_t deadline = -1;
+  if (timeout >= 0) {
+    rcutils_time_point_value_t start;
+    rcutils_ret_t time_ret = rcutils_steady_time_now(&start);
+    if (time_ret != RCUTILS_RET_OK) {
+      rcutils_error_string_t error = rcutils_get_error_string();
+      rcutils_reset_error();
+      RCL_SET_ERROR_MSG(error.str);
+      ret = RCL_RET_ERROR;
+      goto cleanup;
+    }
+    deadline = timeout < INT64_MAX - start ? start + timeout : INT64_MAX;
   }
 
   // Wait for expected count or timeout
   rcl_ret_t wait_ret;
   while (true) {
     // Use separate 'wait_ret' code to avoid returning spurious TIMEOUT value
-    wait_ret = rcl_wait(&wait_set, timeout);
+    wait_ret = rcl_wait_until(&wait_set, deadline);
     if (wait_ret != RCL_RET_OK && wait_ret != RCL_RET_TIMEOUT) {
       // Error message already set
       ret = wait_ret;
@@ -588,10 +592,14 @@ _rcl_wait_for_entities(
       break;
     }
 
-    // If we're not waiting indefinitely, compute time remaining
-    if (timeout >= 0) {
+    // If we're not waiting indefinitely, stop once the deadline has passed
+    if (wait_ret == RCL_RET_TIMEOUT) {
+      ret = RCL_RET_TIMEOUT;
+      break;
+    }
+    if (deadline >= 0) {
       rcutils_time_point_value_t now;
-      time_ret = rcutils_system_time_now(&now);
+      rcutils_ret_t time_ret = rcutils_steady_time_now(&now);
       if (time_ret != RCUTILS_RET_OK) {
         rcutils_error_string_t error = rcutils_get_error_string();
         rcutils_reset_error();
@@ -599,8 +607,7 @@ _rcl_wait_for_entities(
         ret = RCL_RET_ERROR;
         break;
       }
-      timeout = timeout - (now - start);
-      if (timeout <= 0) {
+      if (now >= deadline) {
         ret = RCL_RET_TIMEOUT;
         break;
       }
@@ -612,6 +619,12 @@ _rcl_wait_for_entities(
       // Error message already set
       break;
     }
+    // Add the guard condition back, since clearing the wait set removed it
+    ret = rcl_wait_set_add_guard_condition(&wait_set, guard_condition, NULL);
+    if (ret != RCL_RET_OK) {
+      // Error message already set
+      break;
+    }
   }
 
   rcl_ret_t cleanup_ret;
@@ -21,16 +21,20 @@ extern "C"
 
 #include "rcl/error_handling.h"
 #include "rcl/rcl.h"
+#include "rcutils/stdatomic_helper.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 
 #include "./context_impl.h"
+#include "./guard_condition_impl.h"
 
 struct rcl_guard_condition_impl_s
 {
   rmw_guard_condition_t * rmw_handle;
   bool allocated_rmw_guard_condition;
   rcl_guard_condition_options_t options;
+  // Triggers since the last one forwarded to the middleware was consumed by a wait.
+  atomic_uint_least64_t pending_triggers;
 };
 
 rcl_guard_condition_t
@@ -95,6 +99,7 @@ __rcl_guard_condition_init_from_rmw_impl(
   }
   // Copy options into impl.
   guard_condition->impl->options = options;
+  atomic_init(&guard_condition->impl->pending_triggers, 0u);
   return RCL_RET_OK;
 }
 
@@ -156,14 +161,60 @@ rcl_trigger_guard_condition(rcl_guard_condition_t * guard_condition)
   if (!options) {
     return RCL_RET_INVALID_ARGUMENT;  // error already set
   }
+  // A guard condition created by rcl is only waited on through rcl_wait(), so
+  // triggering it again while the middleware holds an unconsumed trigger is redundant.
+  // Borrowed rmw guard conditions may be waited on elsewhere, so are always triggered.
+  const bool coalesce = guard_condition->impl->allocated_rmw_guard_condition;
+  if (coalesce) {
+    uint_least64_t previous = 0u;
+    rcutils_atomic_fetch_add(&guard_condition->impl->pending_triggers, previous, 1u);
+    if (0u != previous) {
+      return RCL_RET_OK;
+    }
+  }
   // Trigger the guard condition.
   if (rmw_trigger_guard_condition(guard_condition->impl->rmw_handle) != RMW_RET_OK) {
+    if (coalesce) {
+      rcutils_atomic_store(&guard_condition->impl->pending_triggers, 0u);
+    }
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     return RCL_RET_ERROR;
   }
   return RCL_RET_OK;
 }
 
+void
+rcl_guard_condition_begin_wait(const rcl_guard_condition_t * guard_condition)
+{
+  if (NULL == guard_condition || NULL == guard_condition->impl) {
+    return;
+  }
+  // The triggers coalesced so far are all answered by the wait seeing the forwarded one.
+  uint_least64_t pending = rcutils_atomic_load_uint64_t(&guard_condition->impl->pending_triggers);
+  bool exchanged = false;
+  while (pending > 1u && !exchanged) {
+    rcutils_atomic_compare_exchange_strong(
+      &guard_condition->impl->pending_triggers, exchanged, &pending, 1u);
+  }
+}
+
+void
+rcl_guard_condition_finish_wait(const rcl_guard_condition_t * guard_condition)
+{
+  if (NULL == guard_condition || NULL == guard_condition->impl) {
+    return;
+  }
+  const uint64_t pending = rcutils_atomic_exchange_uint64_t(
+    &guard_condition->impl->pending_triggers, 0u);
+  if (pending > 1u) {
+    // Triggers coalesced during the wait may have come after it consumed the
+    // forwarded one, so forward one again rather than risk losing them.
+    if (RCL_RET_OK != rcl_trigger_guard_condition((rcl_guard_condition_t *)guard_condition)) {
+      rcl_reset_error();
+    }
+  }
+}
+
 const rcl_guard_condition_options_t *
 rcl_guard_condition_get_options(const rcl_guard_condition_t * guard_condition)
 {
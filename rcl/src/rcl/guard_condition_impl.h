@@ -0,0 +1,49 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__GUARD_CONDITION_IMPL_H_
+#define RCL__GUARD_CONDITION_IMPL_H_
+
+#include "rcl/guard_condition.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// Mark the triggers of the guard condition coalesced so far as answered by the next wait.
+/**
+ * Must be called before waiting on the guard condition, so that only the
+ * triggers coalesced during the wait are forwarded again after it.
+ */
+RCL_LOCAL
+void
+rcl_guard_condition_begin_wait(const rcl_guard_condition_t * guard_condition);
+
+/// Forward the next trigger of the guard condition to the middleware again.
+/**
+ * Must be called after every wait on the guard condition returned, since the
+ * wait may have consumed the trigger which made further triggers redundant.
+ * If triggers were coalesced since, one is forwarded again, which may wake up
+ * the next wait spuriously but never loses a trigger.
+ */
+RCL_LOCAL
+void
+rcl_guard_condition_finish_wait(const rcl_guard_condition_t * guard_condition);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__GUARD_CONDITION_IMPL_H_
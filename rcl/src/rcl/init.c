@@ -96,6 +96,9 @@ rcl_init(
   // Store the allocator.
   context->impl->allocator = allocator;
 
+  // No publisher delivers shared messages yet.
+  rcl_intra_process_registry_init(&(context->impl->intra_process_registry), &allocator);
+
   // Copy the options into the context for future reference.
   rcl_ret_t ret = rcl_init_options_copy(options, &(context->impl->init_options));
   if (RCL_RET_OK != ret) {
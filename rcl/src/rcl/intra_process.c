@@ -0,0 +1,621 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "rcl/intra_process.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rcl/error_handling.h"
+#include "rcutils/macros.h"
+#include "rmw/error_handling.h"
+#include "rmw/qos_profiles.h"
+
+#include "./context_impl.h"
+#include "./intra_process_impl.h"
+#include "./publisher_impl.h"
+#include "./subscription_impl.h"
+
+struct rcl_shared_message_s
+{
+  void * ros_message;
+  rcl_shared_message_deleter_t deleter;
+  void * deleter_state;
+  atomic_uint_least64_t ref_count;
+  rcl_allocator_t allocator;
+};
+
+rcl_shared_message_t *
+rcl_shared_message_create(
+  void * ros_message,
+  rcl_shared_message_deleter_t deleter,
+  void * deleter_state,
+  rcl_allocator_t * allocator)
+{
+  rcl_shared_message_t * message = (rcl_shared_message_t *)allocator->allocate(
+    sizeof(rcl_shared_message_t), allocator->state);
+  RCL_CHECK_FOR_NULL_WITH_MSG(message, "allocating memory failed", return NULL);
+  message->ros_message = ros_message;
+  message->deleter = deleter;
+  message->deleter_state = deleter_state;
+  atomic_init(&message->ref_count, 1u);
+  message->allocator = *allocator;
+  return message;
+}
+
+static void
+_rcl_shared_message_retain(rcl_shared_message_t * message)
+{
+  uint_least64_t previous = 0u;
+  rcutils_atomic_fetch_add(&message->ref_count, previous, 1u);
+  RCUTILS_UNUSED(previous);
+}
+
+const void *
+rcl_shared_message_get_ros_message(const rcl_shared_message_t * shared_message)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(shared_message, NULL);
+  return shared_message->ros_message;
+}
+
+void
+rcl_shared_message_release(rcl_shared_message_t * shared_message)
+{
+  if (NULL == shared_message) {
+    return;
+  }
+  uint_least64_t previous = 0u;
+  rcutils_atomic_fetch_sub(&shared_message->ref_count, previous, 1u);
+  if (1u != previous) {
+    return;
+  }
+  if (shared_message->deleter) {
+    shared_message->deleter(shared_message->ros_message, shared_message->deleter_state);
+  }
+  rcl_allocator_t allocator = shared_message->allocator;
+  allocator.deallocate(shared_message, allocator.state);
+}
+
+rcl_ret_t
+rcl_intra_process_ring_init(
+  rcl_intra_process_ring_t * ring,
+  size_t capacity,
+  rcl_allocator_t * allocator)
+{
+  if (0u == capacity) {
+    capacity = 1u;
+  }
+  ring->cells = (rcl_intra_process_ring_cell_t *)allocator->allocate(
+    capacity * sizeof(rcl_intra_process_ring_cell_t), allocator->state);
+  RCL_CHECK_FOR_NULL_WITH_MSG(ring->cells, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+  for (size_t i = 0u; i < capacity; ++i) {
+    atomic_init(&ring->cells[i].sequence, i);
+    ring->cells[i].message = NULL;
+  }
+  ring->capacity = capacity;
+  atomic_init(&ring->head, 0u);
+  atomic_init(&ring->tail, 0u);
+  return RCL_RET_OK;
+}
+
+void
+rcl_intra_process_ring_fini(rcl_intra_process_ring_t * ring, rcl_allocator_t * allocator)
+{
+  if (NULL == ring->cells) {
+    return;
+  }
+  rcl_shared_message_t * message = NULL;
+  while (NULL != (message = rcl_intra_process_ring_pop(ring))) {
+    rcl_shared_message_release(message);
+  }
+  allocator->deallocate(ring->cells, allocator->state);
+  ring->cells = NULL;
+  ring->capacity = 0u;
+}
+
+rcl_shared_message_t *
+rcl_intra_process_ring_pop(rcl_intra_process_ring_t * ring)
+{
+  for (;;) {
+    uint_least64_t position = rcutils_atomic_load_uint64_t(&ring->head);
+    rcl_intra_process_ring_cell_t * cell = &ring->cells[position % ring->capacity];
+    uint64_t sequence = rcutils_atomic_load_uint64_t(&cell->sequence);
+    int64_t difference = (int64_t)(sequence - (position + 1u));
+    if (difference < 0) {
+      return NULL;  // empty
+    }
+    if (0 == difference) {
+      bool claimed = false;
+      rcutils_atomic_compare_exchange_strong(&ring->head, claimed, &position, position + 1u);
+      if (claimed) {
+        rcl_shared_message_t * message = cell->message;
+        cell->message = NULL;
+        rcutils_atomic_store(&cell->sequence, position + ring->capacity);
+        return message;
+      }
+    }
+    // Another consumer claimed the cell first, try the next one.
+  }
+}
+
+// Push a message into the ring, taking over one reference to it.
+static void
+_rcl_intra_process_ring_push(rcl_intra_process_ring_t * ring, rcl_shared_message_t * message)
+{
+  for (;;) {
+    uint_least64_t position = rcutils_atomic_load_uint64_t(&ring->tail);
+    rcl_intra_process_ring_cell_t * cell = &ring->cells[position % ring->capacity];
+    uint64_t sequence = rcutils_atomic_load_uint64_t(&cell->sequence);
+    int64_t difference = (int64_t)(sequence - position);
+    if (0 == difference) {
+      bool claimed = false;
+      rcutils_atomic_compare_exchange_strong(&ring->tail, claimed, &position, position + 1u);
+      if (claimed) {
+        cell->message = message;
+        rcutils_atomic_store(&cell->sequence, position + 1u);
+        return;
+      }
+    } else if (difference < 0) {
+      // The ring is full, so drop the oldest message as a keep last history would.
+      rcl_shared_message_release(rcl_intra_process_ring_pop(ring));
+    }
+    // Otherwise another producer claimed the cell first, try the next one.
+  }
+}
+
+// Make room for one more element in an array if it is full, doubling its capacity.
+static void *
+_rcl_intra_process_grow(
+  void * array,
+  size_t size,
+  size_t * capacity,
+  size_t element_size,
+  rcl_allocator_t * allocator)
+{
+  if (size < *capacity) {
+    return array;
+  }
+  size_t grown_capacity = *capacity ? 2u * *capacity : 4u;
+  void * grown = allocator->reallocate(array, grown_capacity * element_size, allocator->state);
+  if (NULL == grown) {
+    RCL_SET_ERROR_MSG("allocating memory failed");
+    return NULL;
+  }
+  *capacity = grown_capacity;
+  return grown;
+}
+
+// Whether a publisher delivers to a subscription, as the middleware would match them.
+static bool
+_rcl_intra_process_matches(
+  const struct rcl_publisher_impl_s * publisher,
+  const struct rcl_subscription_impl_s * subscription)
+{
+  if (
+    0 != memcmp(&publisher->type_hash, &subscription->type_hash, sizeof(rosidl_type_hash_t)) ||
+    0 != strcmp(publisher->rmw_handle->topic_name, subscription->rmw_handle->topic_name))
+  {
+    return false;
+  }
+  rmw_qos_compatibility_type_t compatibility = RMW_QOS_COMPATIBILITY_OK;
+  rmw_ret_t ret = rmw_qos_profile_check_compatible(
+    publisher->actual_qos, subscription->actual_qos, &compatibility, NULL, 0u);
+  if (RMW_RET_OK != ret) {
+    // The profiles are the actual ones, so this does not happen, but do not lose messages.
+    rmw_reset_error();
+    return true;
+  }
+  return RMW_QOS_COMPATIBILITY_ERROR != compatibility;
+}
+
+static bool
+_rcl_intra_process_gids_equal(const rmw_gid_t * a, const rmw_gid_t * b)
+{
+  // Both gids come from the middleware of the context, so only their data differ.
+  return 0 == memcmp(a->data, b->data, sizeof(a->data));
+}
+
+static bool
+_rcl_intra_process_gids_contain(const rcl_intra_process_gids_t * gids, const rmw_gid_t * gid)
+{
+  if (NULL == gids) {
+    return false;
+  }
+  for (size_t i = 0u; i < gids->size; ++i) {
+    if (_rcl_intra_process_gids_equal(&gids->gids[i], gid)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void
+_rcl_intra_process_snapshot_init(rcl_intra_process_snapshot_t * snapshot)
+{
+  atomic_init(&snapshot->current, (uintptr_t)0);
+  atomic_init(&snapshot->epoch, 0u);
+  atomic_init(&snapshot->readers[0], 0u);
+  atomic_init(&snapshot->readers[1], 0u);
+}
+
+// Start reading the object of a snapshot, which stays valid until the read ends.
+static const void *
+_rcl_intra_process_snapshot_begin_read(
+  rcl_intra_process_snapshot_t * snapshot,
+  atomic_uint_least64_t ** readers)
+{
+  uint_least64_t epoch = rcutils_atomic_load_uint64_t(&snapshot->epoch);
+  atomic_uint_least64_t * epoch_readers = &snapshot->readers[epoch % 2u];
+  uint_least64_t previous = 0u;
+  rcutils_atomic_fetch_add(epoch_readers, previous, 1u);
+  RCUTILS_UNUSED(previous);
+  *readers = epoch_readers;
+  return (const void *)rcutils_atomic_load_uintptr_t(&snapshot->current);
+}
+
+static void
+_rcl_intra_process_snapshot_end_read(atomic_uint_least64_t * readers)
+{
+  uint_least64_t previous = 0u;
+  rcutils_atomic_fetch_sub(readers, previous, 1u);
+  RCUTILS_UNUSED(previous);
+}
+
+// Replace the object of a snapshot, with the registry locked, then deallocate
+// the previous one once no read uses it anymore.
+static void
+_rcl_intra_process_snapshot_replace(
+  rcl_intra_process_registry_t * registry,
+  rcl_intra_process_snapshot_t * snapshot,
+  void * object)
+{
+  void * previous =
+    (void *)rcutils_atomic_exchange_uintptr_t(&snapshot->current, (uintptr_t)object);
+  if (NULL == previous) {
+    return;
+  }
+  // A read may load the epoch before it is incremented and the object after,
+  // so wait for the reads of either epoch in turn.
+  // Reads starting meanwhile count in the other epoch, and cannot delay this.
+  for (int i = 0; i < 2; ++i) {
+    uint_least64_t epoch = 0u;
+    rcutils_atomic_fetch_add(&snapshot->epoch, epoch, 1u);
+    unsigned int spins = 0u;
+    while (0u != rcutils_atomic_load_uint64_t(&snapshot->readers[epoch % 2u])) {
+      rcl_spin_lock_backoff(&spins);
+    }
+  }
+  registry->allocator.deallocate(previous, registry->allocator.state);
+}
+
+// Add the gid of a publisher delivering to a subscription to its gids, or remove
+// it, with the registry locked.
+static rcl_ret_t
+_rcl_intra_process_subscription_update_gids(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_subscription_impl_s * subscription,
+  const rmw_gid_t * gid,
+  bool add)
+{
+  const rcl_intra_process_gids_t * gids = (const rcl_intra_process_gids_t *)
+    rcutils_atomic_load_uintptr_t(&subscription->intra_process_publisher_gids.current);
+  if (add == _rcl_intra_process_gids_contain(gids, gid)) {
+    return RCL_RET_OK;
+  }
+  size_t size = NULL != gids ? gids->size : 0u;
+  size = add ? size + 1u : size - 1u;
+  rcl_intra_process_gids_t * updated = NULL;
+  if (0u != size) {
+    updated = (rcl_intra_process_gids_t *)registry->allocator.allocate(
+      sizeof(rcl_intra_process_gids_t) + size * sizeof(rmw_gid_t), registry->allocator.state);
+    RCL_CHECK_FOR_NULL_WITH_MSG(updated, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+    updated->size = 0u;
+    updated->gids = (rmw_gid_t *)(updated + 1);
+    for (size_t i = 0u; NULL != gids && i < gids->size; ++i) {
+      if (!_rcl_intra_process_gids_equal(&gids->gids[i], gid)) {
+        updated->gids[updated->size++] = gids->gids[i];
+      }
+    }
+    if (add) {
+      updated->gids[updated->size++] = *gid;
+    }
+  }
+  _rcl_intra_process_snapshot_replace(
+    registry, &subscription->intra_process_publisher_gids, updated);
+  return RCL_RET_OK;
+}
+
+// Replace the matches of a publisher, with the registry locked.
+static void
+_rcl_intra_process_publisher_set_matches(
+  rcl_intra_process_registry_t * registry,
+  rcl_intra_process_publisher_t * publisher,
+  rcl_intra_process_matches_t * matches)
+{
+  _rcl_intra_process_snapshot_replace(registry, &publisher->matches, matches);
+  // The middleware matches the same subscriptions, so its count is queried again.
+  rcutils_atomic_store(&publisher->matched_count_expiry, 0);
+}
+
+// Resolve the matches of a publisher again, with the registry locked.
+// If memory cannot be allocated nothing is matched, and the publisher is
+// marked stale until the next delivery tries again.
+static void
+_rcl_intra_process_publisher_rematch(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_publisher_impl_s * publisher)
+{
+  rcl_intra_process_matches_t * matches = NULL;
+  size_t size = 0u;
+  for (size_t i = 0u; i < registry->subscriptions_size; ++i) {
+    if (_rcl_intra_process_matches(publisher, registry->subscriptions[i])) {
+      ++size;
+    }
+  }
+  if (0u != size) {
+    matches = (rcl_intra_process_matches_t *)registry->allocator.allocate(
+      sizeof(rcl_intra_process_matches_t) + size * sizeof(struct rcl_subscription_impl_s *),
+      registry->allocator.state);
+    if (NULL == matches) {
+      goto fail;
+    }
+    matches->size = 0u;
+    matches->subscriptions = (struct rcl_subscription_impl_s **)(matches + 1);
+    for (size_t i = 0u; i < registry->subscriptions_size; ++i) {
+      struct rcl_subscription_impl_s * subscription = registry->subscriptions[i];
+      if (!_rcl_intra_process_matches(publisher, subscription)) {
+        continue;
+      }
+      if (
+        RCL_RET_OK != _rcl_intra_process_subscription_update_gids(
+          registry, subscription, &publisher->intra_process.gid, true))
+      {
+        registry->allocator.deallocate(matches, registry->allocator.state);
+        goto fail;
+      }
+      matches->subscriptions[matches->size++] = subscription;
+    }
+  }
+  _rcl_intra_process_publisher_set_matches(registry, &publisher->intra_process, matches);
+  rcutils_atomic_store(&publisher->intra_process.stale, false);
+  return;
+fail:
+  rcl_reset_error();  // reported by the next delivery
+  _rcl_intra_process_publisher_set_matches(registry, &publisher->intra_process, NULL);
+  rcutils_atomic_store(&publisher->intra_process.stale, true);
+}
+
+static bool
+_rcl_intra_process_matches_contain(
+  const rcl_intra_process_matches_t * matches,
+  const struct rcl_subscription_impl_s * subscription)
+{
+  if (NULL == matches) {
+    return false;
+  }
+  for (size_t i = 0u; i < matches->size; ++i) {
+    if (matches->subscriptions[i] == subscription) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+rcl_intra_process_registry_init(
+  rcl_intra_process_registry_t * registry,
+  const rcl_allocator_t * allocator)
+{
+  rcl_spin_lock_init(&registry->lock);
+  registry->publishers = NULL;
+  registry->publishers_size = 0u;
+  registry->publishers_capacity = 0u;
+  registry->subscriptions = NULL;
+  registry->subscriptions_size = 0u;
+  registry->subscriptions_capacity = 0u;
+  registry->allocator = *allocator;
+}
+
+rcl_ret_t
+rcl_intra_process_registry_add_publisher(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_publisher_impl_s * publisher)
+{
+  rcl_intra_process_publisher_t * intra_process = &publisher->intra_process;
+  _rcl_intra_process_snapshot_init(&intra_process->matches);
+  atomic_init(&intra_process->stale, false);
+  atomic_init(&intra_process->matched_count, 0u);
+  atomic_init(&intra_process->matched_count_expiry, 0);
+
+  rcl_spin_lock_acquire(&registry->lock);
+  struct rcl_publisher_impl_s ** publishers =
+    (struct rcl_publisher_impl_s **)_rcl_intra_process_grow(
+    registry->publishers, registry->publishers_size, &registry->publishers_capacity,
+    sizeof(struct rcl_publisher_impl_s *), &registry->allocator);
+  if (NULL == publishers) {
+    rcl_spin_lock_release(&registry->lock);
+    return RCL_RET_BAD_ALLOC;  // error already set
+  }
+  registry->publishers = publishers;
+  registry->publishers[registry->publishers_size++] = publisher;
+  intra_process->registry = registry;
+  _rcl_intra_process_publisher_rematch(registry, publisher);
+  rcl_spin_lock_release(&registry->lock);
+  return RCL_RET_OK;
+}
+
+void
+rcl_intra_process_registry_remove_publisher(struct rcl_publisher_impl_s * publisher)
+{
+  rcl_intra_process_registry_t * registry = publisher->intra_process.registry;
+  if (NULL == registry) {
+    return;
+  }
+  rcl_spin_lock_acquire(&registry->lock);
+  for (size_t i = 0u; i < registry->publishers_size; ++i) {
+    if (registry->publishers[i] == publisher) {
+      registry->publishers[i] = registry->publishers[--registry->publishers_size];
+      break;
+    }
+  }
+  _rcl_intra_process_publisher_set_matches(registry, &publisher->intra_process, NULL);
+  // Copies of its messages still queued in the middleware are then taken as well,
+  // but the gids of the subscriptions no longer grow with every publisher created.
+  for (size_t i = 0u; i < registry->subscriptions_size; ++i) {
+    if (
+      RCL_RET_OK != _rcl_intra_process_subscription_update_gids(
+        registry, registry->subscriptions[i], &publisher->intra_process.gid, false))
+    {
+      rcl_reset_error();  // a gid left behind only costs a comparison per take
+    }
+  }
+  rcl_spin_lock_release(&registry->lock);
+  publisher->intra_process.registry = NULL;
+}
+
+rcl_ret_t
+rcl_intra_process_registry_add_subscription(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_subscription_impl_s * subscription)
+{
+  _rcl_intra_process_snapshot_init(&subscription->intra_process_publisher_gids);
+
+  rcl_spin_lock_acquire(&registry->lock);
+  struct rcl_subscription_impl_s ** subscriptions =
+    (struct rcl_subscription_impl_s **)_rcl_intra_process_grow(
+    registry->subscriptions, registry->subscriptions_size, &registry->subscriptions_capacity,
+    sizeof(struct rcl_subscription_impl_s *), &registry->allocator);
+  if (NULL == subscriptions) {
+    rcl_spin_lock_release(&registry->lock);
+    return RCL_RET_BAD_ALLOC;  // error already set
+  }
+  registry->subscriptions = subscriptions;
+  registry->subscriptions[registry->subscriptions_size++] = subscription;
+  for (size_t i = 0u; i < registry->publishers_size; ++i) {
+    if (_rcl_intra_process_matches(registry->publishers[i], subscription)) {
+      _rcl_intra_process_publisher_rematch(registry, registry->publishers[i]);
+    }
+  }
+  rcl_spin_lock_release(&registry->lock);
+  return RCL_RET_OK;
+}
+
+void
+rcl_intra_process_registry_remove_subscription(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_subscription_impl_s * subscription)
+{
+  rcl_spin_lock_acquire(&registry->lock);
+  for (size_t i = 0u; i < registry->subscriptions_size; ++i) {
+    if (registry->subscriptions[i] == subscription) {
+      registry->subscriptions[i] = registry->subscriptions[--registry->subscriptions_size];
+      break;
+    }
+  }
+  // Rematching waits for the deliveries which may still use the subscription.
+  for (size_t i = 0u; i < registry->publishers_size; ++i) {
+    struct rcl_publisher_impl_s * publisher = registry->publishers[i];
+    const rcl_intra_process_matches_t * matches = (const rcl_intra_process_matches_t *)
+      rcutils_atomic_load_uintptr_t(&publisher->intra_process.matches.current);
+    if (_rcl_intra_process_matches_contain(matches, subscription)) {
+      _rcl_intra_process_publisher_rematch(registry, publisher);
+    }
+  }
+  _rcl_intra_process_snapshot_replace(
+    registry, &subscription->intra_process_publisher_gids, NULL);
+  rcl_spin_lock_release(&registry->lock);
+}
+
+void
+rcl_intra_process_registry_fini(
+  rcl_intra_process_registry_t * registry,
+  rcl_allocator_t * allocator)
+{
+  allocator->deallocate(registry->publishers, allocator->state);
+  registry->publishers = NULL;
+  registry->publishers_size = 0u;
+  registry->publishers_capacity = 0u;
+  allocator->deallocate(registry->subscriptions, allocator->state);
+  registry->subscriptions = NULL;
+  registry->subscriptions_size = 0u;
+  registry->subscriptions_capacity = 0u;
+}
+
+bool
+rcl_intra_process_was_delivered(
+  struct rcl_subscription_impl_s * subscription,
+  const rmw_message_info_t * message_info)
+{
+  rcl_intra_process_snapshot_t * snapshot = &subscription->intra_process_publisher_gids;
+  if (
+    NULL == subscription->intra_process_context ||
+    0u == rcutils_atomic_load_uintptr_t(&snapshot->current))
+  {
+    return false;
+  }
+  atomic_uint_least64_t * readers = NULL;
+  const rcl_intra_process_gids_t * gids = (const rcl_intra_process_gids_t *)
+    _rcl_intra_process_snapshot_begin_read(snapshot, &readers);
+  bool delivered = _rcl_intra_process_gids_contain(gids, &message_info->publisher_gid);
+  _rcl_intra_process_snapshot_end_read(readers);
+  return delivered;
+}
+
+rcl_ret_t
+rcl_intra_process_deliver(
+  struct rcl_publisher_impl_s * publisher,
+  rcl_shared_message_t * message,
+  size_t * delivered_count)
+{
+  rcl_intra_process_publisher_t * intra_process = &publisher->intra_process;
+  *delivered_count = 0u;
+  if (rcutils_atomic_load_bool(&intra_process->stale)) {
+    rcl_intra_process_registry_t * registry = intra_process->registry;
+    rcl_spin_lock_acquire(&registry->lock);
+    if (rcutils_atomic_load_bool(&intra_process->stale)) {
+      _rcl_intra_process_publisher_rematch(registry, publisher);
+    }
+    rcl_spin_lock_release(&registry->lock);
+    if (rcutils_atomic_load_bool(&intra_process->stale)) {
+      RCL_SET_ERROR_MSG("allocating memory failed");
+      return RCL_RET_BAD_ALLOC;
+    }
+  }
+
+  atomic_uint_least64_t * readers = NULL;
+  const rcl_intra_process_matches_t * matches = (const rcl_intra_process_matches_t *)
+    _rcl_intra_process_snapshot_begin_read(&intra_process->matches, &readers);
+  rcl_ret_t ret = RCL_RET_OK;
+  size_t size = matches ? matches->size : 0u;
+  for (size_t i = 0u; i < size; ++i) {
+    struct rcl_subscription_impl_s * subscription = matches->subscriptions[i];
+    _rcl_shared_message_retain(message);
+    _rcl_intra_process_ring_push(&subscription->intra_process_ring, message);
+    if (RCL_RET_OK != rcl_trigger_guard_condition(&subscription->intra_process_guard_condition)) {
+      ret = RCL_RET_ERROR;  // error already set
+    }
+  }
+  _rcl_intra_process_snapshot_end_read(readers);
+  *delivered_count = size;
+  return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
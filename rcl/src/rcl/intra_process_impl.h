@@ -0,0 +1,234 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__INTRA_PROCESS_IMPL_H_
+#define RCL__INTRA_PROCESS_IMPL_H_
+
+#include <stddef.h>
+
+#include "rcl/allocator.h"
+#include "rcl/intra_process.h"
+#include "rcl/types.h"
+#include "rcutils/stdatomic_helper.h"
+#include "rmw/types.h"
+
+#include "./spin_lock_impl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct rcl_subscription_impl_s;
+struct rcl_publisher_impl_s;
+
+typedef struct rcl_intra_process_ring_cell_s
+{
+  atomic_uint_least64_t sequence;
+  rcl_shared_message_t * message;
+} rcl_intra_process_ring_cell_t;
+
+/// Bounded lock-free queue of shared messages, with a keep last policy.
+/**
+ * Any thread may push or pop, using the sequence numbers of the cells to
+ * claim them as in a bounded multi-producer multi-consumer queue.
+ * A push into a full ring pops and releases the oldest message first.
+ */
+typedef struct rcl_intra_process_ring_s
+{
+  rcl_intra_process_ring_cell_t * cells;
+  size_t capacity;
+  atomic_uint_least64_t head;
+  atomic_uint_least64_t tail;
+} rcl_intra_process_ring_t;
+
+/// Immutable object read without locking, and replaced as a whole with the registry locked.
+/**
+ * Readers count themselves in the readers of the current epoch while they use
+ * the object, and the registry waits for them before deallocating a replaced one.
+ */
+typedef struct rcl_intra_process_snapshot_s
+{
+  /// The current object, or 0 if there is none.
+  atomic_uintptr_t current;
+  /// Epoch of the reads starting now, incremented to retire replaced objects.
+  atomic_uint_least64_t epoch;
+  /// Number of reads in progress, for even and odd epochs.
+  atomic_uint_least64_t readers[2];
+} rcl_intra_process_snapshot_t;
+
+/// Intra-process subscriptions matched by a publisher.
+/**
+ * Matches are never modified once published, they are replaced as a whole,
+ * see rcl_intra_process_snapshot_t.
+ */
+typedef struct rcl_intra_process_matches_s
+{
+  size_t size;
+  /// Allocated together with the matches, right after them.
+  struct rcl_subscription_impl_s ** subscriptions;
+} rcl_intra_process_matches_t;
+
+/// Gids of the publishers delivering to a subscription.
+/**
+ * Gids are never modified once published, they are replaced as a whole,
+ * see rcl_intra_process_snapshot_t.
+ */
+typedef struct rcl_intra_process_gids_s
+{
+  size_t size;
+  /// Allocated together with the gids, right after them.
+  rmw_gid_t * gids;
+} rcl_intra_process_gids_t;
+
+/// Intra-process state of a publisher, see rcl_publish_shared().
+typedef struct rcl_intra_process_publisher_s
+{
+  /// The `rcl_intra_process_matches_t` read by deliveries, none if nothing is matched.
+  rcl_intra_process_snapshot_t matches;
+  /// Set if the matches could not be resolved for lack of memory.
+  atomic_bool stale;
+  /// Number of subscriptions matched by the middleware, as last queried.
+  atomic_uint_least64_t matched_count;
+  /// Steady time from which `matched_count` must be queried again.
+  atomic_int_least64_t matched_count_expiry;
+  /// Gid of the publisher, recorded by the subscriptions it delivers to.
+  rmw_gid_t gid;
+  /// Registry the publisher was added to, or `NULL`.
+  struct rcl_intra_process_registry_s * registry;
+} rcl_intra_process_publisher_t;
+
+/// Intra-process publishers and subscriptions of a context.
+typedef struct rcl_intra_process_registry_s
+{
+  /// Held to add or remove publishers and subscriptions, never to deliver.
+  rcl_spin_lock_t lock;
+  struct rcl_publisher_impl_s ** publishers;
+  size_t publishers_size;
+  size_t publishers_capacity;
+  struct rcl_subscription_impl_s ** subscriptions;
+  size_t subscriptions_size;
+  size_t subscriptions_capacity;
+  /// Allocator of the context, used for the matches and the arrays above.
+  rcl_allocator_t allocator;
+} rcl_intra_process_registry_t;
+
+/// Allocate the cells of a ring able to hold `capacity` messages.
+RCL_LOCAL
+rcl_ret_t
+rcl_intra_process_ring_init(
+  rcl_intra_process_ring_t * ring,
+  size_t capacity,
+  rcl_allocator_t * allocator);
+
+/// Release the messages left in the ring, then deallocate its cells.
+RCL_LOCAL
+void
+rcl_intra_process_ring_fini(rcl_intra_process_ring_t * ring, rcl_allocator_t * allocator);
+
+/// Pop the oldest message of the ring, or return `NULL` if it is empty.
+RCL_LOCAL
+rcl_shared_message_t *
+rcl_intra_process_ring_pop(rcl_intra_process_ring_t * ring);
+
+/// Initialize an empty registry.
+RCL_LOCAL
+void
+rcl_intra_process_registry_init(
+  rcl_intra_process_registry_t * registry,
+  const rcl_allocator_t * allocator);
+
+/// Add an intra-process publisher to a registry, and match it to its subscriptions.
+/**
+ * The gid of the publisher must be set already.
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_intra_process_registry_add_publisher(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_publisher_impl_s * publisher);
+
+/// Remove an intra-process publisher from its registry, if it was added to one.
+RCL_LOCAL
+void
+rcl_intra_process_registry_remove_publisher(struct rcl_publisher_impl_s * publisher);
+
+/// Add an intra-process subscription to a registry, and match it to its publishers.
+RCL_LOCAL
+rcl_ret_t
+rcl_intra_process_registry_add_subscription(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_subscription_impl_s * subscription);
+
+/// Remove an intra-process subscription from a registry.
+/**
+ * Once this returns, no delivery uses the subscription anymore.
+ */
+RCL_LOCAL
+void
+rcl_intra_process_registry_remove_subscription(
+  rcl_intra_process_registry_t * registry,
+  struct rcl_subscription_impl_s * subscription);
+
+/// Deallocate a registry, whose publishers and subscriptions were removed.
+RCL_LOCAL
+void
+rcl_intra_process_registry_fini(
+  rcl_intra_process_registry_t * registry,
+  rcl_allocator_t * allocator);
+
+/// Whether a message taken from the middleware was also delivered by rcl.
+/**
+ * It was, if its publisher delivers shared messages to the subscription.
+ * The gids of those publishers are read without locking the registry.
+ *
+ * \param[in] subscription the subscription which took the message
+ * \param[in] message_info the info of the taken message
+ */
+RCL_LOCAL
+bool
+rcl_intra_process_was_delivered(
+  struct rcl_subscription_impl_s * subscription,
+  const rmw_message_info_t * message_info);
+
+/// Create a shared message holding a single reference.
+RCL_LOCAL
+rcl_shared_message_t *
+rcl_shared_message_create(
+  void * ros_message,
+  rcl_shared_message_deleter_t deleter,
+  void * deleter_state,
+  rcl_allocator_t * allocator);
+
+/// Deliver a shared message to the intra-process subscriptions matched by a publisher.
+/**
+ * The matches are read without locking, unless they must be resolved again
+ * after an allocation failure.
+ *
+ * \param[in] publisher the publisher of the message, added to a registry
+ * \param[in] message the message, whose reference is kept by the caller
+ * \param[out] delivered_count set to the number of matching subscriptions
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_intra_process_deliver(
+  struct rcl_publisher_impl_s * publisher,
+  rcl_shared_message_t * message,
+  size_t * delivered_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__INTRA_PROCESS_IMPL_H_
@@ -0,0 +1,162 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "./loaned_message_pool_impl.h"
+
+#include <stdint.h>
+
+#include "rcl/error_handling.h"
+#include "rosidl_typesupport_introspection_c/identifier.h"
+#include "rosidl_typesupport_introspection_c/message_introspection.h"
+
+// Alignment of the messages, enough for any member of a generated C message.
+#define RCL_LOANED_MESSAGE_ALIGNMENT sizeof(long double)
+
+rcl_ret_t
+rcl_loaned_message_pool_init(
+  rcl_loaned_message_pool_t * pool,
+  const rosidl_message_type_support_t * type_support,
+  size_t size,
+  rcl_allocator_t * allocator)
+{
+  rcl_spin_lock_init(&pool->lock);
+  if (0u == size) {
+    return RCL_RET_OK;
+  }
+  const rosidl_message_type_support_t * introspection = get_message_typesupport_handle(
+    type_support, rosidl_typesupport_introspection_c__identifier);
+  if (NULL == introspection) {
+    rcl_reset_error();
+    RCL_SET_ERROR_MSG("message type has no C introspection type support to pool messages");
+    return RCL_RET_UNSUPPORTED;
+  }
+  const rosidl_typesupport_introspection_c__MessageMembers * members =
+    (const rosidl_typesupport_introspection_c__MessageMembers *)introspection->data;
+
+  size_t stride = members->size_of_ + RCL_LOANED_MESSAGE_ALIGNMENT - 1u;
+  stride -= stride % RCL_LOANED_MESSAGE_ALIGNMENT;
+  if (0u == stride) {
+    stride = RCL_LOANED_MESSAGE_ALIGNMENT;
+  }
+  if (size > SIZE_MAX / stride) {
+    RCL_SET_ERROR_MSG("loaned message pool is too large");
+    return RCL_RET_BAD_ALLOC;
+  }
+  pool->messages = (char *)allocator->zero_allocate(size, stride, allocator->state);
+  pool->borrowed = (bool *)allocator->zero_allocate(size, sizeof(bool), allocator->state);
+  pool->free_indices = (size_t *)allocator->allocate(size * sizeof(size_t), allocator->state);
+  if (!pool->messages || !pool->borrowed || !pool->free_indices) {
+    RCL_SET_ERROR_MSG("allocating memory for the loaned message pool failed");
+    rcl_loaned_message_pool_fini(pool, allocator);
+    return RCL_RET_BAD_ALLOC;
+  }
+  for (size_t i = 0u; i < size; ++i) {
+    members->init_function(pool->messages + i * stride, ROSIDL_RUNTIME_C_MSG_INIT_ALL);
+    // Hand out the messages in order, which reads better in a debugger.
+    pool->free_indices[i] = size - 1u - i;
+  }
+  pool->stride = stride;
+  pool->fini_function = members->fini_function;
+  pool->size = size;
+  pool->free_count = size;
+  return RCL_RET_OK;
+}
+
+void
+rcl_loaned_message_pool_fini(rcl_loaned_message_pool_t * pool, rcl_allocator_t * allocator)
+{
+  if (pool->messages && pool->fini_function) {
+    for (size_t i = 0u; i < pool->size; ++i) {
+      pool->fini_function(pool->messages + i * pool->stride);
+    }
+  }
+  allocator->deallocate(pool->messages, allocator->state);
+  allocator->deallocate(pool->borrowed, allocator->state);
+  allocator->deallocate(pool->free_indices, allocator->state);
+  pool->messages = NULL;
+  pool->stride = 0u;
+  pool->fini_function = NULL;
+  pool->borrowed = NULL;
+  pool->free_indices = NULL;
+  pool->size = 0u;
+  pool->free_count = 0u;
+}
+
+bool
+rcl_loaned_message_pool_is_valid(const rcl_loaned_message_pool_t * pool)
+{
+  return pool->size > 0u;
+}
+
+bool
+rcl_loaned_message_pool_owns(const rcl_loaned_message_pool_t * pool, const void * ros_message)
+{
+  const char * message = (const char *)ros_message;
+  return
+    pool->size > 0u &&
+    message >= pool->messages &&
+    message < pool->messages + pool->size * pool->stride &&
+    0u == (size_t)(message - pool->messages) % pool->stride;
+}
+
+rcl_ret_t
+rcl_loaned_message_pool_borrow(rcl_loaned_message_pool_t * pool, void ** ros_message)
+{
+  rcl_ret_t ret = RCL_RET_OK;
+  rcl_spin_lock_acquire(&pool->lock);
+  if (0u == pool->free_count) {
+    ret = RCL_RET_BAD_ALLOC;
+  } else {
+    size_t index = pool->free_indices[--pool->free_count];
+    pool->borrowed[index] = true;
+    *ros_message = pool->messages + index * pool->stride;
+  }
+  rcl_spin_lock_release(&pool->lock);
+  if (RCL_RET_OK != ret) {
+    RCL_SET_ERROR_MSG("all the loaned messages of the pool are borrowed");
+  }
+  return ret;
+}
+
+rcl_ret_t
+rcl_loaned_message_pool_return(rcl_loaned_message_pool_t * pool, void * ros_message)
+{
+  if (!rcl_loaned_message_pool_owns(pool, ros_message)) {
+    RCL_SET_ERROR_MSG("loaned message does not belong to the pool");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  size_t index = (size_t)((char *)ros_message - pool->messages) / pool->stride;
+  rcl_ret_t ret = RCL_RET_OK;
+  rcl_spin_lock_acquire(&pool->lock);
+  if (!pool->borrowed[index]) {
+    ret = RCL_RET_INVALID_ARGUMENT;
+  } else {
+    pool->borrowed[index] = false;
+    pool->free_indices[pool->free_count++] = index;
+  }
+  rcl_spin_lock_release(&pool->lock);
+  if (RCL_RET_OK != ret) {
+    RCL_SET_ERROR_MSG("loaned message is not borrowed");
+  }
+  return ret;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,108 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__LOANED_MESSAGE_POOL_IMPL_H_
+#define RCL__LOANED_MESSAGE_POOL_IMPL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "rcl/allocator.h"
+#include "rcl/types.h"
+#include "rcl/visibility_control.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "./spin_lock_impl.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// Fixed set of ROS messages loaned by rcl when the middleware cannot loan.
+/**
+ * The messages are allocated and initialized once, from the introspection
+ * type support of the message type, and only finalized with the pool.
+ * A returned message keeps its content, so that its sequences and strings do
+ * not have to be allocated again the next time it is loaned.
+ * Borrowing and returning may happen on different threads, and are guarded by
+ * a spin lock since they are never held for more than a few instructions.
+ */
+typedef struct rcl_loaned_message_pool_s
+{
+  /// Messages of the pool, `stride` bytes apart.
+  char * messages;
+  size_t stride;
+  /// Finalization function of the message type.
+  void (* fini_function)(void *);
+  bool * borrowed;
+  /// Stack of the indices of the messages which are not borrowed.
+  size_t * free_indices;
+  size_t size;
+  size_t free_count;
+  rcl_spin_lock_t lock;
+} rcl_loaned_message_pool_t;
+
+/// Allocate and initialize `size` messages of the given type.
+/**
+ * \return #RCL_RET_OK if the pool was initialized, or
+ * \return #RCL_RET_UNSUPPORTED if the type support has no C introspection, or
+ * \return #RCL_RET_BAD_ALLOC if allocating memory failed.
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_loaned_message_pool_init(
+  rcl_loaned_message_pool_t * pool,
+  const rosidl_message_type_support_t * type_support,
+  size_t size,
+  rcl_allocator_t * allocator);
+
+/// Finalize the messages of the pool, borrowed or not, and deallocate them.
+RCL_LOCAL
+void
+rcl_loaned_message_pool_fini(rcl_loaned_message_pool_t * pool, rcl_allocator_t * allocator);
+
+/// Return whether the pool was initialized with at least one message.
+RCL_LOCAL
+bool
+rcl_loaned_message_pool_is_valid(const rcl_loaned_message_pool_t * pool);
+
+/// Return whether the message belongs to the pool.
+RCL_LOCAL
+bool
+rcl_loaned_message_pool_owns(const rcl_loaned_message_pool_t * pool, const void * ros_message);
+
+/// Borrow a message from the pool.
+/**
+ * \return #RCL_RET_OK if a message was borrowed, or
+ * \return #RCL_RET_BAD_ALLOC if all the messages of the pool are borrowed.
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_loaned_message_pool_borrow(rcl_loaned_message_pool_t * pool, void ** ros_message);
+
+/// Return a message borrowed from the pool.
+/**
+ * \return #RCL_RET_OK if the message was returned, or
+ * \return #RCL_RET_INVALID_ARGUMENT if the message is not borrowed from the pool.
+ */
+RCL_LOCAL
+rcl_ret_t
+rcl_loaned_message_pool_return(rcl_loaned_message_pool_t * pool, void * ros_message);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__LOANED_MESSAGE_POOL_IMPL_H_
@@ -28,14 +28,20 @@ extern "C"
 #include "rcl/node_type_cache.h"
 #include "rcutils/logging_macros.h"
 #include "rcutils/macros.h"
+#include "rcutils/time.h"
 #include "rcl/time.h"
 #include "rmw/time.h"
 #include "rmw/error_handling.h"
 #include "tracetools/tracetools.h"
 
 #include "./common.h"
+#include "./context_impl.h"
+#include "./intra_process_impl.h"
 #include "./publisher_impl.h"
 
+// How long rcl_publish_shared() reuses the number of subscriptions matched by the middleware.
+#define RCL_PUBLISHER_MATCHED_COUNT_PERIOD RCUTILS_MS_TO_NS(100)
+
 rcl_publisher_t
 rcl_get_zero_initialized_publisher()
 {
@@ -128,6 +134,11 @@ rcl_publisher_init(
     options->qos.avoid_ros_namespace_conventions;
   // options
   publisher->impl->options = *options;
+  // counters
+  RCL_COUNTER_INIT(&publisher->impl->counters.published_count);
+  RCL_COUNTER_INIT(&publisher->impl->counters.published_serialized_bytes);
+  RCL_COUNTER_INIT(&publisher->impl->counters.publish_error_count);
+  RCL_COUNTER_INIT(&publisher->impl->counters.loaned_message_count);
 
   if (RCL_RET_OK != rcl_node_type_cache_register_type(
       node, type_support->get_type_hash_func(type_support),
@@ -140,9 +151,38 @@ rcl_publisher_init(
   }
   publisher->impl->type_hash = *type_support->get_type_hash_func(type_support);
 
-  RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Publisher initialized");
+  if (!publisher->impl->rmw_handle->can_loan_messages || options->disable_loaned_message) {
+    ret = rcl_loaned_message_pool_init(
+      &publisher->impl->loaned_message_pool,
+      type_support,
+      options->loaned_message_pool_size,
+      allocator);
+    if (RCL_RET_OK != ret) {
+      fail_ret = ret;
+      goto fail;
+    }
+  }
+
   // context
   publisher->impl->context = node->context;
+
+  if (options->enable_intra_process) {
+    // Subscriptions record the gid, to drop the middleware copies of shared messages.
+    rmw_ret = rmw_get_gid_for_publisher(
+      publisher->impl->rmw_handle, &publisher->impl->intra_process.gid);
+    if (RMW_RET_OK != rmw_ret) {
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      goto fail;
+    }
+    ret = rcl_intra_process_registry_add_publisher(
+      &node->context->impl->intra_process_registry, publisher->impl);
+    if (RCL_RET_OK != ret) {
+      fail_ret = ret;
+      goto fail;
+    }
+  }
+
+  RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Publisher initialized");
   TRACETOOLS_TRACEPOINT(
     rcl_publisher_init,
     (const void *)publisher,
@@ -163,6 +203,7 @@ fail:
       }
     }
 
+    rcl_loaned_message_pool_fini(&publisher->impl->loaned_message_pool, allocator);
     allocator->deallocate(publisher->impl, allocator->state);
     publisher->impl = NULL;
   }
@@ -195,6 +236,8 @@ rcl_publisher_fini(rcl_publisher_t * publisher, rcl_node_t * node)
     if (!rmw_node) {
       return RCL_RET_INVALID_ARGUMENT;
     }
+    // Subscriptions match the publisher using its rmw handle, so remove it first.
+    rcl_intra_process_registry_remove_publisher(publisher->impl);
     rmw_ret_t ret =
       rmw_destroy_publisher(rmw_node, publisher->impl->rmw_handle);
     if (ret != RMW_RET_OK) {
@@ -208,6 +251,7 @@ rcl_publisher_fini(rcl_publisher_t * publisher, rcl_node_t * node)
       RCUTILS_SAFE_FWRITE_TO_STDERR(rcl_get_error_string().str);
       result = RCL_RET_ERROR;
     }
+    rcl_loaned_message_pool_fini(&publisher->impl->loaned_message_pool, &allocator);
     allocator.deallocate(publisher->impl, allocator.state);
     publisher->impl = NULL;
   }
@@ -249,8 +293,31 @@ rcl_borrow_loaned_message(
   if (!rcl_publisher_is_valid(publisher)) {
     return RCL_RET_PUBLISHER_INVALID;  // error already set
   }
-  return rcl_convert_rmw_ret_to_rcl_ret(
-    rmw_borrow_loaned_message(publisher->impl->rmw_handle, type_support, ros_message));
+  if (rcl_loaned_message_pool_is_valid(&publisher->impl->loaned_message_pool)) {
+    RCL_CHECK_ARGUMENT_FOR_NULL(type_support, RCL_RET_INVALID_ARGUMENT);
+    RCL_CHECK_ARGUMENT_FOR_NULL(ros_message, RCL_RET_INVALID_ARGUMENT);
+    // The pooled messages were initialized for the type of the publisher.
+    if (
+      0 != memcmp(
+        type_support->get_type_hash_func(type_support), &publisher->impl->type_hash,
+        sizeof(rosidl_type_hash_t)))
+    {
+      RCL_SET_ERROR_MSG("type support does not match the type of the publisher");
+      return RCL_RET_INVALID_ARGUMENT;
+    }
+    rcl_ret_t ret =
+      rcl_loaned_message_pool_borrow(&publisher->impl->loaned_message_pool, ros_message);
+    if (RCL_RET_OK == ret) {
+      RCL_COUNTER_ADD(&publisher->impl->counters.loaned_message_count, 1u);
+    }
+    return ret;
+  }
+  rmw_ret_t ret =
+    rmw_borrow_loaned_message(publisher->impl->rmw_handle, type_support, ros_message);
+  if (RMW_RET_OK == ret) {
+    RCL_COUNTER_ADD(&publisher->impl->counters.loaned_message_count, 1u);
+  }
+  return rcl_convert_rmw_ret_to_rcl_ret(ret);
 }
 
 rcl_ret_t
@@ -262,6 +329,9 @@ rcl_return_loaned_message_from_publisher(
     return RCL_RET_PUBLISHER_INVALID;  // error already set
   }
   RCL_CHECK_ARGUMENT_FOR_NULL(loaned_message, RCL_RET_INVALID_ARGUMENT);
+  if (rcl_loaned_message_pool_is_valid(&publisher->impl->loaned_message_pool)) {
+    return rcl_loaned_message_pool_return(&publisher->impl->loaned_message_pool, loaned_message);
+  }
   return rcl_convert_rmw_ret_to_rcl_ret(
     rmw_return_loaned_message_from_publisher(publisher->impl->rmw_handle, loaned_message));
 }
@@ -281,12 +351,68 @@ rcl_publish(
   RCL_CHECK_ARGUMENT_FOR_NULL(ros_message, RCL_RET_INVALID_ARGUMENT);
   TRACETOOLS_TRACEPOINT(rcl_publish, (const void *)publisher, (const void *)ros_message);
   if (rmw_publish(publisher->impl->rmw_handle, ros_message, allocation) != RMW_RET_OK) {
+    RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, 1u);
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     return RCL_RET_ERROR;
   }
+  RCL_COUNTER_ADD(&publisher->impl->counters.published_count, 1u);
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_publish_batch(
+  const rcl_publisher_t * publisher,
+  const void * const * ros_messages,
+  size_t count,
+  rcl_ret_t * results,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RCL_RET_PUBLISHER_INVALID);
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RCL_RET_ERROR);
+
+  if (!rcl_publisher_is_valid(publisher)) {
+    return RCL_RET_PUBLISHER_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(ros_messages, RCL_RET_INVALID_ARGUMENT);
+  rcl_ret_t batch_ret = RCL_RET_OK;
+  size_t published_count = 0u;
+  // Only the error of the first failing message is reported.
+  rcl_error_string_t first_error;
+  for (size_t i = 0u; i < count; ++i) {
+    rcl_ret_t ret = RCL_RET_OK;
+    if (!ros_messages[i]) {
+      RCL_SET_ERROR_MSG("ros message in batch is null");
+      ret = RCL_RET_INVALID_ARGUMENT;
+    } else {
+      TRACETOOLS_TRACEPOINT(rcl_publish, (const void *)publisher, ros_messages[i]);
+      if (rmw_publish(publisher->impl->rmw_handle, ros_messages[i], allocation) != RMW_RET_OK) {
+        ret = RCL_RET_ERROR;  // rmw error state is set
+      }
+    }
+    if (results) {
+      results[i] = ret;
+    }
+    if (RCL_RET_OK != ret) {
+      if (RCL_RET_OK == batch_ret) {
+        first_error = rcl_get_error_string();
+      }
+      rcl_reset_error();
+      batch_ret = RCL_RET_ERROR;
+    } else {
+      ++published_count;
+    }
+  }
+  // Count the whole batch at once, to keep one increment per counter.
+  RCL_COUNTER_ADD(&publisher->impl->counters.published_count, published_count);
+  if (published_count != count) {
+    RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, count - published_count);
+  }
+  if (RCL_RET_OK != batch_ret) {
+    RCL_SET_ERROR_MSG(first_error.str);
+  }
+  return batch_ret;
+}
+
 rcl_ret_t
 rcl_publish_serialized_message(
   const rcl_publisher_t * publisher,
@@ -300,15 +426,73 @@ rcl_publish_serialized_message(
   rmw_ret_t ret = rmw_publish_serialized_message(
     publisher->impl->rmw_handle, serialized_message, allocation);
   if (ret != RMW_RET_OK) {
+    RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, 1u);
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     if (ret == RMW_RET_BAD_ALLOC) {
       return RCL_RET_BAD_ALLOC;
     }
     return RCL_RET_ERROR;
   }
+  RCL_COUNTER_ADD(&publisher->impl->counters.published_count, 1u);
+  RCL_COUNTER_ADD(
+    &publisher->impl->counters.published_serialized_bytes, serialized_message->buffer_length);
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_publish_serialized_batch(
+  const rcl_publisher_t * publisher,
+  const rcl_serialized_message_t * serialized_messages,
+  size_t count,
+  rcl_ret_t * results,
+  rmw_publisher_allocation_t * allocation)
+{
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RCL_RET_PUBLISHER_INVALID);
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RCL_RET_BAD_ALLOC);
+  RCUTILS_CAN_RETURN_WITH_ERROR_OF(RCL_RET_ERROR);
+
+  if (!rcl_publisher_is_valid(publisher)) {
+    return RCL_RET_PUBLISHER_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(serialized_messages, RCL_RET_INVALID_ARGUMENT);
+  rcl_ret_t batch_ret = RCL_RET_OK;
+  size_t published_count = 0u;
+  size_t published_bytes = 0u;
+  // Only the error of the first failing message is reported.
+  rcl_error_string_t first_error;
+  for (size_t i = 0u; i < count; ++i) {
+    rcl_ret_t ret = RCL_RET_OK;
+    rmw_ret_t rmw_ret = rmw_publish_serialized_message(
+      publisher->impl->rmw_handle, &serialized_messages[i], allocation);
+    if (rmw_ret != RMW_RET_OK) {
+      ret = RMW_RET_BAD_ALLOC == rmw_ret ? RCL_RET_BAD_ALLOC : RCL_RET_ERROR;
+      if (RCL_RET_OK == batch_ret) {
+        first_error = rmw_get_error_string();
+      }
+      rmw_reset_error();
+    } else {
+      ++published_count;
+      published_bytes += serialized_messages[i].buffer_length;
+    }
+    if (results) {
+      results[i] = ret;
+    }
+    // Report an allocation failure over other failures, as it may be recoverable.
+    if (RCL_RET_BAD_ALLOC == ret || (RCL_RET_ERROR == ret && RCL_RET_OK == batch_ret)) {
+      batch_ret = ret;
+    }
+  }
+  RCL_COUNTER_ADD(&publisher->impl->counters.published_count, published_count);
+  RCL_COUNTER_ADD(&publisher->impl->counters.published_serialized_bytes, published_bytes);
+  if (published_count != count) {
+    RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, count - published_count);
+  }
+  if (RCL_RET_OK != batch_ret) {
+    RCL_SET_ERROR_MSG(first_error.str);
+  }
+  return batch_ret;
+}
+
 rcl_ret_t
 rcl_publish_loaned_message(
   const rcl_publisher_t * publisher,
@@ -320,14 +504,129 @@ rcl_publish_loaned_message(
   }
   RCL_CHECK_ARGUMENT_FOR_NULL(ros_message, RCL_RET_INVALID_ARGUMENT);
   TRACETOOLS_TRACEPOINT(rcl_publish, (const void *)publisher, (const void *)ros_message);
+  rcl_loaned_message_pool_t * pool = &publisher->impl->loaned_message_pool;
+  if (rcl_loaned_message_pool_is_valid(pool)) {
+    if (!rcl_loaned_message_pool_owns(pool, ros_message)) {
+      RCL_SET_ERROR_MSG("loaned message does not belong to the publisher pool");
+      return RCL_RET_INVALID_ARGUMENT;
+    }
+    // The middleware copies the message, which goes back to the pool even if publishing failed.
+    rmw_ret_t ret = rmw_publish(publisher->impl->rmw_handle, ros_message, allocation);
+    rcl_ret_t return_ret = rcl_loaned_message_pool_return(pool, ros_message);
+    if (ret != RMW_RET_OK) {
+      RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, 1u);
+      if (RCL_RET_OK != return_ret) {
+        rcl_reset_error();
+      }
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      return RCL_RET_ERROR;
+    }
+    RCL_COUNTER_ADD(&publisher->impl->counters.published_count, 1u);
+    return return_ret;  // error already set, if any
+  }
   rmw_ret_t ret = rmw_publish_loaned_message(publisher->impl->rmw_handle, ros_message, allocation);
   if (ret != RMW_RET_OK) {
+    RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, 1u);
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     return RCL_RET_ERROR;
   }
+  RCL_COUNTER_ADD(&publisher->impl->counters.published_count, 1u);
+  return RCL_RET_OK;
+}
+
+// Number of subscriptions matched by the middleware, queried again once the cached one
+// expired or the intra-process subscriptions of the publisher changed.
+static rcl_ret_t
+_rcl_publisher_get_cached_matched_count(rcl_publisher_impl_t * impl, size_t * matched_count)
+{
+  rcl_intra_process_publisher_t * intra_process = &impl->intra_process;
+  rcutils_time_point_value_t now = 0;
+  if (RCUTILS_RET_OK != rcutils_steady_time_now(&now)) {
+    RCL_SET_ERROR_MSG(rcutils_get_error_string().str);
+    return RCL_RET_ERROR;
+  }
+  int_least64_t expiry = rcutils_atomic_load_int64_t(&intra_process->matched_count_expiry);
+  if (now < expiry) {
+    *matched_count = (size_t)rcutils_atomic_load_uint64_t(&intra_process->matched_count);
+    return RCL_RET_OK;
+  }
+  rmw_ret_t rmw_ret = rmw_publisher_count_matched_subscriptions(impl->rmw_handle, matched_count);
+  if (RMW_RET_OK != rmw_ret) {
+    RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+    return rcl_convert_rmw_ret_to_rcl_ret(rmw_ret);
+  }
+  rcutils_atomic_store(&intra_process->matched_count, (uint64_t)*matched_count);
+  // Keep the expiry if the matches changed meanwhile, so the count is queried again.
+  bool updated = false;
+  rcutils_atomic_compare_exchange_strong(
+    &intra_process->matched_count_expiry, updated, &expiry,
+    now + RCL_PUBLISHER_MATCHED_COUNT_PERIOD);
+  RCUTILS_UNUSED(updated);
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_publish_shared(
+  const rcl_publisher_t * publisher,
+  void * ros_message,
+  rcl_shared_message_deleter_t deleter,
+  void * deleter_state)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(ros_message, RCL_RET_INVALID_ARGUMENT);
+  const bool is_valid = rcl_publisher_is_valid(publisher);
+  rcl_allocator_t allocator =
+    is_valid ? publisher->impl->options.allocator : rcl_get_default_allocator();
+  // Wrap the message first, so that it is deleted however publishing ends.
+  rcl_shared_message_t * shared_message = rcl_shared_message_create(
+    ros_message, deleter, deleter_state, &allocator);
+  if (!shared_message) {
+    if (deleter) {
+      deleter(ros_message, deleter_state);
+    }
+    return RCL_RET_BAD_ALLOC;  // error already set
+  }
+  rcl_ret_t ret = RCL_RET_OK;
+  if (!is_valid) {
+    ret = RCL_RET_PUBLISHER_INVALID;  // error already set
+    goto cleanup;
+  }
+  if (!publisher->impl->options.enable_intra_process) {
+    RCL_SET_ERROR_MSG("intra-process is not enabled for the publisher");
+    ret = RCL_RET_ERROR;
+    goto cleanup;
+  }
+  TRACETOOLS_TRACEPOINT(rcl_publish, (const void *)publisher, (const void *)ros_message);
+
+  size_t intra_process_count = 0u;
+  ret = rcl_intra_process_deliver(publisher->impl, shared_message, &intra_process_count);
+  if (RCL_RET_OK != ret) {
+    goto cleanup;
+  }
+  // The intra-process subscriptions are matched by the middleware as well, so
+  // it only needs the message if more subscriptions are matched.
+  size_t matched_count = 0u;
+  ret = _rcl_publisher_get_cached_matched_count(publisher->impl, &matched_count);
+  if (RCL_RET_OK != ret) {
+    goto cleanup;
+  }
+  if (matched_count > intra_process_count) {
+    if (rmw_publish(publisher->impl->rmw_handle, ros_message, NULL) != RMW_RET_OK) {
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      ret = RCL_RET_ERROR;
+    }
+  }
+cleanup:
+  if (is_valid) {
+    if (RCL_RET_OK == ret) {
+      RCL_COUNTER_ADD(&publisher->impl->counters.published_count, 1u);
+    } else {
+      RCL_COUNTER_ADD(&publisher->impl->counters.publish_error_count, 1u);
+    }
+  }
+  rcl_shared_message_release(shared_message);
+  return ret;
+}
+
 rcl_ret_t
 rcl_publisher_assert_liveliness(const rcl_publisher_t * publisher)
 {
@@ -474,6 +773,10 @@ rcl_publisher_can_loan_messages(const rcl_publisher_t * publisher)
     return false;  // error message already set
   }
 
+  if (rcl_loaned_message_pool_is_valid(&publisher->impl->loaned_message_pool)) {
+    return true;
+  }
+
   if (publisher->impl->options.disable_loaned_message) {
     return false;
   }
@@ -481,6 +784,29 @@ rcl_publisher_can_loan_messages(const rcl_publisher_t * publisher)
   return publisher->impl->rmw_handle->can_loan_messages;
 }
 
+rcl_ret_t
+rcl_publisher_get_statistics(
+  const rcl_publisher_t * publisher,
+  rcl_publisher_statistics_t * statistics)
+{
+  if (!rcl_publisher_is_valid(publisher)) {
+    return RCL_RET_PUBLISHER_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(statistics, RCL_RET_INVALID_ARGUMENT);
+#ifndef RCL_DISABLE_STATISTICS
+  rcl_publisher_counters_t * counters = &publisher->impl->counters;
+  statistics->published_count = RCL_COUNTER_LOAD(&counters->published_count);
+  statistics->published_serialized_bytes =
+    RCL_COUNTER_LOAD(&counters->published_serialized_bytes);
+  statistics->publish_error_count = RCL_COUNTER_LOAD(&counters->publish_error_count);
+  statistics->loaned_message_count = RCL_COUNTER_LOAD(&counters->loaned_message_count);
+  return RCL_RET_OK;
+#else
+  RCL_SET_ERROR_MSG("rcl was built without publisher statistics");
+  return RCL_RET_UNSUPPORTED;
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,21 @@
 
 #include "rcl/publisher.h"
 
+#include "./counters_impl.h"
+#include "./intra_process_impl.h"
+#include "./loaned_message_pool_impl.h"
+
+#ifndef RCL_DISABLE_STATISTICS
+/// Counters behind rcl_publisher_get_statistics().
+typedef struct rcl_publisher_counters_s
+{
+  rcl_counter_t published_count;
+  rcl_counter_t published_serialized_bytes;
+  rcl_counter_t publish_error_count;
+  rcl_counter_t loaned_message_count;
+} rcl_publisher_counters_t;
+#endif
+
 struct rcl_publisher_impl_s
 {
   rcl_publisher_options_t options;
@@ -26,6 +41,13 @@ struct rcl_publisher_impl_s
   rcl_context_t * context;
   rmw_publisher_t * rmw_handle;
   rosidl_type_hash_t type_hash;
+  /// Messages loaned by rcl, if the middleware cannot loan and a pool size was given.
+  rcl_loaned_message_pool_t loaned_message_pool;
+  /// Matched subscriptions of the same context, if intra-process is enabled.
+  rcl_intra_process_publisher_t intra_process;
+#ifndef RCL_DISABLE_STATISTICS
+  rcl_publisher_counters_t counters;
+#endif
 };
 
 #endif  // RCL__PUBLISHER_IMPL_H_
@@ -0,0 +1,87 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "./spin_lock_impl.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define RCL_SPIN_LOCK_PAUSE() _mm_pause()
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define RCL_SPIN_LOCK_PAUSE() __asm__ __volatile__ ("yield")
+#else
+#define RCL_SPIN_LOCK_PAUSE()
+#endif
+
+// Number of times a waiting thread checks the lock before yielding the processor.
+#define RCL_SPIN_LOCK_SPINS_BEFORE_YIELD 64u
+
+static void
+_rcl_spin_lock_yield(void)
+{
+#ifdef _WIN32
+  SwitchToThread();
+#else
+  sched_yield();
+#endif
+}
+
+void
+rcl_spin_lock_init(rcl_spin_lock_t * lock)
+{
+  atomic_init(&lock->locked, false);
+}
+
+void
+rcl_spin_lock_acquire(rcl_spin_lock_t * lock)
+{
+  unsigned int spins = 0u;
+  while (rcutils_atomic_exchange_bool(&lock->locked, true)) {
+    // Only read the lock until it looks released, which keeps its cache line shared.
+    do {
+      rcl_spin_lock_backoff(&spins);
+    } while (rcutils_atomic_load_bool(&lock->locked));
+  }
+}
+
+void
+rcl_spin_lock_release(rcl_spin_lock_t * lock)
+{
+  rcutils_atomic_store(&lock->locked, false);
+}
+
+void
+rcl_spin_lock_backoff(unsigned int * spins)
+{
+  if (*spins < RCL_SPIN_LOCK_SPINS_BEFORE_YIELD) {
+    ++*spins;
+    RCL_SPIN_LOCK_PAUSE();
+  } else {
+    _rcl_spin_lock_yield();
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__SPIN_LOCK_IMPL_H_
+#define RCL__SPIN_LOCK_IMPL_H_
+
+#include "rcl/visibility_control.h"
+#include "rcutils/stdatomic_helper.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// A lock for short critical sections which are rarely contended.
+/**
+ * A waiting thread spins for a little while, then yields the processor
+ * until the lock is released.
+ * It is not recursive.
+ */
+typedef struct rcl_spin_lock_s
+{
+  atomic_bool locked;
+} rcl_spin_lock_t;
+
+/// Initialize the lock as released.
+RCL_LOCAL
+void
+rcl_spin_lock_init(rcl_spin_lock_t * lock);
+
+/// Acquire the lock, waiting until it is released if it is held.
+RCL_LOCAL
+void
+rcl_spin_lock_acquire(rcl_spin_lock_t * lock);
+
+/// Release the lock, which must be held by the calling thread.
+RCL_LOCAL
+void
+rcl_spin_lock_release(rcl_spin_lock_t * lock);
+
+/// Back off while waiting for another thread, spinning for a little while then yielding.
+/**
+ * \param[inout] spins number of times the caller backed off so far, 0 at first
+ */
+RCL_LOCAL
+void
+rcl_spin_lock_backoff(unsigned int * spins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__SPIN_LOCK_IMPL_H_
@@ -30,15 +30,194 @@ extern "C"
 #include "rcutils/types/string_array.h"
 #include "rmw/error_handling.h"
 #include "rmw/dynamic_message_type_support.h"
+#include "rmw/serialized_message.h"
 #include "rmw/subscription_content_filter_options.h"
 #include "rmw/validate_full_topic_name.h"
 #include "rosidl_dynamic_typesupport/identifier.h"
 #include "tracetools/tracetools.h"
 
 #include "./common.h"
+#include "./context_impl.h"
 #include "./subscription_impl.h"
 
 
+static void
+_rcl_serialized_message_pool_fini(
+  rcl_serialized_message_pool_t * pool,
+  rcl_allocator_t * allocator)
+{
+  if (pool->messages) {
+    for (size_t i = 0u; i < pool->size; ++i) {
+      if (RMW_RET_OK != rmw_serialized_message_fini(&pool->messages[i])) {
+        RCUTILS_SAFE_FWRITE_TO_STDERR(rmw_get_error_string().str);
+        RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+        rmw_reset_error();
+      }
+    }
+  }
+  allocator->deallocate(pool->messages, allocator->state);
+  allocator->deallocate(pool->borrowed, allocator->state);
+  allocator->deallocate(pool->free_indices, allocator->state);
+  pool->messages = NULL;
+  pool->borrowed = NULL;
+  pool->free_indices = NULL;
+  pool->size = 0u;
+  pool->free_count = 0u;
+}
+
+static rcl_ret_t
+_rcl_serialized_message_pool_init(
+  rcl_serialized_message_pool_t * pool,
+  size_t size,
+  size_t capacity,
+  rcl_allocator_t * allocator)
+{
+  if (0u == size) {
+    return RCL_RET_OK;
+  }
+  pool->messages = (rcl_serialized_message_t *)allocator->zero_allocate(
+    size, sizeof(rcl_serialized_message_t), allocator->state);
+  pool->borrowed = (bool *)allocator->zero_allocate(size, sizeof(bool), allocator->state);
+  pool->free_indices = (size_t *)allocator->allocate(size * sizeof(size_t), allocator->state);
+  if (!pool->messages || !pool->borrowed || !pool->free_indices) {
+    RCL_SET_ERROR_MSG("allocating memory for the serialized message pool failed");
+    _rcl_serialized_message_pool_fini(pool, allocator);
+    return RCL_RET_BAD_ALLOC;
+  }
+  for (size_t i = 0u; i < size; ++i) {
+    pool->messages[i] = rmw_get_zero_initialized_serialized_message();
+    rmw_ret_t rmw_ret = rmw_serialized_message_init(&pool->messages[i], capacity, allocator);
+    if (RMW_RET_OK != rmw_ret) {
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      pool->size = i;
+      _rcl_serialized_message_pool_fini(pool, allocator);
+      return rcl_convert_rmw_ret_to_rcl_ret(rmw_ret);
+    }
+    // Hand out the messages in order, which reads better in a debugger.
+    pool->free_indices[i] = size - 1u - i;
+  }
+  pool->size = size;
+  pool->free_count = size;
+  return RCL_RET_OK;
+}
+
+static rcl_serialized_message_t *
+_rcl_serialized_message_pool_borrow(rcl_serialized_message_pool_t * pool)
+{
+  if (0u == pool->size) {
+    RCL_SET_ERROR_MSG("subscription has no serialized message pool");
+    return NULL;
+  }
+  if (0u == pool->free_count) {
+    RCL_SET_ERROR_MSG("all the serialized messages of the pool are borrowed");
+    return NULL;
+  }
+  size_t index = pool->free_indices[--pool->free_count];
+  pool->borrowed[index] = true;
+  return &pool->messages[index];
+}
+
+static rcl_ret_t
+_rcl_serialized_message_pool_return(
+  rcl_serialized_message_pool_t * pool,
+  rcl_serialized_message_t * serialized_message)
+{
+  if (
+    serialized_message < pool->messages ||
+    serialized_message >= pool->messages + pool->size)
+  {
+    RCL_SET_ERROR_MSG("serialized message does not belong to the subscription pool");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  size_t index = (size_t)(serialized_message - pool->messages);
+  if (!pool->borrowed[index]) {
+    RCL_SET_ERROR_MSG("serialized message is not borrowed");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  pool->borrowed[index] = false;
+  serialized_message->buffer_length = 0u;
+  pool->free_indices[pool->free_count++] = index;
+  return RCL_RET_OK;
+}
+
+static void
+_rcl_subscription_intra_process_fini(
+  rcl_subscription_impl_t * impl,
+  rcl_allocator_t * allocator)
+{
+  // Stop publishers from delivering before draining the ring.
+  if (impl->intra_process_context) {
+    rcl_intra_process_registry_remove_subscription(
+      &impl->intra_process_context->impl->intra_process_registry, impl);
+    impl->intra_process_context = NULL;
+  }
+  rcl_intra_process_ring_fini(&impl->intra_process_ring, allocator);
+  if (impl->intra_process_guard_condition.impl) {
+    if (RCL_RET_OK != rcl_guard_condition_fini(&impl->intra_process_guard_condition)) {
+      RCUTILS_SAFE_FWRITE_TO_STDERR(rcl_get_error_string().str);
+      RCUTILS_SAFE_FWRITE_TO_STDERR("\n");
+      rcl_reset_error();
+    }
+  }
+}
+
+// Compile content filter options into the filter evaluated by rcl.
+static rcl_ret_t
+_rcl_subscription_set_rcl_content_filter(
+  rcl_subscription_impl_t * impl,
+  const rmw_subscription_content_filter_options_t * content_filter_options)
+{
+  return rcl_content_filter_set(
+    &impl->content_filter,
+    impl->type_support,
+    content_filter_options->filter_expression,
+    content_filter_options->expression_parameters.size,
+    (const char * const *)content_filter_options->expression_parameters.data,
+    &impl->options.allocator);
+}
+
+// Whether a message taken from the middleware is handed out: it must match the
+// filter evaluated by rcl, if any, and must not have been delivered by reference.
+static bool
+_rcl_subscription_accept(
+  rcl_subscription_impl_t * impl,
+  const void * ros_message,
+  const rmw_message_info_t * message_info)
+{
+  return
+    !rcl_intra_process_was_delivered(impl, message_info) &&
+    rcl_content_filter_accept(&impl->content_filter, ros_message);
+}
+
+static rcl_ret_t
+_rcl_subscription_intra_process_init(
+  rcl_subscription_impl_t * impl,
+  rcl_context_t * context,
+  rcl_allocator_t * allocator)
+{
+  size_t depth = impl->options.qos.depth ? impl->options.qos.depth : impl->actual_qos.depth;
+  rcl_ret_t ret = rcl_intra_process_ring_init(&impl->intra_process_ring, depth, allocator);
+  if (RCL_RET_OK != ret) {
+    return ret;
+  }
+  impl->intra_process_guard_condition = rcl_get_zero_initialized_guard_condition();
+  rcl_guard_condition_options_t guard_condition_options =
+    rcl_guard_condition_get_default_options();
+  guard_condition_options.allocator = *allocator;
+  ret = rcl_guard_condition_init(
+    &impl->intra_process_guard_condition, context, guard_condition_options);
+  if (RCL_RET_OK != ret) {
+    return ret;
+  }
+  ret = rcl_intra_process_registry_add_subscription(
+    &context->impl->intra_process_registry, impl);
+  if (RCL_RET_OK != ret) {
+    return ret;
+  }
+  impl->intra_process_context = context;
+  return RCL_RET_OK;
+}
+
 rcl_subscription_t
 rcl_get_zero_initialized_subscription()
 {
@@ -124,6 +303,34 @@ rcl_subscription_init(
     options->qos.avoid_ros_namespace_conventions;
   // options
   subscription->impl->options = *options;
+  // counters
+  RCL_COUNTER_INIT(&subscription->impl->counters.taken_count);
+  RCL_COUNTER_INIT(&subscription->impl->counters.taken_serialized_bytes);
+  RCL_COUNTER_INIT(&subscription->impl->counters.take_failed_count);
+  RCL_COUNTER_INIT(&subscription->impl->counters.loaned_message_count);
+  RCL_COUNTER_INIT(&subscription->impl->counters.dropped_count);
+
+  ret = _rcl_serialized_message_pool_init(
+    &subscription->impl->serialized_message_pool,
+    options->serialized_message_pool_size,
+    options->serialized_message_capacity,
+    allocator);
+  if (RCL_RET_OK != ret) {
+    fail_ret = ret;
+    goto fail;
+  }
+
+  if (!subscription->impl->rmw_handle->can_loan_messages || options->disable_loaned_message) {
+    ret = rcl_loaned_message_pool_init(
+      &subscription->impl->loaned_message_pool,
+      type_support,
+      options->loaned_message_pool_size,
+      allocator);
+    if (RCL_RET_OK != ret) {
+      fail_ret = ret;
+      goto fail;
+    }
+  }
 
   if (RCL_RET_OK != rcl_node_type_cache_register_type(
       node, type_support->get_type_hash_func(type_support),
@@ -135,6 +342,33 @@ rcl_subscription_init(
     goto fail;
   }
   subscription->impl->type_hash = *type_support->get_type_hash_func(type_support);
+  subscription->impl->type_support = type_support;
+
+  // Filter messages in rcl if the middleware cannot, and the type can be introspected.
+  rcl_content_filter_init(&subscription->impl->content_filter);
+  if (
+    options->rmw_subscription_options.content_filter_options &&
+    !subscription->impl->rmw_handle->is_cft_enabled)
+  {
+    ret = _rcl_subscription_set_rcl_content_filter(
+      subscription->impl, options->rmw_subscription_options.content_filter_options);
+    if (RCL_RET_UNSUPPORTED == ret) {
+      RCUTILS_LOG_DEBUG_NAMED(
+        ROS_PACKAGE_NAME, "Content filter ignored: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    } else if (RCL_RET_OK != ret) {
+      fail_ret = ret;
+      goto fail;
+    }
+  }
+
+  if (options->enable_intra_process) {
+    ret = _rcl_subscription_intra_process_init(subscription->impl, node->context, allocator);
+    if (RCL_RET_OK != ret) {
+      fail_ret = ret;
+      goto fail;
+    }
+  }
 
   RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Subscription initialized");
   ret = RCL_RET_OK;
@@ -158,6 +392,11 @@ fail:
       }
     }
 
+    _rcl_subscription_intra_process_fini(subscription->impl, allocator);
+    _rcl_serialized_message_pool_fini(&subscription->impl->serialized_message_pool, allocator);
+    rcl_loaned_message_pool_fini(&subscription->impl->loaned_message_pool, allocator);
+    rcl_content_filter_fini(&subscription->impl->content_filter, allocator);
+
     ret = rcl_subscription_options_fini(&subscription->impl->options);
     if (RCL_RET_OK != ret) {
       RCUTILS_SAFE_FWRITE_TO_STDERR(rmw_get_error_string().str);
@@ -194,12 +433,17 @@ rcl_subscription_fini(rcl_subscription_t * subscription, rcl_node_t * node)
     if (!rmw_node) {
       return RCL_RET_INVALID_ARGUMENT;
     }
+    // Publishers match the subscription using its rmw handle, so remove it first.
+    _rcl_subscription_intra_process_fini(subscription->impl, &allocator);
     rmw_ret_t ret =
       rmw_destroy_subscription(rmw_node, subscription->impl->rmw_handle);
     if (ret != RMW_RET_OK) {
       RCL_SET_ERROR_MSG(rmw_get_error_string().str);
       result = RCL_RET_ERROR;
     }
+    _rcl_serialized_message_pool_fini(&subscription->impl->serialized_message_pool, &allocator);
+    rcl_loaned_message_pool_fini(&subscription->impl->loaned_message_pool, &allocator);
+    rcl_content_filter_fini(&subscription->impl->content_filter, &allocator);
     rcl_ret_t rcl_ret = rcl_subscription_options_fini(&subscription->impl->options);
     if (RCL_RET_OK != rcl_ret) {
       RCUTILS_SAFE_FWRITE_TO_STDERR(rcl_get_error_string().str);
@@ -475,7 +719,9 @@ rcl_subscription_is_cft_enabled(const rcl_subscription_t * subscription)
   if (!rcl_subscription_is_valid(subscription)) {
     return false;
   }
-  return subscription->impl->rmw_handle->is_cft_enabled;
+  return
+    subscription->impl->rmw_handle->is_cft_enabled ||
+    rcl_content_filter_is_enabled(&subscription->impl->content_filter);
 }
 
 rcl_ret_t
@@ -496,9 +742,20 @@ rcl_subscription_set_content_filter(
     subscription->impl->rmw_handle,
     &options->rmw_subscription_content_filter_options);
 
-  if (ret != RMW_RET_OK) {
+  if (RMW_RET_UNSUPPORTED == ret) {
+    // Filter the messages in rcl instead, once they are taken.
+    rmw_reset_error();
+    rcl_ret_t rcl_ret = _rcl_subscription_set_rcl_content_filter(
+      subscription->impl, &options->rmw_subscription_content_filter_options);
+    if (RCL_RET_OK != rcl_ret) {
+      return rcl_ret;  // error already set
+    }
+  } else if (ret != RMW_RET_OK) {
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     return rcl_convert_rmw_ret_to_rcl_ret(ret);
+  } else {
+    rcl_content_filter_fini(
+      &subscription->impl->content_filter, &subscription->impl->options.allocator);
   }
 
   // copy options into subscription_options
@@ -528,6 +785,14 @@ rcl_subscription_get_content_filter(
   rcl_allocator_t * allocator = &subscription->impl->options.allocator;
   RCL_CHECK_ALLOCATOR_WITH_MSG(allocator, "invalid allocator", return RCL_RET_INVALID_ARGUMENT);
 
+  if (rcl_content_filter_is_enabled(&subscription->impl->content_filter)) {
+    const rmw_subscription_content_filter_options_t * content_filter_options =
+      subscription->impl->options.rmw_subscription_options.content_filter_options;
+    return rcl_convert_rmw_ret_to_rcl_ret(
+      rmw_subscription_content_filter_options_copy(
+        content_filter_options, allocator, &options->rmw_subscription_content_filter_options));
+  }
+
   rmw_ret_t rmw_ret = rmw_subscription_get_content_filter(
     subscription->impl->rmw_handle,
     allocator,
@@ -536,6 +801,21 @@ rcl_subscription_get_content_filter(
   return rcl_convert_rmw_ret_to_rcl_ret(rmw_ret);
 }
 
+rcl_ret_t
+rcl_subscription_get_content_filter_statistics(
+  const rcl_subscription_t * subscription,
+  rcl_subscription_content_filter_statistics_t * statistics)
+{
+  if (!rcl_subscription_is_valid(subscription)) {
+    return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(statistics, RCL_RET_INVALID_ARGUMENT);
+  rcl_content_filter_t * filter = &subscription->impl->content_filter;
+  statistics->matched_count = rcutils_atomic_load_uint64_t(&filter->matched_count);
+  statistics->filtered_count = rcutils_atomic_load_uint64_t(&filter->filtered_count);
+  return RCL_RET_OK;
+}
+
 rcl_ret_t
 rcl_take(
   const rcl_subscription_t * subscription,
@@ -554,20 +834,34 @@ rcl_take(
   rmw_message_info_t dummy_message_info;
   rmw_message_info_t * message_info_local = message_info ? message_info : &dummy_message_info;
   *message_info_local = rmw_get_zero_initialized_message_info();
-  // Call rmw_take_with_info.
+  // Call rmw_take_with_info, until a message is accepted or too many were dropped.
   bool taken = false;
-  rmw_ret_t ret = rmw_take_with_info(
-    subscription->impl->rmw_handle, ros_message, &taken, message_info_local, allocation);
-  if (ret != RMW_RET_OK) {
-    RCL_SET_ERROR_MSG(rmw_get_error_string().str);
-    return rcl_convert_rmw_ret_to_rcl_ret(ret);
-  }
+  size_t dropped = 0u;
+  do {
+    rmw_ret_t ret = rmw_take_with_info(
+      subscription->impl->rmw_handle, ros_message, &taken, message_info_local, allocation);
+    if (ret != RMW_RET_OK) {
+      if (0u != dropped) {
+        RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+      }
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      return rcl_convert_rmw_ret_to_rcl_ret(ret);
+    }
+  } while (
+    taken && !_rcl_subscription_accept(subscription->impl, ros_message, message_info_local) &&
+    ++dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE);
+  taken = taken && dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE;
   RCUTILS_LOG_DEBUG_NAMED(
     ROS_PACKAGE_NAME, "Subscription take succeeded: %s", taken ? "true" : "false");
   TRACETOOLS_TRACEPOINT(rcl_take, (const void *)ros_message);
+  if (0u != dropped) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+  }
   if (!taken) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
     return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
   }
+  RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, 1u);
   return RCL_RET_OK;
 }
 
@@ -609,11 +903,40 @@ rcl_take_sequence(
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     return rcl_convert_rmw_ret_to_rcl_ret(ret);
   }
+  // Drop the messages which are not accepted, keeping the order.
+  if (
+    rcl_content_filter_is_enabled(&subscription->impl->content_filter) ||
+    subscription->impl->intra_process_context)
+  {
+    size_t matched = 0u;
+    for (size_t i = 0u; i < taken; ++i) {
+      if (
+        !_rcl_subscription_accept(
+          subscription->impl, message_sequence->data[i], &message_info_sequence->data[i]))
+      {
+        continue;
+      }
+      // Swap the messages, as the sequence holds messages allocated by the caller.
+      void * message = message_sequence->data[matched];
+      message_sequence->data[matched] = message_sequence->data[i];
+      message_sequence->data[i] = message;
+      message_info_sequence->data[matched] = message_info_sequence->data[i];
+      ++matched;
+    }
+    if (taken != matched) {
+      RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, taken - matched);
+    }
+    taken = matched;
+    message_sequence->size = matched;
+    message_info_sequence->size = matched;
+  }
   RCUTILS_LOG_DEBUG_NAMED(
     ROS_PACKAGE_NAME, "Subscription took %zu messages", taken);
   if (0u == taken) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
     return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
   }
+  RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, taken);
   return RCL_RET_OK;
 }
 
@@ -634,22 +957,216 @@ rcl_take_serialized_message(
   rmw_message_info_t dummy_message_info;
   rmw_message_info_t * message_info_local = message_info ? message_info : &dummy_message_info;
   *message_info_local = rmw_get_zero_initialized_message_info();
-  // Call rmw_take_with_info.
+  // Call rmw_take_with_info, until a message matches the filter evaluated by rcl, if any,
+  // and was not delivered by reference, or too many were dropped.
   bool taken = false;
-  rmw_ret_t ret = rmw_take_serialized_message_with_info(
-    subscription->impl->rmw_handle, serialized_message, &taken, message_info_local, allocation);
-  if (ret != RMW_RET_OK) {
-    RCL_SET_ERROR_MSG(rmw_get_error_string().str);
-    return rcl_convert_rmw_ret_to_rcl_ret(ret);
-  }
+  bool accepted = false;
+  size_t dropped = 0u;
+  do {
+    rmw_ret_t ret = rmw_take_serialized_message_with_info(
+      subscription->impl->rmw_handle, serialized_message, &taken, message_info_local, allocation);
+    if (ret != RMW_RET_OK) {
+      if (0u != dropped) {
+        RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+      }
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      return rcl_convert_rmw_ret_to_rcl_ret(ret);
+    }
+    accepted = false;
+    if (taken && !rcl_intra_process_was_delivered(subscription->impl, message_info_local)) {
+      rcl_ret_t rcl_ret = rcl_content_filter_accept_serialized(
+        &subscription->impl->content_filter, subscription->impl->type_support,
+        serialized_message, &accepted);
+      if (RCL_RET_OK != rcl_ret) {
+        if (0u != dropped) {
+          RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+        }
+        return rcl_ret;  // error already set
+      }
+    }
+  } while (taken && !accepted && ++dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE);
+  taken = taken && accepted;
   RCUTILS_LOG_DEBUG_NAMED(
     ROS_PACKAGE_NAME, "Subscription serialized take succeeded: %s", taken ? "true" : "false");
+  if (0u != dropped) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+  }
   if (!taken) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
     return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
   }
+  RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, 1u);
+  RCL_COUNTER_ADD(
+    &subscription->impl->counters.taken_serialized_bytes, serialized_message->buffer_length);
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_take_serialized_sequence(
+  const rcl_subscription_t * subscription,
+  size_t count,
+  rcl_serialized_message_t ** serialized_messages,
+  rmw_message_info_sequence_t * message_info_sequence,
+  rmw_subscription_allocation_t * allocation)
+{
+  RCUTILS_LOG_DEBUG_NAMED(
+    ROS_PACKAGE_NAME, "Subscription taking %zu serialized messages", count);
+  if (!rcl_subscription_is_valid(subscription)) {
+    return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(serialized_messages, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(message_info_sequence, RCL_RET_INVALID_ARGUMENT);
+
+  if (message_info_sequence->capacity < count) {
+    RCL_SET_ERROR_MSG("Insufficient message info sequence capacity for requested count");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+
+  // Set the size to zero to indicate that there are no valid messages
+  message_info_sequence->size = 0u;
+
+  rcl_serialized_message_pool_t * pool = &subscription->impl->serialized_message_pool;
+  if (0u == pool->size || 0u == pool->free_count) {
+    (void)_rcl_serialized_message_pool_borrow(pool);  // sets the error message
+    return RCL_RET_ERROR;
+  }
+  if (count > pool->free_count) {
+    count = pool->free_count;
+  }
+
+  size_t taken_count = 0u;
+  size_t taken_bytes = 0u;
+  size_t dropped = 0u;
+  rcl_ret_t ret = RCL_RET_OK;
+  while (taken_count < count && dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE) {
+    rcl_serialized_message_t * serialized_message = _rcl_serialized_message_pool_borrow(pool);
+    bool taken = false;
+    rmw_ret_t rmw_ret = rmw_take_serialized_message_with_info(
+      subscription->impl->rmw_handle, serialized_message, &taken,
+      &message_info_sequence->data[taken_count], allocation);
+    if (RMW_RET_OK != rmw_ret || !taken) {
+      if (RMW_RET_OK != rmw_ret) {
+        RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+        ret = rcl_convert_rmw_ret_to_rcl_ret(rmw_ret);
+      }
+      // The message was borrowed just above, so giving it back cannot fail.
+      (void)_rcl_serialized_message_pool_return(pool, serialized_message);
+      break;
+    }
+    bool accepted = false;
+    if (
+      !rcl_intra_process_was_delivered(
+        subscription->impl, &message_info_sequence->data[taken_count]))
+    {
+      ret = rcl_content_filter_accept_serialized(
+        &subscription->impl->content_filter, subscription->impl->type_support,
+        serialized_message, &accepted);
+    }
+    if (RCL_RET_OK != ret || !accepted) {
+      // Recycle the messages which are not accepted.
+      (void)_rcl_serialized_message_pool_return(pool, serialized_message);
+      if (RCL_RET_OK != ret) {
+        break;
+      }
+      ++dropped;
+      continue;
+    }
+    taken_bytes += serialized_message->buffer_length;
+    serialized_messages[taken_count++] = serialized_message;
+  }
+  message_info_sequence->size = taken_count;
+  RCUTILS_LOG_DEBUG_NAMED(
+    ROS_PACKAGE_NAME, "Subscription took %zu serialized messages", taken_count);
+  if (0u != dropped) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+  }
+  // Messages which were already taken are handed out even if a later take failed.
+  if (0u != taken_count) {
+    if (RCL_RET_OK != ret) {
+      // The caller gets RCL_RET_OK, so the error must not outlive this call.
+      RCUTILS_LOG_DEBUG_NAMED(
+        ROS_PACKAGE_NAME, "Subscription serialized take stopped early: %s",
+        rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+    RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, taken_count);
+    RCL_COUNTER_ADD(&subscription->impl->counters.taken_serialized_bytes, taken_bytes);
+    return RCL_RET_OK;
+  }
+  if (RCL_RET_OK != ret) {
+    return ret;
+  }
+  RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
+  return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+}
+
+rcl_ret_t
+rcl_subscription_borrow_serialized_message(
+  const rcl_subscription_t * subscription,
+  rcl_serialized_message_t ** serialized_message)
+{
+  if (!rcl_subscription_is_valid(subscription)) {
+    return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(serialized_message, RCL_RET_INVALID_ARGUMENT);
+  *serialized_message =
+    _rcl_serialized_message_pool_borrow(&subscription->impl->serialized_message_pool);
+  if (!*serialized_message) {
+    return RCL_RET_ERROR;  // error already set
+  }
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_subscription_return_serialized_message(
+  const rcl_subscription_t * subscription,
+  rcl_serialized_message_t * serialized_message)
+{
+  if (!rcl_subscription_is_valid(subscription)) {
+    return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(serialized_message, RCL_RET_INVALID_ARGUMENT);
+  return _rcl_serialized_message_pool_return(
+    &subscription->impl->serialized_message_pool, serialized_message);
+}
+
+rcl_ret_t
+rcl_take_shared(
+  const rcl_subscription_t * subscription,
+  rcl_shared_message_t ** shared_message)
+{
+  if (!rcl_subscription_is_valid(subscription)) {
+    return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(shared_message, RCL_RET_INVALID_ARGUMENT);
+  if (!subscription->impl->options.enable_intra_process) {
+    RCL_SET_ERROR_MSG("intra-process is not enabled for the subscription");
+    return RCL_RET_ERROR;
+  }
+  *shared_message = rcl_intra_process_ring_pop(&subscription->impl->intra_process_ring);
+  if (!*shared_message) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
+    return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+  }
+  TRACETOOLS_TRACEPOINT(
+    rcl_take, rcl_shared_message_get_ros_message(*shared_message));
+  RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, 1u);
+  return RCL_RET_OK;
+}
+
+const rcl_guard_condition_t *
+rcl_subscription_get_intra_process_guard_condition(const rcl_subscription_t * subscription)
+{
+  if (!rcl_subscription_is_valid(subscription)) {
+    return NULL;  // error already set
+  }
+  if (!subscription->impl->options.enable_intra_process) {
+    RCL_SET_ERROR_MSG("intra-process is not enabled for the subscription");
+    return NULL;
+  }
+  return &subscription->impl->intra_process_guard_condition;
+}
+
 rcl_ret_t
 rcl_take_dynamic_message(
   const rcl_subscription_t * subscription,
@@ -666,16 +1183,75 @@ rcl_take_dynamic_message(
   rmw_message_info_t dummy_message_info;
   rmw_message_info_t * message_info_local = message_info ? message_info : &dummy_message_info;
   *message_info_local = rmw_get_zero_initialized_message_info();
-  // Call take with info
+  // Call take with info, until a message was not delivered by reference,
+  // or too many were dropped.
+  bool taken = false;
+  size_t dropped = 0u;
+  do {
+    rmw_ret_t ret = rmw_take_dynamic_message_with_info(
+      subscription->impl->rmw_handle, dynamic_message, &taken, message_info_local, allocation);
+    if (ret != RMW_RET_OK) {
+      if (0u != dropped) {
+        RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+      }
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      return rcl_convert_rmw_ret_to_rcl_ret(ret);
+    }
+  } while (
+    taken && rcl_intra_process_was_delivered(subscription->impl, message_info_local) &&
+    ++dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE);
+  taken = taken && dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE;
+  RCUTILS_LOG_DEBUG_NAMED(
+    ROS_PACKAGE_NAME, "Subscription dynamic take succeeded: %s", taken ? "true" : "false");
+  if (0u != dropped) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+  }
+  if (!taken) {
+    RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
+    return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+  }
+  RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, 1u);
+  return RCL_RET_OK;
+}
+
+static rcl_ret_t
+_rcl_take_loaned_message(
+  const rcl_subscription_t * subscription,
+  void ** loaned_message,
+  rmw_message_info_t * message_info_local,
+  rmw_subscription_allocation_t * allocation)
+{
   bool taken = false;
-  rmw_ret_t ret = rmw_take_dynamic_message_with_info(
-    subscription->impl->rmw_handle, dynamic_message, &taken, message_info_local, allocation);
+  rcl_loaned_message_pool_t * pool = &subscription->impl->loaned_message_pool;
+  if (rcl_loaned_message_pool_is_valid(pool)) {
+    // Take a copy into a pooled message, as the middleware cannot loan one.
+    void * pooled_message = NULL;
+    rcl_ret_t rcl_ret = rcl_loaned_message_pool_borrow(pool, &pooled_message);
+    if (RCL_RET_OK != rcl_ret) {
+      return rcl_ret;  // error already set
+    }
+    rmw_ret_t ret = rmw_take_with_info(
+      subscription->impl->rmw_handle, pooled_message, &taken, message_info_local, allocation);
+    if (ret != RMW_RET_OK || !taken) {
+      (void)rcl_loaned_message_pool_return(pool, pooled_message);  // cannot fail
+      if (ret != RMW_RET_OK) {
+        RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+        return rcl_convert_rmw_ret_to_rcl_ret(ret);
+      }
+      return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+    }
+    *loaned_message = pooled_message;
+    return RCL_RET_OK;
+  }
+  // Call rmw_take_with_info.
+  rmw_ret_t ret = rmw_take_loaned_message_with_info(
+    subscription->impl->rmw_handle, loaned_message, &taken, message_info_local, allocation);
   if (ret != RMW_RET_OK) {
     RCL_SET_ERROR_MSG(rmw_get_error_string().str);
     return rcl_convert_rmw_ret_to_rcl_ret(ret);
   }
   RCUTILS_LOG_DEBUG_NAMED(
-    ROS_PACKAGE_NAME, "Subscription dynamic take succeeded: %s", taken ? "true" : "false");
+    ROS_PACKAGE_NAME, "Subscription loaned take succeeded: %s", taken ? "true" : "false");
   if (!taken) {
     return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
   }
@@ -702,20 +1278,32 @@ rcl_take_loaned_message(
   rmw_message_info_t dummy_message_info;
   rmw_message_info_t * message_info_local = message_info ? message_info : &dummy_message_info;
   *message_info_local = rmw_get_zero_initialized_message_info();
-  // Call rmw_take_with_info.
-  bool taken = false;
-  rmw_ret_t ret = rmw_take_loaned_message_with_info(
-    subscription->impl->rmw_handle, loaned_message, &taken, message_info_local, allocation);
-  if (ret != RMW_RET_OK) {
-    RCL_SET_ERROR_MSG(rmw_get_error_string().str);
-    return rcl_convert_rmw_ret_to_rcl_ret(ret);
-  }
-  RCUTILS_LOG_DEBUG_NAMED(
-    ROS_PACKAGE_NAME, "Subscription loaned take succeeded: %s", taken ? "true" : "false");
-  if (!taken) {
-    return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+  for (size_t dropped = 0u; ; ++dropped) {
+    if (RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE == dropped) {
+      RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
+      return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+    }
+    rcl_ret_t ret = _rcl_take_loaned_message(
+      subscription, loaned_message, message_info_local, allocation);
+    if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+      RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
+    }
+    if (RCL_RET_OK != ret) {
+      return ret;
+    }
+    if (_rcl_subscription_accept(subscription->impl, *loaned_message, message_info_local)) {
+      RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, 1u);
+      RCL_COUNTER_ADD(&subscription->impl->counters.loaned_message_count, 1u);
+      return RCL_RET_OK;
+    }
+    // Give back a message which is not accepted, and take the next one.
+    RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, 1u);
+    ret = rcl_return_loaned_message_from_subscription(subscription, *loaned_message);
+    *loaned_message = NULL;
+    if (RCL_RET_OK != ret) {
+      return ret;  // error already set
+    }
   }
-  return RCL_RET_OK;
 }
 
 rcl_ret_t
@@ -728,6 +1316,10 @@ rcl_return_loaned_message_from_subscription(
     return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
   }
   RCL_CHECK_ARGUMENT_FOR_NULL(loaned_message, RCL_RET_INVALID_ARGUMENT);
+  if (rcl_loaned_message_pool_is_valid(&subscription->impl->loaned_message_pool)) {
+    return rcl_loaned_message_pool_return(
+      &subscription->impl->loaned_message_pool, loaned_message);
+  }
   return rcl_convert_rmw_ret_to_rcl_ret(
     rmw_return_loaned_message_from_subscription(
       subscription->impl->rmw_handle, loaned_message));
@@ -809,6 +1401,10 @@ rcl_subscription_can_loan_messages(const rcl_subscription_t * subscription)
     return false;  // error message already set
   }
 
+  if (rcl_loaned_message_pool_is_valid(&subscription->impl->loaned_message_pool)) {
+    return true;
+  }
+
   if (subscription->impl->options.disable_loaned_message) {
     return false;
   }
@@ -816,6 +1412,29 @@ rcl_subscription_can_loan_messages(const rcl_subscription_t * subscription)
   return subscription->impl->rmw_handle->can_loan_messages;
 }
 
+rcl_ret_t
+rcl_subscription_get_statistics(
+  const rcl_subscription_t * subscription,
+  rcl_subscription_statistics_t * statistics)
+{
+  if (!rcl_subscription_is_valid(subscription)) {
+    return RCL_RET_SUBSCRIPTION_INVALID;  // error already set
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(statistics, RCL_RET_INVALID_ARGUMENT);
+#ifndef RCL_DISABLE_STATISTICS
+  rcl_subscription_counters_t * counters = &subscription->impl->counters;
+  statistics->taken_count = RCL_COUNTER_LOAD(&counters->taken_count);
+  statistics->taken_serialized_bytes = RCL_COUNTER_LOAD(&counters->taken_serialized_bytes);
+  statistics->take_failed_count = RCL_COUNTER_LOAD(&counters->take_failed_count);
+  statistics->loaned_message_count = RCL_COUNTER_LOAD(&counters->loaned_message_count);
+  statistics->dropped_count = RCL_COUNTER_LOAD(&counters->dropped_count);
+  return RCL_RET_OK;
+#else
+  RCL_SET_ERROR_MSG("rcl was built without subscription statistics");
+  return RCL_RET_UNSUPPORTED;
+#endif
+}
+
 rcl_ret_t
 rcl_subscription_set_on_new_message_callback(
   const rcl_subscription_t * subscription,
@@ -17,14 +17,63 @@
 
 #include "rmw/rmw.h"
 
+#include "rcl/guard_condition.h"
 #include "rcl/subscription.h"
 
+#include "./content_filter_impl.h"
+#include "./counters_impl.h"
+#include "./intra_process_impl.h"
+#include "./loaned_message_pool_impl.h"
+
+/// Pool of serialized messages which keep their buffers between takes.
+typedef struct rcl_serialized_message_pool_s
+{
+  /// Pooled messages, see rcl_subscription_options_t::serialized_message_pool_size.
+  rcl_serialized_message_t * messages;
+  /// Whether each pooled message is currently borrowed.
+  bool * borrowed;
+  /// Indices of the messages which are not borrowed, used as a stack.
+  size_t * free_indices;
+  size_t size;
+  size_t free_count;
+} rcl_serialized_message_pool_t;
+
+#ifndef RCL_DISABLE_STATISTICS
+/// Counters behind rcl_subscription_get_statistics().
+typedef struct rcl_subscription_counters_s
+{
+  rcl_counter_t taken_count;
+  rcl_counter_t taken_serialized_bytes;
+  rcl_counter_t take_failed_count;
+  rcl_counter_t loaned_message_count;
+  rcl_counter_t dropped_count;
+} rcl_subscription_counters_t;
+#endif
+
 struct rcl_subscription_impl_s
 {
   rcl_subscription_options_t options;
   rmw_qos_profile_t actual_qos;
   rmw_subscription_t * rmw_handle;
   rosidl_type_hash_t type_hash;
+  /// Type support the subscription was created with.
+  const rosidl_message_type_support_t * type_support;
+  /// Filter evaluated by rcl on taken messages, if the middleware cannot filter.
+  rcl_content_filter_t content_filter;
+  rcl_serialized_message_pool_t serialized_message_pool;
+  /// Messages loaned by rcl, if the middleware cannot loan and a pool size was given.
+  rcl_loaned_message_pool_t loaned_message_pool;
+  /// Shared messages delivered by publishers of the same context, if intra-process is enabled.
+  rcl_intra_process_ring_t intra_process_ring;
+  /// Triggered whenever a shared message is pushed into the ring.
+  rcl_guard_condition_t intra_process_guard_condition;
+  /// Context whose registry the subscription was added to, or `NULL`.
+  rcl_context_t * intra_process_context;
+  /// The `rcl_intra_process_gids_t` of the publishers delivering to the ring, if any.
+  rcl_intra_process_snapshot_t intra_process_publisher_gids;
+#ifndef RCL_DISABLE_STATISTICS
+  rcl_subscription_counters_t counters;
+#endif
 };
 
 #endif  // RCL__SUBSCRIPTION_IMPL_H_
@@ -18,19 +18,98 @@
 #include <stdlib.h>
 
 #include "./common.h"
+#include "./spin_lock_impl.h"
+#include "./timer_impl.h"
 #include "rcl/allocator.h"
 #include "rcl/error_handling.h"
 #include "rcutils/macros.h"
 #include "rcutils/stdatomic_helper.h"
 #include "rcutils/time.h"
 
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define RCL_TIME_HAS_TSC 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+struct rcl_ros_time_source_impl_s
+{
+  // Even while active and current_time are consistent, odd while they are written.
+  atomic_uint_least64_t sequence;
+  atomic_bool active;
+  atomic_uint_least64_t current_time;
+  // Held while the clocks are used, and by the single writer of the values above.
+  rcl_spin_lock_t lock;
+  // The clocks reading this source, whose jump callbacks are called on updates.
+  rcl_clock_t ** clocks;
+  size_t num_clocks;
+  size_t clocks_capacity;
+  rcl_allocator_t allocator;
+};
+
 // Internal storage for RCL_ROS_TIME implementation
 typedef struct rcl_ros_clock_storage_s
 {
   atomic_uint_least64_t current_time;
-  bool active;
+  atomic_bool active;
+  // The shared time source used instead of the values above, or NULL.
+  // It is set under the lock of the source, but read without it, so it is atomic.
+  atomic_uintptr_t source;
 } rcl_ros_clock_storage_t;
 
+// Load the shared time source of the clock storage once, or NULL.
+static rcl_ros_time_source_impl_t *
+rcl_ros_clock_storage_get_source(rcl_ros_clock_storage_t * storage)
+{
+  return (rcl_ros_time_source_impl_t *)rcutils_atomic_load_uintptr_t(&(storage->source));
+}
+
+// Read a consistent pair of values from the time source, retrying while it is written.
+static void
+rcl_ros_time_source_read(
+  rcl_ros_time_source_impl_t * source, bool * active, rcl_time_point_value_t * current_time)
+{
+  uint64_t sequence;
+  do {
+    sequence = rcutils_atomic_load_uint64_t(&(source->sequence));
+    *active = rcutils_atomic_load_bool(&(source->active));
+    *current_time = (rcl_time_point_value_t)rcutils_atomic_load_uint64_t(&(source->current_time));
+  } while ((sequence & 1u) != 0u ||
+  sequence != rcutils_atomic_load_uint64_t(&(source->sequence)));
+}
+
+// Update the time source, which has a single writer at a time, holding its lock.
+static void
+rcl_ros_time_source_write(
+  rcl_ros_time_source_impl_t * source, bool active, rcl_time_point_value_t current_time)
+{
+  uint64_t sequence = rcutils_atomic_load_uint64_t(&(source->sequence));
+  rcutils_atomic_store(&(source->sequence), sequence + 1u);
+  rcutils_atomic_store(&(source->active), active);
+  rcutils_atomic_store(&(source->current_time), (uint64_t)current_time);
+  rcutils_atomic_store(&(source->sequence), sequence + 2u);
+}
+
+// Stop reading the shared time source, keeping its last values in the clock storage.
+// The lock of the source must be held, and the clock must read that source.
+static void
+rcl_ros_clock_storage_detach(
+  rcl_clock_t * clock, rcl_ros_clock_storage_t * storage, rcl_ros_time_source_impl_t * source)
+{
+  bool active;
+  rcl_time_point_value_t current_time;
+  rcl_ros_time_source_read(source, &active, &current_time);
+  rcutils_atomic_store(&(storage->current_time), (uint64_t)current_time);
+  rcutils_atomic_store(&(storage->active), active);
+  rcutils_atomic_store(&(storage->source), (uintptr_t)NULL);
+  for (size_t i = 0; i < source->num_clocks; ++i) {
+    if (source->clocks[i] == clock) {
+      source->clocks[i] = source->clocks[--(source->num_clocks)];
+      break;
+    }
+  }
+}
+
 // Implementation only
 static rcl_ret_t
 rcl_get_steady_time(void * data, rcl_time_point_value_t * current_time)
@@ -47,6 +126,86 @@ rcl_get_system_time(void * data, rcl_time_point_value_t * current_time)
   return rcutils_system_time_now(current_time);
 }
 
+#ifdef RCL_TIME_HAS_TSC
+// Time over which the TSC frequency is measured against the steady clock.
+#define RCL_TSC_CALIBRATION_PERIOD RCUTILS_MS_TO_NS(10)
+
+// Nanoseconds per TSC tick as a 32.32 fixed point number, shared by all clocks.
+// 0 until calibrated, and UINT64_MAX if the TSC is unusable.
+static atomic_uint_least64_t rcl_tsc_ns_per_tick;
+
+// Wide enough for the products of TSC ticks and fixed point factors.
+__extension__ typedef unsigned __int128 rcl_tsc_uint128_t;
+
+// Internal storage for the TSC backed RCL_STEADY_TIME implementation
+typedef struct rcl_tsc_clock_storage_s
+{
+  // Steady time and TSC value at the same instant.
+  rcl_time_point_value_t steady_base;
+  uint64_t tsc_base;
+  uint64_t ns_per_tick;
+} rcl_tsc_clock_storage_t;
+
+// Implementation only
+static rcl_ret_t
+rcl_get_tsc_time(void * data, rcl_time_point_value_t * current_time)
+{
+  const rcl_tsc_clock_storage_t * storage = (const rcl_tsc_clock_storage_t *)data;
+  const uint64_t ticks = __rdtsc() - storage->tsc_base;
+  *current_time = storage->steady_base +
+    (rcl_time_point_value_t)(((rcl_tsc_uint128_t)ticks * storage->ns_per_tick) >> 32);
+  return RCL_RET_OK;
+}
+
+// Only an invariant TSC ticks at a constant rate, whatever the power state of the core.
+static bool
+rcl_tsc_is_invariant(void)
+{
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx) || eax < 0x80000007u) {
+    return false;
+  }
+  if (!__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (edx & (1u << 8)) != 0u;
+}
+
+// Measure the TSC frequency, returning UINT64_MAX if it cannot be used.
+static uint64_t
+rcl_tsc_calibrate(void)
+{
+  if (!rcl_tsc_is_invariant()) {
+    return UINT64_MAX;
+  }
+  rcl_time_point_value_t start = 0;
+  rcl_time_point_value_t end = 0;
+  if (RCUTILS_RET_OK != rcutils_steady_time_now(&start)) {
+    rcutils_reset_error();
+    return UINT64_MAX;
+  }
+  const uint64_t tsc_start = __rdtsc();
+  uint64_t tsc_end = tsc_start;
+  do {
+    if (RCUTILS_RET_OK != rcutils_steady_time_now(&end)) {
+      rcutils_reset_error();
+      return UINT64_MAX;
+    }
+    tsc_end = __rdtsc();
+  } while (end - start < RCL_TSC_CALIBRATION_PERIOD);
+  if (tsc_end <= tsc_start) {
+    return UINT64_MAX;
+  }
+  const uint64_t ns_per_tick =
+    (uint64_t)(((rcl_tsc_uint128_t)(end - start) << 32) / (tsc_end - tsc_start));
+  // Anything outside of 100 MHz to 100 GHz is not a working TSC.
+  if (ns_per_tick < (UINT64_C(1) << 32) / 100u || ns_per_tick > (UINT64_C(10) << 32)) {
+    return UINT64_MAX;
+  }
+  return ns_per_tick;
+}
+#endif
+
 // Internal method for zeroing values on init, assumes clock is valid
 static void
 rcl_init_generic_clock(rcl_clock_t * clock, rcl_allocator_t * allocator)
@@ -54,9 +213,13 @@ rcl_init_generic_clock(rcl_clock_t * clock, rcl_allocator_t * allocator)
   clock->type = RCL_CLOCK_UNINITIALIZED;
   clock->jump_callbacks = NULL;
   clock->num_jump_callbacks = 0u;
+  clock->jump_callbacks_capacity = 0u;
   clock->get_now = NULL;
   clock->data = NULL;
   clock->allocator = *allocator;
+  clock->timer_guard_condition = NULL;
+  clock->num_timer_guard_condition_users = 0u;
+  clock->timer_registry = NULL;
 }
 
 // The function used to get the current ros time.
@@ -65,7 +228,18 @@ static rcl_ret_t
 rcl_get_ros_time(void * data, rcl_time_point_value_t * current_time)
 {
   rcl_ros_clock_storage_t * t = (rcl_ros_clock_storage_t *)data;
-  if (!t->active) {
+  rcl_ros_time_source_impl_t * source = rcl_ros_clock_storage_get_source(t);
+  if (NULL != source) {
+    bool active;
+    rcl_time_point_value_t source_time;
+    rcl_ros_time_source_read(source, &active, &source_time);
+    if (!active) {
+      return rcl_get_system_time(data, current_time);
+    }
+    *current_time = source_time;
+    return RCL_RET_OK;
+  }
+  if (!rcutils_atomic_load_bool(&(t->active))) {
     return rcl_get_system_time(data, current_time);
   }
   *current_time = rcutils_atomic_load_uint64_t(&(t->current_time));
@@ -126,6 +300,7 @@ rcl_clock_generic_fini(
     clock->allocator.deallocate(clock->jump_callbacks, clock->allocator.state);
     clock->jump_callbacks = NULL;
   }
+  clock->jump_callbacks_capacity = 0;
 }
 
 rcl_ret_t
@@ -166,7 +341,8 @@ rcl_ros_clock_init(
   rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
   // 0 is a special value meaning time has not been set
   atomic_init(&(storage->current_time), 0);
-  storage->active = false;
+  atomic_init(&(storage->active), false);
+  atomic_init(&(storage->source), (uintptr_t)NULL);
   clock->get_now = rcl_get_ros_time;
   clock->type = RCL_ROS_TIME;
   return RCL_RET_OK;
@@ -181,6 +357,17 @@ rcl_ros_clock_fini(
     RCL_SET_ERROR_MSG("clock not of type RCL_ROS_TIME");
     return RCL_RET_ERROR;
   }
+  rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
+  rcl_ros_time_source_impl_t * source =
+    NULL != storage ? rcl_ros_clock_storage_get_source(storage) : NULL;
+  if (NULL != source) {
+    rcl_spin_lock_acquire(&(source->lock));
+    if (rcl_ros_clock_storage_get_source(storage) == source) {
+      rcl_ros_clock_storage_detach(clock, storage, source);
+    }
+    rcl_spin_lock_release(&(source->lock));
+  }
+  rcl_timer_registry_fini(clock);
   rcl_clock_generic_fini(clock);
   clock->allocator.deallocate(clock->data, clock->allocator.state);
   clock->data = NULL;
@@ -200,6 +387,58 @@ rcl_steady_clock_init(
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_fast_steady_clock_init(
+  rcl_clock_t * clock,
+  rcl_allocator_t * allocator)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(clock, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(allocator, RCL_RET_INVALID_ARGUMENT);
+  rcl_ret_t ret = rcl_steady_clock_init(clock, allocator);
+  if (RCL_RET_OK != ret) {
+    return ret;
+  }
+#ifdef RCL_TIME_HAS_TSC
+  uint64_t ns_per_tick = rcutils_atomic_load_uint64_t(&rcl_tsc_ns_per_tick);
+  if (0u == ns_per_tick) {
+    // Concurrent calibrations only waste time, their results are equally valid.
+    ns_per_tick = rcl_tsc_calibrate();
+    rcutils_atomic_store(&rcl_tsc_ns_per_tick, ns_per_tick);
+  }
+  if (UINT64_MAX == ns_per_tick) {
+    return RCL_RET_OK;
+  }
+  rcl_tsc_clock_storage_t * storage = (rcl_tsc_clock_storage_t *)allocator->allocate(
+    sizeof(rcl_tsc_clock_storage_t), allocator->state);
+  if (NULL == storage) {
+    RCL_SET_ERROR_MSG("allocating memory failed");
+    return RCL_RET_BAD_ALLOC;
+  }
+  if (RCUTILS_RET_OK != rcutils_steady_time_now(&storage->steady_base)) {
+    // Keep the regular steady clock.
+    rcutils_reset_error();
+    allocator->deallocate(storage, allocator->state);
+    return RCL_RET_OK;
+  }
+  storage->tsc_base = __rdtsc();
+  storage->ns_per_tick = ns_per_tick;
+  clock->data = storage;
+  clock->get_now = rcl_get_tsc_time;
+#endif
+  return RCL_RET_OK;
+}
+
+bool
+rcl_clock_uses_tsc(const rcl_clock_t * clock)
+{
+#ifdef RCL_TIME_HAS_TSC
+  return NULL != clock && rcl_get_tsc_time == clock->get_now;
+#else
+  (void)clock;
+  return false;
+#endif
+}
+
 rcl_ret_t
 rcl_steady_clock_fini(
   rcl_clock_t * clock)
@@ -210,6 +449,11 @@ rcl_steady_clock_fini(
     return RCL_RET_ERROR;
   }
   rcl_clock_generic_fini(clock);
+  // Only clocks reading the TSC have storage.
+  if (NULL != clock->data) {
+    clock->allocator.deallocate(clock->data, clock->allocator.state);
+    clock->data = NULL;
+  }
   return RCL_RET_OK;
 }
 
@@ -295,6 +539,49 @@ rcl_clock_call_callbacks(
   }
 }
 
+static void
+rcl_ros_time_source_call_callbacks(
+  rcl_ros_time_source_impl_t * impl, const rcl_time_jump_t * time_jump, bool before_jump)
+{
+  for (size_t i = 0; i < impl->num_clocks; ++i) {
+    rcl_clock_call_callbacks(impl->clocks[i], time_jump, before_jump);
+  }
+}
+
+// Update the override state, the time, or both, of the time source and call the
+// jump callbacks of its clocks around the change.
+// The lock is held throughout, so clocks can't be attached nor detached meanwhile.
+static void
+rcl_ros_time_source_update(
+  rcl_ros_time_source_impl_t * impl,
+  const bool * new_active,
+  const rcl_time_point_value_t * new_time)
+{
+  rcl_spin_lock_acquire(&(impl->lock));
+  bool active;
+  rcl_time_point_value_t current_time;
+  rcl_ros_time_source_read(impl, &active, &current_time);
+  const bool next_active = NULL != new_active ? *new_active : active;
+  const rcl_time_point_value_t next_time = NULL != new_time ? *new_time : current_time;
+  rcl_time_jump_t time_jump;
+  time_jump.delta.nanoseconds = 0;
+  if (active != next_active) {
+    time_jump.clock_change = next_active ? RCL_ROS_TIME_ACTIVATED : RCL_ROS_TIME_DEACTIVATED;
+  } else if (active && NULL != new_time) {
+    time_jump.clock_change = RCL_ROS_TIME_NO_CHANGE;
+    time_jump.delta.nanoseconds = next_time - current_time;
+  } else {
+    // Nothing the clocks can observe jumps.
+    rcl_ros_time_source_write(impl, next_active, next_time);
+    rcl_spin_lock_release(&(impl->lock));
+    return;
+  }
+  rcl_ros_time_source_call_callbacks(impl, &time_jump, true);
+  rcl_ros_time_source_write(impl, next_active, next_time);
+  rcl_ros_time_source_call_callbacks(impl, &time_jump, false);
+  rcl_spin_lock_release(&(impl->lock));
+}
+
 rcl_ret_t
 rcl_enable_ros_time_override(rcl_clock_t * clock)
 {
@@ -306,12 +593,18 @@ rcl_enable_ros_time_override(rcl_clock_t * clock)
   rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
   RCL_CHECK_FOR_NULL_WITH_MSG(
     storage, "Clock storage is not initialized, cannot enable override.", return RCL_RET_ERROR);
-  if (!storage->active) {
+  rcl_ros_time_source_impl_t * source = rcl_ros_clock_storage_get_source(storage);
+  if (NULL != source) {
+    const bool active = true;
+    rcl_ros_time_source_update(source, &active, NULL);
+    return RCL_RET_OK;
+  }
+  if (!rcutils_atomic_load_bool(&(storage->active))) {
     rcl_time_jump_t time_jump;
     time_jump.delta.nanoseconds = 0;
     time_jump.clock_change = RCL_ROS_TIME_ACTIVATED;
     rcl_clock_call_callbacks(clock, &time_jump, true);
-    storage->active = true;
+    rcutils_atomic_store(&(storage->active), true);
     rcl_clock_call_callbacks(clock, &time_jump, false);
   }
   return RCL_RET_OK;
@@ -328,12 +621,18 @@ rcl_disable_ros_time_override(rcl_clock_t * clock)
   rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
   RCL_CHECK_FOR_NULL_WITH_MSG(
     storage, "Clock storage is not initialized, cannot enable override.", return RCL_RET_ERROR);
-  if (storage->active) {
+  rcl_ros_time_source_impl_t * source = rcl_ros_clock_storage_get_source(storage);
+  if (NULL != source) {
+    const bool active = false;
+    rcl_ros_time_source_update(source, &active, NULL);
+    return RCL_RET_OK;
+  }
+  if (rcutils_atomic_load_bool(&(storage->active))) {
     rcl_time_jump_t time_jump;
     time_jump.delta.nanoseconds = 0;
     time_jump.clock_change = RCL_ROS_TIME_DEACTIVATED;
     rcl_clock_call_callbacks(clock, &time_jump, true);
-    storage->active = false;
+    rcutils_atomic_store(&(storage->active), false);
     rcl_clock_call_callbacks(clock, &time_jump, false);
   }
   return RCL_RET_OK;
@@ -353,7 +652,13 @@ rcl_is_enabled_ros_time_override(
   rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
   RCL_CHECK_FOR_NULL_WITH_MSG(
     storage, "Clock storage is not initialized, cannot enable override.", return RCL_RET_ERROR);
-  *is_enabled = storage->active;
+  rcl_ros_time_source_impl_t * source = rcl_ros_clock_storage_get_source(storage);
+  if (NULL != source) {
+    rcl_time_point_value_t current_time;
+    rcl_ros_time_source_read(source, is_enabled, &current_time);
+  } else {
+    *is_enabled = rcutils_atomic_load_bool(&(storage->active));
+  }
   return RCL_RET_OK;
 }
 
@@ -370,8 +675,13 @@ rcl_set_ros_time_override(
   rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
   RCL_CHECK_FOR_NULL_WITH_MSG(
     storage, "Clock storage is not initialized, cannot enable override.", return RCL_RET_ERROR);
+  rcl_ros_time_source_impl_t * source = rcl_ros_clock_storage_get_source(storage);
+  if (NULL != source) {
+    rcl_ros_time_source_update(source, NULL, &time_value);
+    return RCL_RET_OK;
+  }
   rcl_time_jump_t time_jump;
-  if (storage->active) {
+  if (rcutils_atomic_load_bool(&(storage->active))) {
     time_jump.clock_change = RCL_ROS_TIME_NO_CHANGE;
     rcl_time_point_value_t current_time;
     rcl_ret_t ret = rcl_get_ros_time(storage, &current_time);
@@ -388,6 +698,194 @@ rcl_set_ros_time_override(
   return RCL_RET_OK;
 }
 
+rcl_ros_time_source_t
+rcl_get_zero_initialized_ros_time_source(void)
+{
+  static rcl_ros_time_source_t null_source = {0};
+  return null_source;
+}
+
+rcl_ret_t
+rcl_ros_time_source_init(rcl_ros_time_source_t * source, rcl_allocator_t * allocator)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ALLOCATOR_WITH_MSG(allocator, "invalid allocator", return RCL_RET_INVALID_ARGUMENT);
+  if (NULL != source->impl) {
+    RCL_SET_ERROR_MSG("time source already initialized, or memory was uninitialized");
+    return RCL_RET_ALREADY_INIT;
+  }
+  rcl_ros_time_source_impl_t * impl = (rcl_ros_time_source_impl_t *)allocator->allocate(
+    sizeof(rcl_ros_time_source_impl_t), allocator->state);
+  RCL_CHECK_FOR_NULL_WITH_MSG(impl, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+  atomic_init(&(impl->sequence), 0);
+  atomic_init(&(impl->active), false);
+  // 0 is a special value meaning time has not been set
+  atomic_init(&(impl->current_time), 0);
+  rcl_spin_lock_init(&(impl->lock));
+  impl->clocks = NULL;
+  impl->num_clocks = 0;
+  impl->clocks_capacity = 0;
+  impl->allocator = *allocator;
+  source->impl = impl;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_ros_time_source_fini(rcl_ros_time_source_t * source)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  rcl_ros_time_source_impl_t * impl = source->impl;
+  if (NULL == impl) {
+    return RCL_RET_OK;
+  }
+  // Clocks still attached keep the last values of the source.
+  rcl_spin_lock_acquire(&(impl->lock));
+  while (impl->num_clocks > 0) {
+    rcl_clock_t * clock = impl->clocks[impl->num_clocks - 1];
+    rcl_ros_clock_storage_detach(clock, (rcl_ros_clock_storage_t *)clock->data, impl);
+  }
+  rcl_spin_lock_release(&(impl->lock));
+  if (NULL != impl->clocks) {
+    impl->allocator.deallocate(impl->clocks, impl->allocator.state);
+  }
+  impl->allocator.deallocate(impl, impl->allocator.state);
+  source->impl = NULL;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_ros_time_source_enable_override(rcl_ros_time_source_t * source)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    source->impl, "time source is invalid", return RCL_RET_INVALID_ARGUMENT);
+  const bool active = true;
+  rcl_ros_time_source_update(source->impl, &active, NULL);
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_ros_time_source_disable_override(rcl_ros_time_source_t * source)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    source->impl, "time source is invalid", return RCL_RET_INVALID_ARGUMENT);
+  const bool active = false;
+  rcl_ros_time_source_update(source->impl, &active, NULL);
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_ros_time_source_is_override_enabled(rcl_ros_time_source_t * source, bool * is_enabled)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(is_enabled, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    source->impl, "time source is invalid", return RCL_RET_INVALID_ARGUMENT);
+  rcl_time_point_value_t current_time;
+  rcl_ros_time_source_read(source->impl, is_enabled, &current_time);
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_ros_time_source_set_override(
+  rcl_ros_time_source_t * source, rcl_time_point_value_t time_value)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    source->impl, "time source is invalid", return RCL_RET_INVALID_ARGUMENT);
+  rcl_ros_time_source_update(source->impl, NULL, &time_value);
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_clock_attach_ros_time_source(rcl_clock_t * clock, rcl_ros_time_source_t * source)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(clock, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(source, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    source->impl, "time source is invalid", return RCL_RET_INVALID_ARGUMENT);
+  if (clock->type != RCL_ROS_TIME) {
+    RCL_SET_ERROR_MSG("Clock is not of type RCL_ROS_TIME, cannot attach time source.");
+    return RCL_RET_ERROR;
+  }
+  rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    storage, "Clock storage is not initialized, cannot attach time source.",
+    return RCL_RET_ERROR);
+  rcl_ros_time_source_impl_t * impl = source->impl;
+  rcl_spin_lock_acquire(&(impl->lock));
+  if (NULL != rcl_ros_clock_storage_get_source(storage)) {
+    rcl_spin_lock_release(&(impl->lock));
+    RCL_SET_ERROR_MSG("Clock already uses a shared ROS time source.");
+    return RCL_RET_ERROR;
+  }
+  if (impl->num_clocks == impl->clocks_capacity) {
+    size_t capacity = impl->clocks_capacity > 0 ? impl->clocks_capacity * 2 : 4;
+    rcl_clock_t ** clocks = impl->allocator.reallocate(
+      impl->clocks, sizeof(rcl_clock_t *) * capacity, impl->allocator.state);
+    if (NULL == clocks) {
+      rcl_spin_lock_release(&(impl->lock));
+      RCL_SET_ERROR_MSG("allocating memory failed");
+      return RCL_RET_BAD_ALLOC;
+    }
+    impl->clocks = clocks;
+    impl->clocks_capacity = capacity;
+  }
+
+  // Switching to the values of the source is a jump like any other for the clock.
+  bool source_active;
+  rcl_time_point_value_t source_time;
+  rcl_ros_time_source_read(impl, &source_active, &source_time);
+  bool active = rcutils_atomic_load_bool(&(storage->active));
+  rcl_time_point_value_t current_time =
+    (rcl_time_point_value_t)rcutils_atomic_load_uint64_t(&(storage->current_time));
+  rcl_time_jump_t time_jump;
+  time_jump.delta.nanoseconds = 0;
+  time_jump.clock_change = RCL_ROS_TIME_NO_CHANGE;
+  if (active != source_active) {
+    time_jump.clock_change = source_active ? RCL_ROS_TIME_ACTIVATED : RCL_ROS_TIME_DEACTIVATED;
+  } else if (active) {
+    time_jump.delta.nanoseconds = source_time - current_time;
+  }
+  rcl_clock_call_callbacks(clock, &time_jump, true);
+  rcutils_atomic_store(&(storage->source), (uintptr_t)impl);
+  impl->clocks[impl->num_clocks++] = clock;
+  rcl_clock_call_callbacks(clock, &time_jump, false);
+  rcl_spin_lock_release(&(impl->lock));
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_clock_detach_ros_time_source(rcl_clock_t * clock)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(clock, RCL_RET_INVALID_ARGUMENT);
+  if (clock->type != RCL_ROS_TIME) {
+    RCL_SET_ERROR_MSG("Clock is not of type RCL_ROS_TIME, cannot detach time source.");
+    return RCL_RET_ERROR;
+  }
+  rcl_ros_clock_storage_t * storage = (rcl_ros_clock_storage_t *)clock->data;
+  RCL_CHECK_FOR_NULL_WITH_MSG(
+    storage, "Clock storage is not initialized, cannot detach time source.",
+    return RCL_RET_ERROR);
+  rcl_ros_time_source_impl_t * source = rcl_ros_clock_storage_get_source(storage);
+  if (NULL != source) {
+    rcl_spin_lock_acquire(&(source->lock));
+    // Another thread may have detached the clock meanwhile.
+    if (rcl_ros_clock_storage_get_source(storage) != source) {
+      rcl_spin_lock_release(&(source->lock));
+      source = NULL;
+    }
+  }
+  if (NULL == source) {
+    RCL_SET_ERROR_MSG("Clock does not use a shared ROS time source.");
+    return RCL_RET_ERROR;
+  }
+  rcl_ros_clock_storage_detach(clock, storage, source);
+  rcl_spin_lock_release(&(source->lock));
+  return RCL_RET_OK;
+}
+
 rcl_ret_t
 rcl_clock_add_jump_callback(
   rcl_clock_t * clock, rcl_jump_threshold_t threshold, rcl_jump_callback_t callback,
@@ -416,15 +914,19 @@ rcl_clock_add_jump_callback(
     }
   }
 
-  // Add the new callback, increasing the size of the callback list
-  rcl_jump_callback_info_t * callbacks = clock->allocator.reallocate(
-    clock->jump_callbacks, sizeof(rcl_jump_callback_info_t) * (clock->num_jump_callbacks + 1),
-    clock->allocator.state);
-  if (NULL == callbacks) {
-    RCL_SET_ERROR_MSG("Failed to realloc jump callbacks");
-    return RCL_RET_BAD_ALLOC;
+  // Add the new callback, growing the callback list geometrically when it is full
+  if (clock->num_jump_callbacks == clock->jump_callbacks_capacity) {
+    size_t capacity = clock->jump_callbacks_capacity > 0 ? clock->jump_callbacks_capacity * 2 : 4;
+    rcl_jump_callback_info_t * callbacks = clock->allocator.reallocate(
+      clock->jump_callbacks, sizeof(rcl_jump_callback_info_t) * capacity,
+      clock->allocator.state);
+    if (NULL == callbacks) {
+      RCL_SET_ERROR_MSG("Failed to realloc jump callbacks");
+      return RCL_RET_BAD_ALLOC;
+    }
+    clock->jump_callbacks = callbacks;
+    clock->jump_callbacks_capacity = capacity;
   }
-  clock->jump_callbacks = callbacks;
   clock->jump_callbacks[clock->num_jump_callbacks].callback = callback;
   clock->jump_callbacks[clock->num_jump_callbacks].threshold = threshold;
   clock->jump_callbacks[clock->num_jump_callbacks].user_data = user_data;
@@ -442,34 +944,25 @@ rcl_clock_remove_jump_callback(
     &(clock->allocator), "invalid allocator", return RCL_RET_INVALID_ARGUMENT);
   RCL_CHECK_ARGUMENT_FOR_NULL(callback, RCL_RET_INVALID_ARGUMENT);
 
-  // Delete callback if found, moving all callbacks after back one
-  bool found_callback = false;
-  for (size_t cb_idx = 0; cb_idx < clock->num_jump_callbacks; ++cb_idx) {
+  // Delete callback if found, moving the last callback into its place
+  size_t cb_idx = 0;
+  for (; cb_idx < clock->num_jump_callbacks; ++cb_idx) {
     const rcl_jump_callback_info_t * info = &(clock->jump_callbacks[cb_idx]);
-    if (found_callback) {
-      clock->jump_callbacks[cb_idx - 1] = *info;
-    } else if (info->callback == callback && info->user_data == user_data) {
-      found_callback = true;
+    if (info->callback == callback && info->user_data == user_data) {
+      break;
     }
   }
-  if (!found_callback) {
+  if (cb_idx == clock->num_jump_callbacks) {
     RCL_SET_ERROR_MSG("jump callback was not found");
     return RCL_RET_ERROR;
   }
+  clock->jump_callbacks[cb_idx] = clock->jump_callbacks[clock->num_jump_callbacks - 1];
 
-  // Shrink size of the callback array
+  // Keep the storage around until the list is empty
   if (--(clock->num_jump_callbacks) == 0) {
     clock->allocator.deallocate(clock->jump_callbacks, clock->allocator.state);
     clock->jump_callbacks = NULL;
-  } else {
-    rcl_jump_callback_info_t * callbacks = clock->allocator.reallocate(
-      clock->jump_callbacks, sizeof(rcl_jump_callback_info_t) * clock->num_jump_callbacks,
-      clock->allocator.state);
-    if (NULL == callbacks) {
-      RCL_SET_ERROR_MSG("Failed to shrink jump callbacks");
-      return RCL_RET_BAD_ALLOC;
-    }
-    clock->jump_callbacks = callbacks;
+    clock->jump_callbacks_capacity = 0;
   }
   return RCL_RET_OK;
 }
@@ -20,6 +20,7 @@ extern "C"
 #include "rcl/timer.h"
 
 #include <inttypes.h>
+#include <string.h>
 
 #include "rcl/error_handling.h"
 #include "rcutils/logging_macros.h"
@@ -27,6 +28,9 @@ extern "C"
 #include "rcutils/time.h"
 #include "tracetools/tracetools.h"
 
+#include "./spin_lock_impl.h"
+#include "./timer_impl.h"
+
 struct rcl_timer_impl_s
 {
   // The clock providing time.
@@ -36,6 +40,9 @@ struct rcl_timer_impl_s
   // A guard condition used to wake the associated wait set, either when
   // ROSTime causes the timer to expire or when the timer is reset.
   rcl_guard_condition_t guard_condition;
+  // If true, the clock's timer guard condition is used instead of the one above,
+  // which is then left zero initialized.
+  bool shares_clock_guard_condition;
   // The user supplied callback.
   atomic_uintptr_t callback;
   // This is a duration in nanoseconds, which is initialized as int64_t
@@ -53,6 +60,18 @@ struct rcl_timer_impl_s
   rcl_allocator_t allocator;
   // The user supplied on reset callback data.
   rcl_timer_on_reset_callback_data_t callback_data;
+  // The engine triggering the guard condition on expiry, if any.
+  atomic_uintptr_t engine;
+  // Position of the timer in the heap of its clock's timer registry, for ROS time clocks.
+  size_t registry_index;
+  // Nanoseconds by which waking up for the timer may be delayed.
+  int64_t slack;
+  // If true, the calls of the timer are recorded in the statistics below.
+  bool statistics_enabled;
+  // The means are only computed when the statistics are retrieved.
+  rcl_timer_statistics_t statistics;
+  int64_t total_lateness;
+  int64_t total_callback_duration;
 };
 
 rcl_timer_t
@@ -62,7 +81,92 @@ rcl_get_zero_initialized_timer()
   return null_timer;
 }
 
-void _rcl_timer_time_jump(
+rcl_timer_options_t
+rcl_timer_get_default_options()
+{
+  // !!! MAKE SURE THAT CHANGES TO THESE DEFAULTS ARE REFLECTED IN THE HEADER DOC STRING
+  static rcl_timer_options_t default_options;
+  default_options.allocator = rcl_get_default_allocator();
+  default_options.autostart = true;
+  default_options.share_clock_guard_condition = false;
+  default_options.statistics = false;
+  default_options.slack = 0;
+  return default_options;
+}
+
+static rcl_guard_condition_t *
+_rcl_timer_guard_condition(rcl_timer_impl_t * impl)
+{
+  if (impl->shares_clock_guard_condition) {
+    return impl->clock->timer_guard_condition;
+  }
+  return &impl->guard_condition;
+}
+
+// Guards the timer guard conditions of all clocks and their numbers of users,
+// so that timers sharing a clock may be initialized and finalized concurrently.
+// It is only held while a timer is initialized or finalized, and starts released
+// as a zero initialized static.
+static rcl_spin_lock_t _rcl_timer_clock_guard_condition_lock;
+
+// Create the clock's timer guard condition on first use and count its users,
+// with the lock above held.
+static rcl_ret_t
+_rcl_timer_acquire_clock_guard_condition_locked(rcl_clock_t * clock, rcl_context_t * context)
+{
+  if (NULL == clock->timer_guard_condition) {
+    rcl_guard_condition_t * guard_condition = (rcl_guard_condition_t *)clock->allocator.allocate(
+      sizeof(rcl_guard_condition_t), clock->allocator.state);
+    RCL_CHECK_FOR_NULL_WITH_MSG(
+      guard_condition, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+    *guard_condition = rcl_get_zero_initialized_guard_condition();
+    rcl_guard_condition_options_t options = rcl_guard_condition_get_default_options();
+    options.allocator = clock->allocator;
+    rcl_ret_t ret = rcl_guard_condition_init(guard_condition, context, options);
+    if (RCL_RET_OK != ret) {
+      clock->allocator.deallocate(guard_condition, clock->allocator.state);
+      return ret;  // rcl error state should already be set.
+    }
+    clock->timer_guard_condition = guard_condition;
+  } else if (clock->timer_guard_condition->context != context) {
+    RCL_SET_ERROR_MSG("timers sharing a clock guard condition must use the same context");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  ++(clock->num_timer_guard_condition_users);
+  return RCL_RET_OK;
+}
+
+static rcl_ret_t
+_rcl_timer_acquire_clock_guard_condition(rcl_clock_t * clock, rcl_context_t * context)
+{
+  rcl_spin_lock_acquire(&_rcl_timer_clock_guard_condition_lock);
+  rcl_ret_t ret = _rcl_timer_acquire_clock_guard_condition_locked(clock, context);
+  rcl_spin_lock_release(&_rcl_timer_clock_guard_condition_lock);
+  return ret;
+}
+
+// Finalize whichever guard condition the timer uses, the shared one only
+// once its last user is gone.
+static rcl_ret_t
+_rcl_timer_guard_condition_fini(rcl_timer_impl_t * impl)
+{
+  if (!impl->shares_clock_guard_condition) {
+    return rcl_guard_condition_fini(&(impl->guard_condition));
+  }
+  rcl_clock_t * clock = impl->clock;
+  rcl_ret_t ret = RCL_RET_OK;
+  rcl_spin_lock_acquire(&_rcl_timer_clock_guard_condition_lock);
+  if (0u == --(clock->num_timer_guard_condition_users)) {
+    ret = rcl_guard_condition_fini(clock->timer_guard_condition);
+    clock->allocator.deallocate(clock->timer_guard_condition, clock->allocator.state);
+    clock->timer_guard_condition = NULL;
+  }
+  rcl_spin_lock_release(&_rcl_timer_clock_guard_condition_lock);
+  return ret;
+}
+
+static void
+_rcl_timer_time_jump(
   const rcl_time_jump_t * time_jump,
   bool before_jump,
   void * user_data)
@@ -100,6 +204,12 @@ void _rcl_timer_time_jump(
       RCL_ROS_TIME_DEACTIVATED == time_jump->clock_change)
     {
       // ROS time activated or deactivated
+      // Wake wait sets, which only wait for the timer with a timeout while
+      // ROS time is not active.
+      if (RCL_RET_OK != rcl_trigger_guard_condition(_rcl_timer_guard_condition(timer->impl))) {
+        RCUTILS_LOG_ERROR_NAMED(
+          ROS_PACKAGE_NAME, "Failed to get trigger guard condition in jump callback");
+      }
       if (0 == now) {
         // Can't apply time credit if clock is uninitialized
         return;
@@ -112,7 +222,7 @@ void _rcl_timer_time_jump(
       }
     } else if (next_call_time <= now) {
       // Post Forward jump and timer is ready
-      if (RCL_RET_OK != rcl_trigger_guard_condition(&timer->impl->guard_condition)) {
+      if (RCL_RET_OK != rcl_trigger_guard_condition(_rcl_timer_guard_condition(timer->impl))) {
         RCUTILS_LOG_ERROR_NAMED(
           ROS_PACKAGE_NAME, "Failed to get trigger guard condition in jump callback");
       }
@@ -126,6 +236,238 @@ void _rcl_timer_time_jump(
   }
 }
 
+// An entry of the timer registry heap.
+// The key is never later than the next call time of the timer, unless the registry is stale.
+typedef struct rcl_timer_registry_entry_s
+{
+  rcl_timer_t * timer;
+  int64_t key;
+} rcl_timer_registry_entry_t;
+
+// The timers of a ROS time clock, in a min-heap ordered by their next call time.
+// A single jump callback serves all of them, and a forward jump only visits the
+// timers which may have become ready instead of every timer on the clock.
+// The registry lives as long as the clock, so that timers can be added and removed
+// under its lock while the jump callback runs.
+typedef struct rcl_timer_registry_s
+{
+  rcl_clock_t * clock;
+  // Held while the heap is used.
+  rcl_spin_lock_t lock;
+  rcl_timer_registry_entry_t * heap;
+  size_t size;
+  size_t capacity;
+  // Set when the next call time of a timer moved earlier than its key, e.g. on reset.
+  atomic_bool stale;
+} rcl_timer_registry_t;
+
+static void
+_rcl_timer_registry_place(
+  rcl_timer_registry_t * registry, size_t index, rcl_timer_registry_entry_t entry)
+{
+  registry->heap[index] = entry;
+  entry.timer->impl->registry_index = index;
+}
+
+static void
+_rcl_timer_registry_sift_up(rcl_timer_registry_t * registry, size_t index)
+{
+  rcl_timer_registry_entry_t entry = registry->heap[index];
+  while (index > 0u) {
+    size_t parent = (index - 1u) / 2u;
+    if (registry->heap[parent].key <= entry.key) {
+      break;
+    }
+    _rcl_timer_registry_place(registry, index, registry->heap[parent]);
+    index = parent;
+  }
+  _rcl_timer_registry_place(registry, index, entry);
+}
+
+static void
+_rcl_timer_registry_sift_down(rcl_timer_registry_t * registry, size_t index)
+{
+  rcl_timer_registry_entry_t entry = registry->heap[index];
+  for (;; ) {
+    size_t child = 2u * index + 1u;
+    if (child >= registry->size) {
+      break;
+    }
+    if (child + 1u < registry->size && registry->heap[child + 1u].key < registry->heap[child].key) {
+      ++child;
+    }
+    if (entry.key <= registry->heap[child].key) {
+      break;
+    }
+    _rcl_timer_registry_place(registry, index, registry->heap[child]);
+    index = child;
+  }
+  _rcl_timer_registry_place(registry, index, entry);
+}
+
+// Read the next call time of every timer again and restore the heap order.
+static void
+_rcl_timer_registry_refresh(rcl_timer_registry_t * registry)
+{
+  size_t i;
+  for (i = 0u; i < registry->size; ++i) {
+    rcl_timer_impl_t * impl = registry->heap[i].timer->impl;
+    registry->heap[i].key = rcutils_atomic_load_int64_t(&impl->next_call_time);
+  }
+  for (i = registry->size / 2u; i-- > 0u; ) {
+    _rcl_timer_registry_sift_down(registry, i);
+  }
+}
+
+static void
+_rcl_timer_registry_time_jump(
+  const rcl_time_jump_t * time_jump,
+  bool before_jump,
+  void * user_data)
+{
+  rcl_timer_registry_t * registry = (rcl_timer_registry_t *)user_data;
+  size_t i;
+  if (RCL_ROS_TIME_NO_CHANGE != time_jump->clock_change || time_jump->delta.nanoseconds < 0) {
+    // Clock changes and backward jumps may move every timer, so each one handles them.
+    rcl_spin_lock_acquire(&registry->lock);
+    for (i = 0u; i < registry->size; ++i) {
+      _rcl_timer_time_jump(time_jump, before_jump, registry->heap[i].timer);
+    }
+    if (!before_jump) {
+      rcutils_atomic_store(&registry->stale, false);
+      _rcl_timer_registry_refresh(registry);
+    }
+    rcl_spin_lock_release(&registry->lock);
+    return;
+  }
+  if (before_jump) {
+    // Nothing to do before a forward jump.
+    return;
+  }
+  rcl_time_point_value_t now;
+  if (RCL_RET_OK != rcl_clock_get_now(registry->clock, &now)) {
+    RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Failed to get current time in jump callback");
+    return;
+  }
+  rcl_spin_lock_acquire(&registry->lock);
+  if (rcutils_atomic_exchange_bool(&registry->stale, false)) {
+    _rcl_timer_registry_refresh(registry);
+  }
+  // Only the timers with a key no later than now may be ready.
+  while (registry->size > 0u && registry->heap[0].key <= now) {
+    rcl_timer_impl_t * impl = registry->heap[0].timer->impl;
+    int64_t next_call_time = rcutils_atomic_load_int64_t(&impl->next_call_time);
+    if (next_call_time <= now) {
+      // Post forward jump and timer is ready
+      if (RCL_RET_OK != rcl_trigger_guard_condition(_rcl_timer_guard_condition(impl))) {
+        RCUTILS_LOG_ERROR_NAMED(
+          ROS_PACKAGE_NAME, "Failed to get trigger guard condition in jump callback");
+      }
+      // The timer stays ready until it is called, so visit it again on the next
+      // forward jump, which is at least one nanosecond later.
+      next_call_time = now + 1;
+    }
+    registry->heap[0].key = next_call_time;
+    _rcl_timer_registry_sift_down(registry, 0u);
+  }
+  rcl_spin_lock_release(&registry->lock);
+}
+
+void
+rcl_timer_registry_fini(rcl_clock_t * clock)
+{
+  rcl_timer_registry_t * registry = clock->timer_registry;
+  if (NULL == registry) {
+    return;
+  }
+  if (RCL_RET_OK != rcl_clock_remove_jump_callback(
+      clock, _rcl_timer_registry_time_jump, registry))
+  {
+    RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Failed to remove timer jump callback");
+  }
+  if (NULL != registry->heap) {
+    clock->allocator.deallocate(registry->heap, clock->allocator.state);
+  }
+  clock->allocator.deallocate(registry, clock->allocator.state);
+  clock->timer_registry = NULL;
+}
+
+// Add the timer to the registry of its clock, which is created along with its
+// jump callback for the first timer.
+// Creating it is not thread-safe with time updates of the clock, like any other
+// change to the jump callbacks of the clock.
+static rcl_ret_t
+_rcl_timer_registry_add(rcl_timer_t * timer)
+{
+  rcl_clock_t * clock = timer->impl->clock;
+  rcl_timer_registry_t * registry = clock->timer_registry;
+  if (NULL == registry) {
+    registry = (rcl_timer_registry_t *)clock->allocator.allocate(
+      sizeof(rcl_timer_registry_t), clock->allocator.state);
+    RCL_CHECK_FOR_NULL_WITH_MSG(registry, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+    registry->clock = clock;
+    rcl_spin_lock_init(&registry->lock);
+    registry->heap = NULL;
+    registry->size = 0u;
+    registry->capacity = 0u;
+    atomic_init(&registry->stale, false);
+    rcl_jump_threshold_t threshold;
+    threshold.on_clock_change = true;
+    threshold.min_forward.nanoseconds = 1;
+    threshold.min_backward.nanoseconds = -1;
+    rcl_ret_t ret = rcl_clock_add_jump_callback(
+      clock, threshold, _rcl_timer_registry_time_jump, registry);
+    if (RCL_RET_OK != ret) {
+      clock->allocator.deallocate(registry, clock->allocator.state);
+      return ret;  // rcl error state should already be set.
+    }
+    clock->timer_registry = registry;
+  }
+  rcl_spin_lock_acquire(&registry->lock);
+  if (registry->size == registry->capacity) {
+    size_t capacity = registry->capacity > 0u ? registry->capacity * 2u : 4u;
+    rcl_timer_registry_entry_t * heap = (rcl_timer_registry_entry_t *)clock->allocator.reallocate(
+      registry->heap, sizeof(rcl_timer_registry_entry_t) * capacity, clock->allocator.state);
+    if (NULL == heap) {
+      rcl_spin_lock_release(&registry->lock);
+      RCL_SET_ERROR_MSG("allocating memory failed");
+      return RCL_RET_BAD_ALLOC;
+    }
+    registry->heap = heap;
+    registry->capacity = capacity;
+  }
+  rcl_timer_registry_entry_t entry;
+  entry.timer = timer;
+  entry.key = rcutils_atomic_load_int64_t(&timer->impl->next_call_time);
+  _rcl_timer_registry_place(registry, registry->size, entry);
+  ++(registry->size);
+  _rcl_timer_registry_sift_up(registry, registry->size - 1u);
+  rcl_spin_lock_release(&registry->lock);
+  return RCL_RET_OK;
+}
+
+// Remove the timer from the registry of its clock.
+// The registry is gone if the clock was finalized before the timer.
+static rcl_ret_t
+_rcl_timer_registry_remove(rcl_timer_t * timer)
+{
+  rcl_timer_registry_t * registry = timer->impl->clock->timer_registry;
+  if (NULL == registry) {
+    return RCL_RET_ERROR;
+  }
+  rcl_spin_lock_acquire(&registry->lock);
+  size_t index = timer->impl->registry_index;
+  --(registry->size);
+  if (index < registry->size) {
+    rcl_timer_registry_entry_t last = registry->heap[registry->size];
+    _rcl_timer_registry_place(registry, index, last);
+    _rcl_timer_registry_sift_down(registry, index);
+    _rcl_timer_registry_sift_up(registry, last.timer->impl->registry_index);
+  }
+  rcl_spin_lock_release(&registry->lock);
+  return RCL_RET_OK;
+}
+
 rcl_ret_t
 rcl_timer_init(
   rcl_timer_t * timer,
@@ -150,6 +492,23 @@ rcl_timer_init2(
   rcl_allocator_t allocator,
   bool autostart)
 {
+  rcl_timer_options_t options = rcl_timer_get_default_options();
+  options.allocator = allocator;
+  options.autostart = autostart;
+  return rcl_timer_init_with_options(timer, clock, context, period, callback, &options);
+}
+
+rcl_ret_t
+rcl_timer_init_with_options(
+  rcl_timer_t * timer,
+  rcl_clock_t * clock,
+  rcl_context_t * context,
+  int64_t period,
+  const rcl_timer_callback_t callback,
+  const rcl_timer_options_t * options)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(options, RCL_RET_INVALID_ARGUMENT);
+  rcl_allocator_t allocator = options->allocator;
   RCL_CHECK_ALLOCATOR_WITH_MSG(&allocator, "invalid allocator", return RCL_RET_INVALID_ARGUMENT);
   RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
   RCL_CHECK_ARGUMENT_FOR_NULL(clock, RCL_RET_INVALID_ARGUMENT);
@@ -157,6 +516,10 @@ rcl_timer_init2(
     RCL_SET_ERROR_MSG("timer period must be non-negative");
     return RCL_RET_INVALID_ARGUMENT;
   }
+  if (options->slack < 0) {
+    RCL_SET_ERROR_MSG("timer slack must be non-negative");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
   RCUTILS_LOG_DEBUG_NAMED(
     ROS_PACKAGE_NAME, "Initializing timer with period: %" PRIu64 "ns", period);
   if (timer->impl) {
@@ -172,33 +535,31 @@ rcl_timer_init2(
   impl.clock = clock;
   impl.context = context;
   impl.guard_condition = rcl_get_zero_initialized_guard_condition();
-  rcl_guard_condition_options_t options = rcl_guard_condition_get_default_options();
-  rcl_ret_t ret = rcl_guard_condition_init(&(impl.guard_condition), context, options);
+  impl.shares_clock_guard_condition = options->share_clock_guard_condition;
+  rcl_ret_t ret;
+  if (impl.shares_clock_guard_condition) {
+    ret = _rcl_timer_acquire_clock_guard_condition(clock, context);
+  } else {
+    rcl_guard_condition_options_t gc_options = rcl_guard_condition_get_default_options();
+    ret = rcl_guard_condition_init(&(impl.guard_condition), context, gc_options);
+  }
   if (RCL_RET_OK != ret) {
     return ret;
   }
-  if (RCL_ROS_TIME == impl.clock->type) {
-    rcl_jump_threshold_t threshold;
-    threshold.on_clock_change = true;
-    threshold.min_forward.nanoseconds = 1;
-    threshold.min_backward.nanoseconds = -1;
-    ret = rcl_clock_add_jump_callback(clock, threshold, _rcl_timer_time_jump, timer);
-    if (RCL_RET_OK != ret) {
-      if (RCL_RET_OK != rcl_guard_condition_fini(&(impl.guard_condition))) {
-        // Should be impossible
-        RCUTILS_LOG_ERROR_NAMED(
-          ROS_PACKAGE_NAME, "Failed to fini guard condition after failing to add jump callback");
-      }
-      return ret;
-    }
-  }
   atomic_init(&impl.callback, (uintptr_t)callback);
   atomic_init(&impl.period, period);
   atomic_init(&impl.time_credit, 0);
   atomic_init(&impl.last_call_time, now);
   atomic_init(&impl.next_call_time, now + period);
-  atomic_init(&impl.canceled, !autostart);
+  atomic_init(&impl.canceled, !options->autostart);
+  atomic_init(&impl.engine, (uintptr_t)NULL);
+  impl.registry_index = 0u;
+  impl.slack = options->slack;
   impl.allocator = allocator;
+  impl.statistics_enabled = options->statistics;
+  memset(&impl.statistics, 0, sizeof(rcl_timer_statistics_t));
+  impl.total_lateness = 0;
+  impl.total_callback_duration = 0;
 
   // Empty init on reset callback data
   impl.callback_data.on_reset_callback = NULL;
@@ -207,19 +568,27 @@ rcl_timer_init2(
 
   timer->impl = (rcl_timer_impl_t *)allocator.allocate(sizeof(rcl_timer_impl_t), allocator.state);
   if (NULL == timer->impl) {
-    if (RCL_RET_OK != rcl_guard_condition_fini(&(impl.guard_condition))) {
+    if (RCL_RET_OK != _rcl_timer_guard_condition_fini(&impl)) {
       // Should be impossible
       RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Failed to fini guard condition after bad alloc");
     }
-    if (RCL_RET_OK != rcl_clock_remove_jump_callback(clock, _rcl_timer_time_jump, timer)) {
-      // Should be impossible
-      RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Failed to remove callback after bad alloc");
-    }
-
     RCL_SET_ERROR_MSG("allocating memory failed");
     return RCL_RET_BAD_ALLOC;
   }
   *timer->impl = impl;
+  if (RCL_ROS_TIME == clock->type) {
+    ret = _rcl_timer_registry_add(timer);
+    if (RCL_RET_OK != ret) {
+      if (RCL_RET_OK != _rcl_timer_guard_condition_fini(timer->impl)) {
+        // Should be impossible
+        RCUTILS_LOG_ERROR_NAMED(
+          ROS_PACKAGE_NAME, "Failed to fini guard condition after failing to add jump callback");
+      }
+      allocator.deallocate(timer->impl, allocator.state);
+      timer->impl = NULL;
+      return ret;
+    }
+  }
   TRACETOOLS_TRACEPOINT(rcl_timer_init, (const void *)timer, period);
   return RCL_RET_OK;
 }
@@ -234,15 +603,23 @@ rcl_timer_fini(rcl_timer_t * timer)
   rcl_ret_t result = rcl_timer_cancel(timer);
   rcl_allocator_t allocator = timer->impl->allocator;
   rcl_ret_t fail_ret;
+  rcl_timer_engine_t * engine = rcl_timer_get_engine(timer);
+  if (NULL != engine) {
+    // The engine uses the guard condition, so the timer leaves it first.
+    fail_ret = rcl_timer_engine_remove_timer(engine, timer);
+    if (RCL_RET_OK != fail_ret) {
+      RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Failed to remove timer from its engine");
+    }
+  }
   if (RCL_ROS_TIME == timer->impl->clock->type) {
-    // The jump callbacks use the guard condition, so we have to remove it
-    // before freeing the guard condition below.
-    fail_ret = rcl_clock_remove_jump_callback(timer->impl->clock, _rcl_timer_time_jump, timer);
+    // The jump callbacks use the guard condition, so we have to remove the timer
+    // from the registry before freeing the guard condition below.
+    fail_ret = _rcl_timer_registry_remove(timer);
     if (RCL_RET_OK != fail_ret) {
       RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Failed to remove timer jump callback");
     }
   }
-  fail_ret = rcl_guard_condition_fini(&(timer->impl->guard_condition));
+  fail_ret = _rcl_timer_guard_condition_fini(timer->impl);
   if (RCL_RET_OK != fail_ret) {
     RCL_SET_ERROR_MSG("Failure to fini guard condition");
   }
@@ -270,26 +647,40 @@ rcl_timer_call(rcl_timer_t * timer)
   return rcl_timer_call_with_info(timer, &info);
 }
 
-rcl_ret_t
-rcl_timer_call_with_info(rcl_timer_t * timer, rcl_timer_call_info_t * call_info)
+static void
+_rcl_timer_histogram_add(uint64_t * histogram, uint64_t value)
 {
-  RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Calling timer");
-  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
-  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
-  RCL_CHECK_ARGUMENT_FOR_NULL(call_info, RCL_RET_INVALID_ARGUMENT);
-  if (rcutils_atomic_load_bool(&timer->impl->canceled)) {
-    RCL_SET_ERROR_MSG("timer is canceled");
-    return RCL_RET_TIMER_CANCELED;
+  size_t bucket = 0;
+  while (value > 0u && bucket < RCL_TIMER_STATISTICS_HISTOGRAM_SIZE - 1) {
+    value >>= 1;
+    ++bucket;
   }
-  rcl_time_point_value_t now;
-  rcl_ret_t now_ret = rcl_clock_get_now(timer->impl->clock, &now);
-  if (now_ret != RCL_RET_OK) {
-    return now_ret;  // rcl error state should already be set.
+  ++histogram[bucket];
+}
+
+static void
+_rcl_timer_record_call(rcl_timer_impl_t * impl, int64_t lateness, int64_t skipped_periods)
+{
+  rcl_timer_statistics_t * statistics = &impl->statistics;
+  if (0u == statistics->call_count || lateness < statistics->min_lateness) {
+    statistics->min_lateness = lateness;
   }
-  if (now < 0) {
-    RCL_SET_ERROR_MSG("clock now returned negative time point value");
-    return RCL_RET_ERROR;
+  if (0u == statistics->call_count || lateness > statistics->max_lateness) {
+    statistics->max_lateness = lateness;
   }
+  ++(statistics->call_count);
+  statistics->skipped_periods += (uint64_t)skipped_periods;
+  impl->total_lateness += lateness;
+  // Early calls count as not late at all.
+  _rcl_timer_histogram_add(
+    statistics->lateness_histogram, lateness > 0 ? (uint64_t)RCUTILS_NS_TO_US(lateness) : 0u);
+}
+
+// Advance the timer as called at the given time, then call its callback.
+static void
+_rcl_timer_call_at(
+  rcl_timer_t * timer, rcl_time_point_value_t now, rcl_timer_call_info_t * call_info)
+{
   rcl_time_point_value_t previous_ns =
     rcutils_atomic_exchange_int64_t(&timer->impl->last_call_time, now);
   rcl_timer_callback_t typed_callback =
@@ -303,6 +694,7 @@ rcl_timer_call_with_info(rcl_timer_t * timer, rcl_timer_call_info_t * call_info)
   // don't use now as the base to avoid extending each cycle by the time
   // between the timer being ready and the callback being triggered
   next_call_time += period;
+  int64_t skipped_periods = 0;
   // in case the timer has missed at least once cycle
   if (next_call_time <= now) {
     if (0 == period) {
@@ -314,14 +706,151 @@ rcl_timer_call_with_info(rcl_timer_t * timer, rcl_timer_call_info_t * call_info)
       // rounding up without overflow
       int64_t periods_ahead = 1 + now_ahead / period;
       next_call_time += periods_ahead * period;
+      skipped_periods = periods_ahead;
     }
   }
   rcutils_atomic_store(&timer->impl->next_call_time, next_call_time);
+  rcl_timer_engine_t * engine = rcl_timer_get_engine(timer);
+  if (NULL != engine) {
+    // The engine does not wait for the next deadline until it is told about it.
+    rcl_timer_engine_notify(engine);
+  }
+  if (timer->impl->statistics_enabled) {
+    _rcl_timer_record_call(
+      timer->impl, now - call_info->expected_call_time, skipped_periods);
+  }
 
   if (typed_callback != NULL) {
     int64_t since_last_call = now - previous_ns;
     typed_callback(timer, since_last_call);
   }
+}
+
+rcl_ret_t
+rcl_timer_call_with_info(rcl_timer_t * timer, rcl_timer_call_info_t * call_info)
+{
+  RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Calling timer");
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  RCL_CHECK_ARGUMENT_FOR_NULL(call_info, RCL_RET_INVALID_ARGUMENT);
+  if (rcutils_atomic_load_bool(&timer->impl->canceled)) {
+    RCL_SET_ERROR_MSG("timer is canceled");
+    return RCL_RET_TIMER_CANCELED;
+  }
+  rcl_time_point_value_t now;
+  rcl_ret_t now_ret = rcl_clock_get_now(timer->impl->clock, &now);
+  if (now_ret != RCL_RET_OK) {
+    return now_ret;  // rcl error state should already be set.
+  }
+  if (now < 0) {
+    RCL_SET_ERROR_MSG("clock now returned negative time point value");
+    return RCL_RET_ERROR;
+  }
+  _rcl_timer_call_at(timer, now, call_info);
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_timer_call_batch(
+  rcl_timer_t ** timers,
+  size_t count,
+  rcl_time_point_value_t now,
+  rcl_timer_call_info_t * call_infos)
+{
+  RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Calling %zu timers", count);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timers, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(call_infos, RCL_RET_INVALID_ARGUMENT);
+  if (now < 0) {
+    RCL_SET_ERROR_MSG("time point value must not be negative");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  // Validate every timer first, so that none is called if any argument is invalid.
+  const rcl_clock_t * clock = NULL;
+  size_t i;
+  for (i = 0; i < count; ++i) {
+    if (NULL == timers[i]) {
+      continue;
+    }
+    RCL_CHECK_ARGUMENT_FOR_NULL(timers[i]->impl, RCL_RET_TIMER_INVALID);
+    if (NULL == clock) {
+      clock = timers[i]->impl->clock;
+    } else if (timers[i]->impl->clock != clock) {
+      RCL_SET_ERROR_MSG("timers must all use the same clock");
+      return RCL_RET_INVALID_ARGUMENT;
+    }
+  }
+  for (i = 0; i < count; ++i) {
+    if (NULL == timers[i]) {
+      continue;
+    }
+    if (rcutils_atomic_load_bool(&timers[i]->impl->canceled)) {
+      timers[i] = NULL;
+      continue;
+    }
+    _rcl_timer_call_at(timers[i], now, &call_infos[i]);
+  }
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_timer_get_statistics(const rcl_timer_t * timer, rcl_timer_statistics_t * statistics)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  RCL_CHECK_ARGUMENT_FOR_NULL(statistics, RCL_RET_INVALID_ARGUMENT);
+  if (!timer->impl->statistics_enabled) {
+    RCL_SET_ERROR_MSG("timer statistics are not enabled");
+    return RCL_RET_ERROR;
+  }
+  *statistics = timer->impl->statistics;
+  if (statistics->call_count > 0u) {
+    statistics->mean_lateness =
+      timer->impl->total_lateness / (int64_t)statistics->call_count;
+  }
+  if (statistics->callback_count > 0u) {
+    statistics->mean_callback_duration =
+      timer->impl->total_callback_duration / (int64_t)statistics->callback_count;
+  }
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_timer_reset_statistics(rcl_timer_t * timer)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  if (!timer->impl->statistics_enabled) {
+    RCL_SET_ERROR_MSG("timer statistics are not enabled");
+    return RCL_RET_ERROR;
+  }
+  memset(&timer->impl->statistics, 0, sizeof(rcl_timer_statistics_t));
+  timer->impl->total_lateness = 0;
+  timer->impl->total_callback_duration = 0;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_timer_record_callback_duration(rcl_timer_t * timer, int64_t duration)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  if (duration < 0) {
+    RCL_SET_ERROR_MSG("callback duration must be non-negative");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  if (!timer->impl->statistics_enabled) {
+    RCL_SET_ERROR_MSG("timer statistics are not enabled");
+    return RCL_RET_ERROR;
+  }
+  rcl_timer_statistics_t * statistics = &timer->impl->statistics;
+  if (0u == statistics->callback_count || duration < statistics->min_callback_duration) {
+    statistics->min_callback_duration = duration;
+  }
+  if (0u == statistics->callback_count || duration > statistics->max_callback_duration) {
+    statistics->max_callback_duration = duration;
+  }
+  ++(statistics->callback_count);
+  timer->impl->total_callback_duration += duration;
   return RCL_RET_OK;
 }
 
@@ -362,6 +891,19 @@ rcl_timer_get_time_until_next_call(const rcl_timer_t * timer, int64_t * time_unt
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_timer_get_next_call_time(const rcl_timer_t * timer, int64_t * next_call_time)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  RCL_CHECK_ARGUMENT_FOR_NULL(next_call_time, RCL_RET_INVALID_ARGUMENT);
+  if (rcutils_atomic_load_bool(&timer->impl->canceled)) {
+    return RCL_RET_TIMER_CANCELED;
+  }
+  *next_call_time = rcutils_atomic_load_int64_t(&timer->impl->next_call_time);
+  return RCL_RET_OK;
+}
+
 rcl_ret_t
 rcl_timer_get_time_since_last_call(
   const rcl_timer_t * timer,
@@ -390,6 +932,16 @@ rcl_timer_get_period(const rcl_timer_t * timer, int64_t * period)
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_timer_get_slack(const rcl_timer_t * timer, int64_t * slack)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  RCL_CHECK_ARGUMENT_FOR_NULL(slack, RCL_RET_INVALID_ARGUMENT);
+  *slack = timer->impl->slack;
+  return RCL_RET_OK;
+}
+
 rcl_ret_t
 rcl_timer_exchange_period(const rcl_timer_t * timer, int64_t new_period, int64_t * old_period)
 {
@@ -461,7 +1013,17 @@ rcl_timer_reset(rcl_timer_t * timer)
   int64_t period = rcutils_atomic_load_int64_t(&timer->impl->period);
   rcutils_atomic_store(&timer->impl->next_call_time, now + period);
   rcutils_atomic_store(&timer->impl->canceled, false);
-  rcl_ret_t ret = rcl_trigger_guard_condition(&timer->impl->guard_condition);
+  rcl_timer_registry_t * registry = timer->impl->clock->timer_registry;
+  if (NULL != registry) {
+    // The new next call time may be earlier than the key of the timer in the registry.
+    rcutils_atomic_store(&registry->stale, true);
+  }
+  rcl_ret_t ret = rcl_trigger_guard_condition(_rcl_timer_guard_condition(timer->impl));
+  rcl_timer_engine_t * engine = rcl_timer_get_engine(timer);
+  if (NULL != engine) {
+    // The new deadline may be earlier than the one the engine is waiting for.
+    rcl_timer_engine_notify(engine);
+  }
 
   rcl_timer_on_reset_callback_data_t * cb_data = &timer->impl->callback_data;
 
@@ -489,10 +1051,14 @@ rcl_timer_get_allocator(const rcl_timer_t * timer)
 rcl_guard_condition_t *
 rcl_timer_get_guard_condition(const rcl_timer_t * timer)
 {
-  if (NULL == timer || NULL == timer->impl || NULL == timer->impl->guard_condition.impl) {
+  if (NULL == timer || NULL == timer->impl) {
     return NULL;
   }
-  return &timer->impl->guard_condition;
+  rcl_guard_condition_t * guard_condition = _rcl_timer_guard_condition(timer->impl);
+  if (NULL == guard_condition || NULL == guard_condition->impl) {
+    return NULL;
+  }
+  return guard_condition;
 }
 
 rcl_ret_t
@@ -520,6 +1086,18 @@ rcl_timer_set_on_reset_callback(
   return RCL_RET_OK;
 }
 
+void
+rcl_timer_set_engine(const rcl_timer_t * timer, rcl_timer_engine_t * engine)
+{
+  rcutils_atomic_store(&timer->impl->engine, (uintptr_t)engine);
+}
+
+rcl_timer_engine_t *
+rcl_timer_get_engine(const rcl_timer_t * timer)
+{
+  return (rcl_timer_engine_t *)rcutils_atomic_load_uintptr_t(&timer->impl->engine);
+}
+
 #ifdef __cplusplus
 }
 #endif
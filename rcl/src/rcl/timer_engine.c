@@ -0,0 +1,438 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "rcl/timer_engine.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+#include "rcl/error_handling.h"
+#include "rcutils/logging_macros.h"
+#include "rcutils/time.h"
+
+#include "./timer_impl.h"
+
+rcl_timer_engine_t
+rcl_get_zero_initialized_timer_engine()
+{
+  static rcl_timer_engine_t null_engine = {0};
+  return null_engine;
+}
+
+#ifdef __linux__
+
+// Indexes of the timer file descriptors, one per supported clock type.
+#define RCL_TIMER_ENGINE_STEADY 0
+#define RCL_TIMER_ENGINE_SYSTEM 1
+#define RCL_TIMER_ENGINE_NUM_CLOCKS 2
+
+typedef struct rcl_timer_engine_entry_s
+{
+  const rcl_timer_t * timer;
+  // One of RCL_TIMER_ENGINE_STEADY or RCL_TIMER_ENGINE_SYSTEM.
+  size_t clock_index;
+  // Next call time for which the guard condition was last triggered, so that
+  // it is triggered once per expiry even if the timer is not called right away.
+  int64_t triggered_call_time;
+} rcl_timer_engine_entry_t;
+
+struct rcl_timer_engine_impl_s
+{
+  rcl_allocator_t allocator;
+  // Protects the entries and the stop flag, which the thread reads.
+  pthread_mutex_t mutex;
+  rcl_timer_engine_entry_t * entries;
+  size_t num_entries;
+  size_t capacity;
+  bool stop;
+  pthread_t thread;
+  // Timers on CLOCK_MONOTONIC and CLOCK_REALTIME.
+  // CLOCK_REALTIME backs the rcutils system clock, so its deadlines are absolute.
+  // The rcutils steady clock may read CLOCK_MONOTONIC_RAW, which timerfd does
+  // not support and which drifts from CLOCK_MONOTONIC, so the steady deadlines
+  // are armed relative to the current steady time instead.
+  int timer_fds[RCL_TIMER_ENGINE_NUM_CLOCKS];
+  // Written to whenever the thread must read the deadlines again.
+  int wake_fd;
+};
+
+static void
+_rcl_timer_engine_close_fds(rcl_timer_engine_impl_t * impl)
+{
+  size_t i;
+  for (i = 0; i < RCL_TIMER_ENGINE_NUM_CLOCKS; ++i) {
+    if (impl->timer_fds[i] >= 0) {
+      close(impl->timer_fds[i]);
+      impl->timer_fds[i] = -1;
+    }
+  }
+  if (impl->wake_fd >= 0) {
+    close(impl->wake_fd);
+    impl->wake_fd = -1;
+  }
+}
+
+// Trigger the guard conditions of the expired timers and compute the earliest
+// deadline of the others, per clock.
+// Must be called with the mutex held.
+static void
+_rcl_timer_engine_trigger_expired(
+  rcl_timer_engine_impl_t * impl,
+  int64_t deadlines[RCL_TIMER_ENGINE_NUM_CLOCKS])
+{
+  rcutils_time_point_value_t now[RCL_TIMER_ENGINE_NUM_CLOCKS];
+  bool sampled[RCL_TIMER_ENGINE_NUM_CLOCKS] = {false, false};
+  size_t i;
+  for (i = 0; i < impl->num_entries; ++i) {
+    rcl_timer_engine_entry_t * entry = &impl->entries[i];
+    int64_t next_call_time = 0;
+    if (RCL_RET_OK != rcl_timer_get_next_call_time(entry->timer, &next_call_time)) {
+      continue;  // Canceled timers wake nobody, resetting them notifies the engine.
+    }
+    if (next_call_time == entry->triggered_call_time) {
+      continue;
+    }
+    const size_t k = entry->clock_index;
+    if (!sampled[k]) {
+      rcutils_ret_t ret = RCL_TIMER_ENGINE_STEADY == k ?
+        rcutils_steady_time_now(&now[k]) : rcutils_system_time_now(&now[k]);
+      if (RCUTILS_RET_OK != ret) {
+        RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Timer engine failed to get current time");
+        rcutils_reset_error();
+        continue;
+      }
+      sampled[k] = true;
+    }
+    if (next_call_time <= now[k]) {
+      rcl_guard_condition_t * guard_condition = rcl_timer_get_guard_condition(entry->timer);
+      if (RCL_RET_OK != rcl_trigger_guard_condition(guard_condition)) {
+        RCUTILS_LOG_ERROR_NAMED(
+          ROS_PACKAGE_NAME, "Timer engine failed to trigger timer guard condition");
+        rcl_reset_error();
+      }
+      entry->triggered_call_time = next_call_time;
+      continue;
+    }
+    // Waking up as late as the slack allows lets nearby deadlines share the wake up.
+    int64_t slack = 0;
+    if (RCL_RET_OK == rcl_timer_get_slack(entry->timer, &slack) && slack > 0) {
+      next_call_time = slack < INT64_MAX - next_call_time ? next_call_time + slack : INT64_MAX;
+    }
+    if (next_call_time < deadlines[k]) {
+      deadlines[k] = next_call_time;
+    }
+  }
+}
+
+// Arm the timerfd with an absolute value if flags has TFD_TIMER_ABSTIME,
+// otherwise with a value relative to now, or disarm it if the value is INT64_MAX.
+static void
+_rcl_timer_engine_arm(int fd, int flags, int64_t value)
+{
+  struct itimerspec spec;
+  memset(&spec, 0, sizeof(spec));
+  if (INT64_MAX != value) {
+    spec.it_value.tv_sec = (time_t)RCL_NS_TO_S(value);
+    spec.it_value.tv_nsec = (long)(value % (1000LL * 1000LL * 1000LL));
+    if (0 == spec.it_value.tv_sec && 0 == spec.it_value.tv_nsec) {
+      // An all zero value disarms the timer, but this deadline has passed anyway.
+      spec.it_value.tv_nsec = 1;
+    }
+  }
+  if (timerfd_settime(fd, flags, &spec, NULL) < 0) {
+    RCUTILS_LOG_ERROR_NAMED(
+      ROS_PACKAGE_NAME, "Timer engine failed to arm timerfd: %s", strerror(errno));
+  }
+}
+
+static void *
+_rcl_timer_engine_run(void * arg)
+{
+  rcl_timer_engine_impl_t * impl = (rcl_timer_engine_impl_t *)arg;
+  struct pollfd fds[1 + RCL_TIMER_ENGINE_NUM_CLOCKS];
+  fds[0].fd = impl->wake_fd;
+  fds[1].fd = impl->timer_fds[RCL_TIMER_ENGINE_STEADY];
+  fds[2].fd = impl->timer_fds[RCL_TIMER_ENGINE_SYSTEM];
+  size_t i;
+  for (i = 0; i < 1 + RCL_TIMER_ENGINE_NUM_CLOCKS; ++i) {
+    fds[i].events = POLLIN;
+  }
+  for (;;) {
+    int64_t deadlines[RCL_TIMER_ENGINE_NUM_CLOCKS] = {INT64_MAX, INT64_MAX};
+    pthread_mutex_lock(&impl->mutex);
+    if (impl->stop) {
+      pthread_mutex_unlock(&impl->mutex);
+      break;
+    }
+    _rcl_timer_engine_trigger_expired(impl, deadlines);
+    pthread_mutex_unlock(&impl->mutex);
+
+    int64_t steady_timeout = deadlines[RCL_TIMER_ENGINE_STEADY];
+    if (INT64_MAX != steady_timeout) {
+      rcutils_time_point_value_t now;
+      if (RCUTILS_RET_OK == rcutils_steady_time_now(&now)) {
+        steady_timeout = steady_timeout > now ? steady_timeout - now : 0;
+      } else {
+        RCUTILS_LOG_ERROR_NAMED(ROS_PACKAGE_NAME, "Timer engine failed to get current time");
+        rcutils_reset_error();
+        steady_timeout = RCL_MS_TO_NS(1);  // Try again soon.
+      }
+    }
+    _rcl_timer_engine_arm(impl->timer_fds[RCL_TIMER_ENGINE_STEADY], 0, steady_timeout);
+    // Setting the system clock cancels the wait, so deadlines are recomputed.
+    _rcl_timer_engine_arm(
+      impl->timer_fds[RCL_TIMER_ENGINE_SYSTEM], TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+      deadlines[RCL_TIMER_ENGINE_SYSTEM]);
+
+    if (poll(fds, 1 + RCL_TIMER_ENGINE_NUM_CLOCKS, -1) < 0) {
+      if (EINTR != errno) {
+        RCUTILS_LOG_ERROR_NAMED(
+          ROS_PACKAGE_NAME, "Timer engine failed to poll: %s", strerror(errno));
+      }
+      continue;
+    }
+    for (i = 0; i < 1 + RCL_TIMER_ENGINE_NUM_CLOCKS; ++i) {
+      if (fds[i].revents & POLLIN) {
+        // The value is irrelevant, reading only resets the descriptor.
+        uint64_t value;
+        ssize_t ret = read(fds[i].fd, &value, sizeof(value));
+        (void)ret;
+      }
+    }
+  }
+  return NULL;
+}
+
+void
+rcl_timer_engine_notify(rcl_timer_engine_t * engine)
+{
+  const uint64_t value = 1u;
+  ssize_t ret = write(engine->impl->wake_fd, &value, sizeof(value));
+  (void)ret;  // Only fails if the counter would overflow, so the engine is awake anyway.
+}
+
+rcl_ret_t
+rcl_timer_engine_init(rcl_timer_engine_t * engine, rcl_allocator_t allocator)
+{
+  RCL_CHECK_ALLOCATOR_WITH_MSG(&allocator, "invalid allocator", return RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(engine, RCL_RET_INVALID_ARGUMENT);
+  if (engine->impl) {
+    RCL_SET_ERROR_MSG("timer engine already initialized, or memory was uninitialized");
+    return RCL_RET_ALREADY_INIT;
+  }
+  rcl_timer_engine_impl_t * impl = (rcl_timer_engine_impl_t *)allocator.allocate(
+    sizeof(rcl_timer_engine_impl_t), allocator.state);
+  RCL_CHECK_FOR_NULL_WITH_MSG(impl, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+  memset(impl, 0, sizeof(rcl_timer_engine_impl_t));
+  impl->allocator = allocator;
+  impl->timer_fds[RCL_TIMER_ENGINE_STEADY] =
+    timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  impl->timer_fds[RCL_TIMER_ENGINE_SYSTEM] =
+    timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+  impl->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (
+    impl->timer_fds[RCL_TIMER_ENGINE_STEADY] < 0 ||
+    impl->timer_fds[RCL_TIMER_ENGINE_SYSTEM] < 0 ||
+    impl->wake_fd < 0)
+  {
+    RCL_SET_ERROR_MSG_WITH_FORMAT_STRING(
+      "failed to create timer engine file descriptors: %s", strerror(errno));
+    goto fail;
+  }
+  if (0 != pthread_mutex_init(&impl->mutex, NULL)) {
+    RCL_SET_ERROR_MSG("failed to initialize timer engine mutex");
+    goto fail;
+  }
+  engine->impl = impl;
+  if (0 != pthread_create(&impl->thread, NULL, _rcl_timer_engine_run, impl)) {
+    RCL_SET_ERROR_MSG("failed to start timer engine thread");
+    engine->impl = NULL;
+    pthread_mutex_destroy(&impl->mutex);
+    goto fail;
+  }
+  return RCL_RET_OK;
+fail:
+  _rcl_timer_engine_close_fds(impl);
+  allocator.deallocate(impl, allocator.state);
+  return RCL_RET_ERROR;
+}
+
+rcl_ret_t
+rcl_timer_engine_fini(rcl_timer_engine_t * engine)
+{
+  if (!engine || !engine->impl) {
+    return RCL_RET_OK;
+  }
+  rcl_timer_engine_impl_t * impl = engine->impl;
+  pthread_mutex_lock(&impl->mutex);
+  impl->stop = true;
+  pthread_mutex_unlock(&impl->mutex);
+  rcl_timer_engine_notify(engine);
+  rcl_ret_t result = RCL_RET_OK;
+  if (0 != pthread_join(impl->thread, NULL)) {
+    RCL_SET_ERROR_MSG("failed to join timer engine thread");
+    result = RCL_RET_ERROR;
+  }
+  size_t i;
+  for (i = 0; i < impl->num_entries; ++i) {
+    rcl_timer_set_engine(impl->entries[i].timer, NULL);
+  }
+  _rcl_timer_engine_close_fds(impl);
+  pthread_mutex_destroy(&impl->mutex);
+  impl->allocator.deallocate(impl->entries, impl->allocator.state);
+  impl->allocator.deallocate(impl, impl->allocator.state);
+  engine->impl = NULL;
+  return result;
+}
+
+rcl_ret_t
+rcl_timer_engine_add_timer(rcl_timer_engine_t * engine, const rcl_timer_t * timer)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(engine, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(engine->impl, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer->impl, RCL_RET_TIMER_INVALID);
+  rcl_clock_t * clock = NULL;
+  // rcl_timer_clock() does not modify the timer, it only lacks a const qualifier.
+  rcl_ret_t ret = rcl_timer_clock((rcl_timer_t *)timer, &clock);
+  if (RCL_RET_OK != ret) {
+    return ret;  // rcl error state should already be set.
+  }
+  if (rcl_clock_uses_tsc(clock)) {
+    // The engine waits on the kernel clocks, from which the calibrated time
+    // stamp counter drifts, so it could stop triggering a timer it deems due.
+    RCL_SET_ERROR_MSG("timer engines do not support clocks reading the time stamp counter");
+    return RCL_RET_UNSUPPORTED;
+  }
+  size_t clock_index;
+  if (RCL_STEADY_TIME == clock->type) {
+    clock_index = RCL_TIMER_ENGINE_STEADY;
+  } else if (RCL_SYSTEM_TIME == clock->type) {
+    clock_index = RCL_TIMER_ENGINE_SYSTEM;
+  } else {
+    RCL_SET_ERROR_MSG("timer engines only support steady and system time clocks");
+    return RCL_RET_UNSUPPORTED;
+  }
+  if (NULL != rcl_timer_get_engine(timer)) {
+    RCL_SET_ERROR_MSG("timer is already driven by an engine");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  rcl_timer_engine_impl_t * impl = engine->impl;
+  pthread_mutex_lock(&impl->mutex);
+  if (impl->num_entries == impl->capacity) {
+    size_t capacity = impl->capacity ? 2 * impl->capacity : 8u;
+    rcl_timer_engine_entry_t * entries = (rcl_timer_engine_entry_t *)impl->allocator.reallocate(
+      impl->entries, sizeof(rcl_timer_engine_entry_t) * capacity, impl->allocator.state);
+    if (NULL == entries) {
+      pthread_mutex_unlock(&impl->mutex);
+      RCL_SET_ERROR_MSG("allocating memory failed");
+      return RCL_RET_BAD_ALLOC;
+    }
+    impl->entries = entries;
+    impl->capacity = capacity;
+  }
+  rcl_timer_engine_entry_t * entry = &impl->entries[impl->num_entries++];
+  entry->timer = timer;
+  entry->clock_index = clock_index;
+  entry->triggered_call_time = INT64_MIN;
+  pthread_mutex_unlock(&impl->mutex);
+  rcl_timer_set_engine(timer, engine);
+  rcl_timer_engine_notify(engine);
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_timer_engine_remove_timer(rcl_timer_engine_t * engine, const rcl_timer_t * timer)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(engine, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(engine->impl, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(timer, RCL_RET_INVALID_ARGUMENT);
+  rcl_timer_engine_impl_t * impl = engine->impl;
+  pthread_mutex_lock(&impl->mutex);
+  size_t i;
+  for (i = 0; i < impl->num_entries; ++i) {
+    if (impl->entries[i].timer == timer) {
+      impl->entries[i] = impl->entries[--(impl->num_entries)];
+      pthread_mutex_unlock(&impl->mutex);
+      // Once unlocked, the thread no longer refers to the timer.
+      rcl_timer_set_engine(timer, NULL);
+      return RCL_RET_OK;
+    }
+  }
+  pthread_mutex_unlock(&impl->mutex);
+  RCL_SET_ERROR_MSG("timer is not driven by this engine");
+  return RCL_RET_NOT_FOUND;
+}
+
+#else  // __linux__
+
+void
+rcl_timer_engine_notify(rcl_timer_engine_t * engine)
+{
+  (void)engine;
+}
+
+rcl_ret_t
+rcl_timer_engine_init(rcl_timer_engine_t * engine, rcl_allocator_t allocator)
+{
+  (void)engine;
+  (void)allocator;
+  RCL_SET_ERROR_MSG("timer engines are only supported on Linux");
+  return RCL_RET_UNSUPPORTED;
+}
+
+rcl_ret_t
+rcl_timer_engine_fini(rcl_timer_engine_t * engine)
+{
+  (void)engine;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_timer_engine_add_timer(rcl_timer_engine_t * engine, const rcl_timer_t * timer)
+{
+  (void)engine;
+  (void)timer;
+  RCL_SET_ERROR_MSG("timer engines are only supported on Linux");
+  return RCL_RET_UNSUPPORTED;
+}
+
+rcl_ret_t
+rcl_timer_engine_remove_timer(rcl_timer_engine_t * engine, const rcl_timer_t * timer)
+{
+  (void)engine;
+  (void)timer;
+  RCL_SET_ERROR_MSG("timer engines are only supported on Linux");
+  return RCL_RET_UNSUPPORTED;
+}
+
+#endif  // __linux__
+
+#ifdef __cplusplus
+}
+#endif
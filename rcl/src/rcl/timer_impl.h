@@ -0,0 +1,54 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCL__TIMER_IMPL_H_
+#define RCL__TIMER_IMPL_H_
+
+#include "rcl/timer.h"
+#include "rcl/timer_engine.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/// Associate the timer with the engine driving it, or with none if `NULL`.
+RCL_LOCAL
+void
+rcl_timer_set_engine(const rcl_timer_t * timer, rcl_timer_engine_t * engine);
+
+/// Return the engine driving the timer, or `NULL` if there is none.
+RCL_LOCAL
+rcl_timer_engine_t *
+rcl_timer_get_engine(const rcl_timer_t * timer);
+
+/// Wake the engine up, so that it reads the deadlines of its timers again.
+RCL_LOCAL
+void
+rcl_timer_engine_notify(rcl_timer_engine_t * engine);
+
+/// Finalize the registry of the timers on the ROS time clock, if there is one.
+/**
+ * The registry is created by the first timer on the clock and outlives the
+ * timers, so it must be finalized along with the clock.
+ */
+RCL_LOCAL
+void
+rcl_timer_registry_fini(rcl_clock_t * clock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // RCL__TIMER_IMPL_H_
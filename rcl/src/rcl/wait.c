@@ -22,16 +22,37 @@ extern "C"
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
 #include "rcutils/logging_macros.h"
+#include "rcutils/time.h"
 #include "rmw/error_handling.h"
 #include "rmw/rmw.h"
 #include "rmw/event.h"
+#include "tracetools/tracetools.h"
 
+#include "./common.h"
 #include "./context_impl.h"
+#include "./guard_condition_impl.h"
+#include "./subscription_impl.h"
+#include "./timer_impl.h"
+
+// Sample of a timer clock, taken at most once per clock on each side of rmw_wait.
+typedef struct rcl_wait_set_clock_sample_s
+{
+  rcl_clock_t * clock;
+  rcl_time_point_value_t now;
+} rcl_wait_set_clock_sample_t;
+
+// Priority and deadline of an entity, see rcl_wait_set_set_priority().
+typedef struct rcl_wait_set_priority_s
+{
+  int32_t priority;
+  int64_t deadline;
+} rcl_wait_set_priority_t;
 
 struct rcl_wait_set_impl_s
 {
@@ -58,8 +79,64 @@ struct rcl_wait_set_impl_s
   rcl_context_t * context;
   // allocator used in the wait set
   rcl_allocator_t allocator;
+  // if true, members are kept across calls to rcl_wait and restored from the
+  // arrays below, which are only allocated in that case
+  bool persistent;
+  const rcl_subscription_t ** persistent_subscriptions;
+  void ** persistent_rmw_subscriptions;
+  const rcl_guard_condition_t ** persistent_guard_conditions;
+  void ** persistent_rmw_guard_conditions;
+  const rcl_timer_t ** persistent_timers;
+  // rmw handles of the timer guard conditions, which may be NULL
+  void ** persistent_rmw_timers;
+  const rcl_client_t ** persistent_clients;
+  void ** persistent_rmw_clients;
+  const rcl_service_t ** persistent_services;
+  void ** persistent_rmw_services;
+  const rcl_event_t ** persistent_events;
+  void ** persistent_rmw_events;
+  // if true, rcl_wait fills the ready lists of the wait set
+  bool ready_lists;
+  // clock samples shared by the timers, with room for one clock per timer
+  rcl_wait_set_clock_sample_t * clock_samples;
+  size_t clock_sample_count;
+  // if true, rcl_wait records the statistics below
+  bool statistics_enabled;
+  rcl_wait_set_statistics_t statistics;
+  // longest time to poll rmw_wait before blocking, spinning is disabled if 0
+  int64_t spin_budget;
+  bool adaptive_spin;
+  // moving average of the time spent waiting, used by the adaptive spin
+  int64_t average_wait_time;
+  // copy of the rmw arrays, restored after each poll which found nothing ready,
+  // allocated if spinning or virtual time stepping are enabled
+  void ** spin_snapshot;
+  // ROS time clock advanced to the next timer instead of sleeping, or NULL
+  rcl_clock_t * virtual_time_clock;
+  // if true, rcl_wait orders the ready entities by the priorities below,
+  // which are only allocated in that case
+  bool priorities;
+  rcl_wait_set_priority_t * subscription_priorities;
+  rcl_wait_set_priority_t * guard_condition_priorities;
+  rcl_wait_set_priority_t * timer_priorities;
+  rcl_wait_set_priority_t * client_priorities;
+  rcl_wait_set_priority_t * service_priorities;
+  rcl_wait_set_priority_t * event_priorities;
+  // ready entities of all kinds, with room for every entity of the wait set
+  rcl_wait_set_ready_entity_t * prioritized_ready;
+  size_t prioritized_ready_size;
 };
 
+static void
+__wait_set_reset_priorities(rcl_wait_set_priority_t * priorities, size_t count)
+{
+  size_t i;
+  for (i = 0; i < count; ++i) {
+    priorities[i].priority = RCL_WAIT_SET_DEFAULT_PRIORITY;
+    priorities[i].deadline = RCL_WAIT_SET_NO_DEADLINE;
+  }
+}
+
 rcl_wait_set_t
 rcl_get_zero_initialized_wait_set()
 {
@@ -76,11 +153,33 @@ rcl_get_zero_initialized_wait_set()
     .size_of_timers = 0,
     .events = NULL,
     .size_of_events = 0,
+    .ready_subscriptions = {.indices = NULL, .size = 0},
+    .ready_guard_conditions = {.indices = NULL, .size = 0},
+    .ready_timers = {.indices = NULL, .size = 0},
+    .ready_clients = {.indices = NULL, .size = 0},
+    .ready_services = {.indices = NULL, .size = 0},
+    .ready_events = {.indices = NULL, .size = 0},
     .impl = NULL,
   };
   return null_wait_set;
 }
 
+rcl_wait_set_options_t
+rcl_wait_set_get_default_options()
+{
+  // !!! MAKE SURE THAT CHANGES TO THESE DEFAULTS ARE REFLECTED IN THE HEADER DOC STRING
+  static rcl_wait_set_options_t default_options;
+  default_options.persistent = false;
+  default_options.ready_lists = false;
+  default_options.statistics = false;
+  default_options.spin_budget = 0;
+  default_options.adaptive_spin = false;
+  default_options.priorities = false;
+  default_options.virtual_time_clock = NULL;
+  default_options.allocator = rcl_get_default_allocator();
+  return default_options;
+}
+
 bool
 rcl_wait_set_is_valid(const rcl_wait_set_t * wait_set)
 {
@@ -110,6 +209,25 @@ rcl_wait_set_init(
   size_t number_of_events,
   rcl_context_t * context,
   rcl_allocator_t allocator)
+{
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.allocator = allocator;
+  return rcl_wait_set_init_with_options(
+    wait_set, number_of_subscriptions, number_of_guard_conditions, number_of_timers,
+    number_of_clients, number_of_services, number_of_events, context, &options);
+}
+
+rcl_ret_t
+rcl_wait_set_init_with_options(
+  rcl_wait_set_t * wait_set,
+  size_t number_of_subscriptions,
+  size_t number_of_guard_conditions,
+  size_t number_of_timers,
+  size_t number_of_clients,
+  size_t number_of_services,
+  size_t number_of_events,
+  rcl_context_t * context,
+  const rcl_wait_set_options_t * options)
 {
   RCUTILS_LOG_DEBUG_NAMED(
     ROS_PACKAGE_NAME, "Initializing wait set with "
@@ -118,6 +236,8 @@ rcl_wait_set_init(
     number_of_services);
   rcl_ret_t fail_ret = RCL_RET_ERROR;
 
+  RCL_CHECK_ARGUMENT_FOR_NULL(options, RCL_RET_INVALID_ARGUMENT);
+  rcl_allocator_t allocator = options->allocator;
   RCL_CHECK_ALLOCATOR_WITH_MSG(&allocator, "invalid allocator", return RCL_RET_INVALID_ARGUMENT);
   RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT);
   if (rcl_wait_set_is_valid(wait_set)) {
@@ -152,6 +272,23 @@ rcl_wait_set_init(
   wait_set->impl->context = context;
   // Set allocator.
   wait_set->impl->allocator = allocator;
+  wait_set->impl->persistent = options->persistent;
+  wait_set->impl->ready_lists = options->ready_lists;
+  wait_set->impl->statistics_enabled = options->statistics;
+  if (options->spin_budget < 0) {
+    RCL_SET_ERROR_MSG("spin budget must be non-negative");
+    fail_ret = RCL_RET_INVALID_ARGUMENT;
+    goto fail;
+  }
+  wait_set->impl->spin_budget = options->spin_budget;
+  wait_set->impl->adaptive_spin = options->adaptive_spin;
+  wait_set->impl->priorities = options->priorities;
+  if (NULL != options->virtual_time_clock && RCL_ROS_TIME != options->virtual_time_clock->type) {
+    RCL_SET_ERROR_MSG("virtual time clock must be of type RCL_ROS_TIME");
+    fail_ret = RCL_RET_INVALID_ARGUMENT;
+    goto fail;
+  }
+  wait_set->impl->virtual_time_clock = options->virtual_time_clock;
 
   size_t num_conditions =
     (2 * number_of_subscriptions) +
@@ -215,6 +352,199 @@ rcl_wait_set_get_allocator(const rcl_wait_set_t * wait_set, rcl_allocator_t * al
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_wait_set_get_statistics(
+  const rcl_wait_set_t * wait_set,
+  rcl_wait_set_statistics_t * statistics)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT);
+  if (!rcl_wait_set_is_valid(wait_set)) {
+    RCL_SET_ERROR_MSG("wait set is invalid");
+    return RCL_RET_WAIT_SET_INVALID;
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(statistics, RCL_RET_INVALID_ARGUMENT);
+  if (!wait_set->impl->statistics_enabled) {
+    RCL_SET_ERROR_MSG("wait set statistics are not enabled");
+    return RCL_RET_ERROR;
+  }
+  *statistics = wait_set->impl->statistics;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_reset_statistics(rcl_wait_set_t * wait_set)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT);
+  if (!rcl_wait_set_is_valid(wait_set)) {
+    RCL_SET_ERROR_MSG("wait set is invalid");
+    return RCL_RET_WAIT_SET_INVALID;
+  }
+  if (!wait_set->impl->statistics_enabled) {
+    RCL_SET_ERROR_MSG("wait set statistics are not enabled");
+    return RCL_RET_ERROR;
+  }
+  memset(&wait_set->impl->statistics, 0, sizeof(rcl_wait_set_statistics_t));
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_set_priority(
+  rcl_wait_set_t * wait_set,
+  rcl_wait_set_entity_type_t type,
+  size_t index,
+  int32_t priority,
+  int64_t deadline)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT);
+  if (!rcl_wait_set_is_valid(wait_set)) {
+    RCL_SET_ERROR_MSG("wait set is invalid");
+    return RCL_RET_WAIT_SET_INVALID;
+  }
+  if (!wait_set->impl->priorities) {
+    RCL_SET_ERROR_MSG("wait set priorities are not enabled");
+    return RCL_RET_ERROR;
+  }
+  rcl_wait_set_priority_t * priorities = NULL;
+  size_t count = 0u;
+  switch (type) {
+    case RCL_WAIT_SET_SUBSCRIPTION:
+      priorities = wait_set->impl->subscription_priorities;
+      count = wait_set->impl->subscription_index;
+      break;
+    case RCL_WAIT_SET_GUARD_CONDITION:
+      priorities = wait_set->impl->guard_condition_priorities;
+      count = wait_set->impl->guard_condition_index;
+      break;
+    case RCL_WAIT_SET_TIMER:
+      priorities = wait_set->impl->timer_priorities;
+      count = wait_set->impl->timer_index;
+      break;
+    case RCL_WAIT_SET_CLIENT:
+      priorities = wait_set->impl->client_priorities;
+      count = wait_set->impl->client_index;
+      break;
+    case RCL_WAIT_SET_SERVICE:
+      priorities = wait_set->impl->service_priorities;
+      count = wait_set->impl->service_index;
+      break;
+    case RCL_WAIT_SET_EVENT:
+      priorities = wait_set->impl->event_priorities;
+      count = wait_set->impl->event_index;
+      break;
+    default:
+      RCL_SET_ERROR_MSG("unknown entity type");
+      return RCL_RET_INVALID_ARGUMENT;
+  }
+  if (index >= count) {
+    RCL_SET_ERROR_MSG("no entity was added at the given index");
+    return RCL_RET_INVALID_ARGUMENT;
+  }
+  priorities[index].priority = priority;
+  priorities[index].deadline = deadline;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_get_prioritized_ready(
+  const rcl_wait_set_t * wait_set,
+  const rcl_wait_set_ready_entity_t ** entities,
+  size_t * count)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT);
+  if (!rcl_wait_set_is_valid(wait_set)) {
+    RCL_SET_ERROR_MSG("wait set is invalid");
+    return RCL_RET_WAIT_SET_INVALID;
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(entities, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(count, RCL_RET_INVALID_ARGUMENT);
+  if (!wait_set->impl->priorities) {
+    RCL_SET_ERROR_MSG("wait set priorities are not enabled");
+    return RCL_RET_ERROR;
+  }
+  *entities = wait_set->impl->prioritized_ready;
+  *count = wait_set->impl->prioritized_ready_size;
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_take_many(
+  const rcl_wait_set_t * wait_set,
+  void * const * ros_messages,
+  rmw_message_info_t * message_infos,
+  rcl_ret_t * results,
+  size_t * taken_count)
+{
+  RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT);
+  if (!rcl_wait_set_is_valid(wait_set)) {
+    RCL_SET_ERROR_MSG("wait set is invalid");
+    return RCL_RET_WAIT_SET_INVALID;
+  }
+  RCL_CHECK_ARGUMENT_FOR_NULL(ros_messages, RCL_RET_INVALID_ARGUMENT);
+  RCL_CHECK_ARGUMENT_FOR_NULL(results, RCL_RET_INVALID_ARGUMENT);
+  RCUTILS_LOG_DEBUG_NAMED(
+    ROS_PACKAGE_NAME, "Wait set taking from %zu subscriptions", wait_set->size_of_subscriptions);
+
+  // If message_infos is NULL, use a single place holder which can be discarded.
+  rmw_message_info_t dummy_message_info;
+  size_t taken_messages = 0u;
+  for (size_t i = 0u; i < wait_set->size_of_subscriptions; ++i) {
+    const rcl_subscription_t * subscription = wait_set->subscriptions[i];
+    if (!subscription) {
+      results[i] = RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+      continue;
+    }
+    if (!subscription->impl) {
+      RCL_SET_ERROR_MSG("subscription is invalid");
+      results[i] = RCL_RET_SUBSCRIPTION_INVALID;
+      continue;
+    }
+    if (!ros_messages[i]) {
+      RCL_SET_ERROR_MSG("ros message for a ready subscription is null");
+      results[i] = RCL_RET_INVALID_ARGUMENT;
+      continue;
+    }
+    rmw_message_info_t * message_info =
+      message_infos ? &message_infos[i] : &dummy_message_info;
+    bool taken = false;
+    size_t dropped = 0u;
+    rmw_ret_t ret = RMW_RET_OK;
+    do {
+      ret = rmw_take_with_info(
+        subscription->impl->rmw_handle, ros_messages[i], &taken, message_info, NULL);
+    } while (
+      RMW_RET_OK == ret && taken &&
+      (rcl_intra_process_was_delivered(subscription->impl, message_info) ||
+      !rcl_content_filter_accept(&subscription->impl->content_filter, ros_messages[i])) &&
+      ++dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE);
+    taken = taken && dropped < RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE;
+    if (0u != dropped) {
+      RCL_COUNTER_ADD(&subscription->impl->counters.dropped_count, dropped);
+    }
+    if (ret != RMW_RET_OK) {
+      RCL_SET_ERROR_MSG(rmw_get_error_string().str);
+      results[i] = rcl_convert_rmw_ret_to_rcl_ret(ret);
+      continue;
+    }
+    TRACETOOLS_TRACEPOINT(rcl_take, (const void *)ros_messages[i]);
+    if (!taken) {
+      RCL_COUNTER_ADD(&subscription->impl->counters.take_failed_count, 1u);
+      results[i] = RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+      continue;
+    }
+    RCL_COUNTER_ADD(&subscription->impl->counters.taken_count, 1u);
+    results[i] = RCL_RET_OK;
+    ++taken_messages;
+  }
+  RCUTILS_LOG_DEBUG_NAMED(ROS_PACKAGE_NAME, "Wait set took %zu messages", taken_messages);
+  if (taken_count) {
+    *taken_count = taken_messages;
+  }
+  if (0u == taken_messages) {
+    return RCL_RET_SUBSCRIPTION_TAKE_FAILED;
+  }
+  return RCL_RET_OK;
+}
+
 #define SET_ADD(Type) \
   RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT); \
   if (!wait_set->impl) { \
@@ -241,6 +571,63 @@ rcl_wait_set_get_allocator(const rcl_wait_set_t * wait_set, rcl_allocator_t * al
   wait_set->impl->RMWStorage[current_index] = rmw_handle->data; \
   wait_set->impl->RMWCount++;
 
+#define SET_ADD_PERSISTENT(Type, RMWHandle) \
+  /* Remember the member so that rcl_wait() can restore it. */ \
+  if (wait_set->impl->persistent) { \
+    wait_set->impl->persistent_ ## Type ## s[current_index] = Type; \
+    wait_set->impl->persistent_rmw_ ## Type ## s[current_index] = RMWHandle; \
+  }
+
+#define SET_REMOVE(Type) \
+  RCL_CHECK_ARGUMENT_FOR_NULL(wait_set, RCL_RET_INVALID_ARGUMENT); \
+  if (!wait_set->impl || !wait_set->impl->persistent) { \
+    RCL_SET_ERROR_MSG("wait set is invalid or not persistent"); \
+    return RCL_RET_WAIT_SET_INVALID; \
+  } \
+  RCL_CHECK_ARGUMENT_FOR_NULL(Type, RCL_RET_INVALID_ARGUMENT); \
+  size_t removed_index = 0u; \
+  while ( \
+    removed_index < wait_set->impl->Type ## _index && \
+    wait_set->impl->persistent_ ## Type ## s[removed_index] != Type) \
+  { \
+    ++removed_index; \
+  } \
+  if (removed_index == wait_set->impl->Type ## _index) { \
+    RCL_SET_ERROR_MSG(#Type " is not in the wait set"); \
+    return RCL_RET_NOT_FOUND; \
+  } \
+  /* Move the last member into the vacated slot to keep the members contiguous. */ \
+  size_t last_index = --(wait_set->impl->Type ## _index); \
+  wait_set->impl->persistent_ ## Type ## s[removed_index] = \
+    wait_set->impl->persistent_ ## Type ## s[last_index]; \
+  wait_set->impl->persistent_rmw_ ## Type ## s[removed_index] = \
+    wait_set->impl->persistent_rmw_ ## Type ## s[last_index]; \
+  wait_set->impl->persistent_ ## Type ## s[last_index] = NULL; \
+  wait_set->impl->persistent_rmw_ ## Type ## s[last_index] = NULL; \
+  if (NULL != wait_set->impl->Type ## _priorities) { \
+    wait_set->impl->Type ## _priorities[removed_index] = \
+      wait_set->impl->Type ## _priorities[last_index]; \
+    __wait_set_reset_priorities(&wait_set->impl->Type ## _priorities[last_index], 1u); \
+  } \
+  wait_set->Type ## s[removed_index] = NULL; \
+  wait_set->Type ## s[last_index] = NULL;
+
+#define SET_RESET_READINESS(Type, RMWStorage, RMWCount) \
+  do { \
+    size_t member_count = wait_set->impl->Type ## _index; \
+    if (member_count > 0u) { \
+      memcpy( \
+        (void *)wait_set->Type ## s, \
+        (void *)wait_set->impl->persistent_ ## Type ## s, \
+        sizeof(rcl_ ## Type ## _t *) * member_count); \
+      memcpy( \
+        wait_set->impl->RMWStorage, \
+        wait_set->impl->persistent_rmw_ ## Type ## s, \
+        sizeof(void *) * member_count); \
+    } \
+    wait_set->impl->RMWCount = member_count; \
+  } while (false)
+
 #define SET_CLEAR(Type) \
   do { \
     if (NULL != wait_set->Type ## s) { \
@@ -252,6 +639,20 @@ rcl_wait_set_get_allocator(const rcl_wait_set_t * wait_set, rcl_allocator_t * al
     } \
   } while (false)
 
+#define SET_CLEAR_PERSISTENT(Type) \
+  do { \
+    if (NULL != wait_set->impl->persistent_ ## Type ## s) { \
+      memset( \
+        (void *)wait_set->impl->persistent_ ## Type ## s, \
+        0, \
+        sizeof(rcl_ ## Type ## _t *) * wait_set->size_of_ ## Type ## s); \
+      memset( \
+        wait_set->impl->persistent_rmw_ ## Type ## s, \
+        0, \
+        sizeof(void *) * wait_set->size_of_ ## Type ## s); \
+    } \
+  } while (false)
+
 #define SET_CLEAR_RMW(Type, RMWStorage, RMWCount) \
   do { \
     if (NULL != wait_set->impl->RMWStorage) { \
@@ -309,6 +710,109 @@ rcl_wait_set_get_allocator(const rcl_wait_set_t * wait_set, rcl_allocator_t * al
   } \
   memset(wait_set->impl->RMWStorage, 0, sizeof(void *) * Type ## s_size);
 
+#define SET_RESIZE_PERSISTENT(Type) \
+  do { \
+    rcl_allocator_t allocator = wait_set->impl->allocator; \
+    if (0 == wait_set->size_of_ ## Type ## s) { \
+      if (wait_set->impl->persistent_ ## Type ## s) { \
+        allocator.deallocate((void *)wait_set->impl->persistent_ ## Type ## s, allocator.state); \
+        wait_set->impl->persistent_ ## Type ## s = NULL; \
+      } \
+      if (wait_set->impl->persistent_rmw_ ## Type ## s) { \
+        allocator.deallocate(wait_set->impl->persistent_rmw_ ## Type ## s, allocator.state); \
+        wait_set->impl->persistent_rmw_ ## Type ## s = NULL; \
+      } \
+    } else if (wait_set->impl->persistent) { \
+      const size_t new_size = wait_set->size_of_ ## Type ## s; \
+      const rcl_ ## Type ## _t ** members = (const rcl_ ## Type ## _t **)allocator.reallocate( \
+        (void *)wait_set->impl->persistent_ ## Type ## s, \
+        sizeof(rcl_ ## Type ## _t *) * new_size, allocator.state); \
+      RCL_CHECK_FOR_NULL_WITH_MSG( \
+        members, "allocating memory failed", return RCL_RET_BAD_ALLOC); \
+      memset((void *)members, 0, sizeof(rcl_ ## Type ## _t *) * new_size); \
+      wait_set->impl->persistent_ ## Type ## s = members; \
+      void ** rmw_members = (void **)allocator.reallocate( \
+        wait_set->impl->persistent_rmw_ ## Type ## s, sizeof(void *) * new_size, allocator.state); \
+      RCL_CHECK_FOR_NULL_WITH_MSG( \
+        rmw_members, "allocating memory failed", return RCL_RET_BAD_ALLOC); \
+      memset(rmw_members, 0, sizeof(void *) * new_size); \
+      wait_set->impl->persistent_rmw_ ## Type ## s = rmw_members; \
+    } \
+  } while (false)
+
+#define SET_RESIZE_READY(Type) \
+  do { \
+    rcl_allocator_t allocator = wait_set->impl->allocator; \
+    wait_set->ready_ ## Type ## s.size = 0u; \
+    if (0 == wait_set->size_of_ ## Type ## s) { \
+      if (wait_set->ready_ ## Type ## s.indices) { \
+        allocator.deallocate(wait_set->ready_ ## Type ## s.indices, allocator.state); \
+        wait_set->ready_ ## Type ## s.indices = NULL; \
+      } \
+    } else if (wait_set->impl->ready_lists) { \
+      size_t * indices = (size_t *)allocator.reallocate( \
+        wait_set->ready_ ## Type ## s.indices, \
+        sizeof(size_t) * wait_set->size_of_ ## Type ## s, allocator.state); \
+      RCL_CHECK_FOR_NULL_WITH_MSG( \
+        indices, "allocating memory failed", return RCL_RET_BAD_ALLOC); \
+      wait_set->ready_ ## Type ## s.indices = indices; \
+    } \
+  } while (false)
+
+#define SET_CLEAR_PRIORITIES(Type) \
+  do { \
+    if (NULL != wait_set->impl->Type ## _priorities) { \
+      __wait_set_reset_priorities( \
+        wait_set->impl->Type ## _priorities, wait_set->size_of_ ## Type ## s); \
+    } \
+  } while (false)
+
+#define SET_RESIZE_PRIORITIES(Type) \
+  do { \
+    rcl_allocator_t allocator = wait_set->impl->allocator; \
+    if (0 == wait_set->size_of_ ## Type ## s) { \
+      if (wait_set->impl->Type ## _priorities) { \
+        allocator.deallocate(wait_set->impl->Type ## _priorities, allocator.state); \
+        wait_set->impl->Type ## _priorities = NULL; \
+      } \
+    } else if (wait_set->impl->priorities) { \
+      rcl_wait_set_priority_t * priorities = (rcl_wait_set_priority_t *)allocator.reallocate( \
+        wait_set->impl->Type ## _priorities, \
+        sizeof(rcl_wait_set_priority_t) * wait_set->size_of_ ## Type ## s, allocator.state); \
+      RCL_CHECK_FOR_NULL_WITH_MSG( \
+        priorities, "allocating memory failed", return RCL_RET_BAD_ALLOC); \
+      __wait_set_reset_priorities(priorities, wait_set->size_of_ ## Type ## s); \
+      wait_set->impl->Type ## _priorities = priorities; \
+    } \
+  } while (false)
+
+#define SET_MARK_READY(Type, Index) \
+  if (wait_set->impl->ready_lists && NULL != wait_set->Type ## s[Index]) { \
+    wait_set->ready_ ## Type ## s.indices[wait_set->ready_ ## Type ## s.size++] = Index; \
+  }
+
+#define SET_MARK_PRIORITIZED(Type, EntityType, Index) \
+  if (wait_set->impl->priorities && NULL != wait_set->Type ## s[Index]) { \
+    rcl_wait_set_ready_entity_t * entity = \
+      &wait_set->impl->prioritized_ready[wait_set->impl->prioritized_ready_size++]; \
+    entity->type = EntityType; \
+    entity->index = Index; \
+    entity->priority = wait_set->impl->Type ## _priorities[Index].priority; \
+    entity->deadline = wait_set->impl->Type ## _priorities[Index].deadline; \
+  }
+
+static void
+__wait_set_clear_ready_lists(rcl_wait_set_t * wait_set)
+{
+  wait_set->ready_subscriptions.size = 0u;
+  wait_set->ready_guard_conditions.size = 0u;
+  wait_set->ready_timers.size = 0u;
+  wait_set->ready_clients.size = 0u;
+  wait_set->ready_services.size = 0u;
+  wait_set->ready_events.size = 0u;
+  wait_set->impl->prioritized_ready_size = 0u;
+}
+
 /* Implementation-specific notes:
  *
  * Add the rmw representation to the underlying rmw array and increment
@@ -322,6 +826,7 @@ rcl_wait_set_add_subscription(
 {
   SET_ADD(subscription)
   SET_ADD_RMW(subscription, rmw_subscriptions.subscribers, rmw_subscriptions.subscriber_count)
+  SET_ADD_PERSISTENT(subscription, rmw_handle->data)
   return RCL_RET_OK;
 }
 
@@ -343,6 +848,22 @@ rcl_wait_set_clear(rcl_wait_set_t * wait_set)
   SET_CLEAR(event);
   SET_CLEAR(timer);
 
+  SET_CLEAR_PERSISTENT(subscription);
+  SET_CLEAR_PERSISTENT(guard_condition);
+  SET_CLEAR_PERSISTENT(client);
+  SET_CLEAR_PERSISTENT(service);
+  SET_CLEAR_PERSISTENT(event);
+  SET_CLEAR_PERSISTENT(timer);
+
+  SET_CLEAR_PRIORITIES(subscription);
+  SET_CLEAR_PRIORITIES(guard_condition);
+  SET_CLEAR_PRIORITIES(client);
+  SET_CLEAR_PRIORITIES(service);
+  SET_CLEAR_PRIORITIES(event);
+  SET_CLEAR_PRIORITIES(timer);
+
+  __wait_set_clear_ready_lists(wait_set);
+
   SET_CLEAR_RMW(
     subscription,
     rmw_subscriptions.subscribers,
@@ -447,6 +968,86 @@ rcl_wait_set_resize(
       event, rmw_events.events, rmw_events.event_count)
   );
 
+  // Persistent membership is reset as well, matching the rest of the storage.
+  SET_RESIZE_PERSISTENT(subscription);
+  SET_RESIZE_PERSISTENT(guard_condition);
+  SET_RESIZE_PERSISTENT(timer);
+  SET_RESIZE_PERSISTENT(client);
+  SET_RESIZE_PERSISTENT(service);
+  SET_RESIZE_PERSISTENT(event);
+
+  SET_RESIZE_READY(subscription);
+  SET_RESIZE_READY(guard_condition);
+  SET_RESIZE_READY(timer);
+  SET_RESIZE_READY(client);
+  SET_RESIZE_READY(service);
+  SET_RESIZE_READY(event);
+
+  SET_RESIZE_PRIORITIES(subscription);
+  SET_RESIZE_PRIORITIES(guard_condition);
+  SET_RESIZE_PRIORITIES(timer);
+  SET_RESIZE_PRIORITIES(client);
+  SET_RESIZE_PRIORITIES(service);
+  SET_RESIZE_PRIORITIES(event);
+
+  wait_set->impl->prioritized_ready_size = 0u;
+  const size_t num_entities = subscriptions_size + guard_conditions_size + timers_size +
+    clients_size + services_size + events_size;
+  if (!wait_set->impl->priorities || 0u == num_entities) {
+    if (wait_set->impl->prioritized_ready) {
+      wait_set->impl->allocator.deallocate(
+        wait_set->impl->prioritized_ready, wait_set->impl->allocator.state);
+      wait_set->impl->prioritized_ready = NULL;
+    }
+  } else {
+    rcl_wait_set_ready_entity_t * prioritized_ready =
+      (rcl_wait_set_ready_entity_t *)wait_set->impl->allocator.reallocate(
+      wait_set->impl->prioritized_ready, sizeof(rcl_wait_set_ready_entity_t) * num_entities,
+      wait_set->impl->allocator.state);
+    RCL_CHECK_FOR_NULL_WITH_MSG(
+      prioritized_ready, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+    wait_set->impl->prioritized_ready = prioritized_ready;
+  }
+
+  // Each timer may have its own clock, so size the samples to the timers.
+  wait_set->impl->clock_sample_count = 0u;
+  if (0u == timers_size) {
+    if (wait_set->impl->clock_samples) {
+      wait_set->impl->allocator.deallocate(
+        wait_set->impl->clock_samples, wait_set->impl->allocator.state);
+      wait_set->impl->clock_samples = NULL;
+    }
+  } else {
+    rcl_wait_set_clock_sample_t * clock_samples =
+      (rcl_wait_set_clock_sample_t *)wait_set->impl->allocator.reallocate(
+      wait_set->impl->clock_samples, sizeof(rcl_wait_set_clock_sample_t) * timers_size,
+      wait_set->impl->allocator.state);
+    RCL_CHECK_FOR_NULL_WITH_MSG(
+      clock_samples, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+    wait_set->impl->clock_samples = clock_samples;
+  }
+
+  // The snapshot holds every rmw array, timer guard conditions included.
+  const size_t num_rmw_entities =
+    subscriptions_size + num_rmw_gc + clients_size + services_size + events_size;
+  if (
+    (0 == wait_set->impl->spin_budget && NULL == wait_set->impl->virtual_time_clock) ||
+    0u == num_rmw_entities)
+  {
+    if (wait_set->impl->spin_snapshot) {
+      wait_set->impl->allocator.deallocate(
+        wait_set->impl->spin_snapshot, wait_set->impl->allocator.state);
+      wait_set->impl->spin_snapshot = NULL;
+    }
+  } else {
+    void ** spin_snapshot = (void **)wait_set->impl->allocator.reallocate(
+      wait_set->impl->spin_snapshot, sizeof(void *) * num_rmw_entities,
+      wait_set->impl->allocator.state);
+    RCL_CHECK_FOR_NULL_WITH_MSG(
+      spin_snapshot, "allocating memory failed", return RCL_RET_BAD_ALLOC);
+    wait_set->impl->spin_snapshot = spin_snapshot;
+  }
+
   return RCL_RET_OK;
 }
 
@@ -460,6 +1061,7 @@ rcl_wait_set_add_guard_condition(
   SET_ADD_RMW(
     guard_condition, rmw_guard_conditions.guard_conditions,
     rmw_guard_conditions.guard_condition_count)
+  SET_ADD_PERSISTENT(guard_condition, rmw_handle->data)
 
   return RCL_RET_OK;
 }
@@ -472,6 +1074,7 @@ rcl_wait_set_add_timer(
 {
   SET_ADD(timer)
   // Add timer guard conditions to end of rmw guard condtion set.
+  void * rmw_timer_guard_condition = NULL;
   rcl_guard_condition_t * guard_condition = rcl_timer_get_guard_condition(timer);
   if (NULL != guard_condition) {
     // rcl_wait() will take care of moving these backwards and setting guard_condition_count.
@@ -480,7 +1083,9 @@ rcl_wait_set_add_timer(
     RCL_CHECK_FOR_NULL_WITH_MSG(
       rmw_handle, rcl_get_error_string().str, return RCL_RET_ERROR);
     wait_set->impl->rmw_guard_conditions.guard_conditions[index] = rmw_handle->data;
+    rmw_timer_guard_condition = rmw_handle->data;
   }
+  SET_ADD_PERSISTENT(timer, rmw_timer_guard_condition)
   return RCL_RET_OK;
 }
 
@@ -492,6 +1097,7 @@ rcl_wait_set_add_client(
 {
   SET_ADD(client)
   SET_ADD_RMW(client, rmw_clients.clients, rmw_clients.client_count)
+  SET_ADD_PERSISTENT(client, rmw_handle->data)
   return RCL_RET_OK;
 }
 
@@ -503,6 +1109,7 @@ rcl_wait_set_add_service(
 {
   SET_ADD(service)
   SET_ADD_RMW(service, rmw_services.services, rmw_services.service_count)
+  SET_ADD_PERSISTENT(service, rmw_handle->data)
   return RCL_RET_OK;
 }
 
@@ -515,9 +1122,341 @@ rcl_wait_set_add_event(
   SET_ADD(event)
   SET_ADD_RMW(event, rmw_events.events, rmw_events.event_count)
   wait_set->impl->rmw_events.events[current_index] = rmw_handle;
+  SET_ADD_PERSISTENT(event, rmw_handle)
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_remove_subscription(
+  rcl_wait_set_t * wait_set,
+  const rcl_subscription_t * subscription)
+{
+  SET_REMOVE(subscription)
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_remove_guard_condition(
+  rcl_wait_set_t * wait_set,
+  const rcl_guard_condition_t * guard_condition)
+{
+  SET_REMOVE(guard_condition)
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_remove_timer(
+  rcl_wait_set_t * wait_set,
+  const rcl_timer_t * timer)
+{
+  SET_REMOVE(timer)
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_wait_set_remove_client(
+  rcl_wait_set_t * wait_set,
+  const rcl_client_t * client)
+{
+  SET_REMOVE(client)
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_remove_service(
+  rcl_wait_set_t * wait_set,
+  const rcl_service_t * service)
+{
+  SET_REMOVE(service)
+  return RCL_RET_OK;
+}
+
+rcl_ret_t
+rcl_wait_set_remove_event(
+  rcl_wait_set_t * wait_set,
+  const rcl_event_t * event)
+{
+  SET_REMOVE(event)
+  return RCL_RET_OK;
+}
+
+// Restore the members of a persistent wait set, undoing the pruning done by
+// the previous rcl_wait() and rmw_wait() calls.
+static void
+__wait_set_reset_readiness(rcl_wait_set_t * wait_set)
+{
+  SET_RESET_READINESS(
+    subscription,
+    rmw_subscriptions.subscribers,
+    rmw_subscriptions.subscriber_count);
+  SET_RESET_READINESS(
+    guard_condition,
+    rmw_guard_conditions.guard_conditions,
+    rmw_guard_conditions.guard_condition_count);
+  SET_RESET_READINESS(
+    client,
+    rmw_clients.clients,
+    rmw_clients.client_count);
+  SET_RESET_READINESS(
+    service,
+    rmw_services.services,
+    rmw_services.service_count);
+  SET_RESET_READINESS(
+    event,
+    rmw_events.events,
+    rmw_events.event_count);
+  // Timer guard conditions are stored after the guard conditions, where
+  // rcl_wait_set_add_timer() would have placed them.
+  size_t timer_count = wait_set->impl->timer_index;
+  if (timer_count > 0u) {
+    memcpy(
+      (void *)wait_set->timers,
+      (void *)wait_set->impl->persistent_timers,
+      sizeof(rcl_timer_t *) * timer_count);
+    memcpy(
+      &(wait_set->impl->rmw_guard_conditions.guard_conditions[wait_set->size_of_guard_conditions]),
+      wait_set->impl->persistent_rmw_timers,
+      sizeof(void *) * timer_count);
+  }
+}
+
+static bool
+__timer_uses_clock_guard_condition(const rcl_timer_t * timer)
+{
+  rcl_clock_t * clock = NULL;
+  if (RCL_RET_OK != rcl_timer_clock((rcl_timer_t *)timer, &clock)) {
+    return false;
+  }
+  return NULL != clock->timer_guard_condition &&
+         rcl_timer_get_guard_condition(timer) == clock->timer_guard_condition;
+}
+
+// Whether the timer guard condition wakes the wait set once the timer is due,
+// so that the timer must not bound the rmw_wait timeout.
+static bool
+__timer_triggers_guard_condition_on_expiry(const rcl_timer_t * timer)
+{
+  if (NULL != rcl_timer_get_engine(timer)) {
+    return true;
+  }
+  rcl_clock_t * clock = NULL;
+  if (RCL_RET_OK != rcl_timer_clock((rcl_timer_t *)timer, &clock)) {
+    return false;
+  }
+  // While ROS time is active it only advances in rcl_set_ros_time_override(),
+  // whose jump callbacks trigger the guard conditions of the timers it makes due.
+  // A timeout would be measured in steady time instead, and wake spuriously.
+  bool ros_time_active = false;
+  return RCL_ROS_TIME == clock->type &&
+         RCL_RET_OK == rcl_is_enabled_ros_time_override(clock, &ros_time_active) &&
+         ros_time_active;
+}
+
+// Like rcl_timer_get_time_until_next_call(), but reads each clock only once
+// until the clock samples are reset.
+static rcl_ret_t
+__wait_set_time_until_next_call(
+  rcl_wait_set_t * wait_set,
+  const rcl_timer_t * timer,
+  int64_t * time_until_next_call)
+{
+  int64_t next_call_time = 0;
+  rcl_ret_t ret = rcl_timer_get_next_call_time(timer, &next_call_time);
+  if (ret != RCL_RET_OK) {
+    return ret;  // rcl error state should already be set, unless canceled.
+  }
+  rcl_clock_t * clock = NULL;
+  // rcl_timer_clock() does not modify the timer, it only lacks a const qualifier.
+  ret = rcl_timer_clock((rcl_timer_t *)timer, &clock);
+  if (ret != RCL_RET_OK) {
+    return ret;  // rcl error state should already be set.
+  }
+  rcl_wait_set_clock_sample_t * samples = wait_set->impl->clock_samples;
+  size_t i;
+  for (i = 0; i < wait_set->impl->clock_sample_count; ++i) {
+    if (samples[i].clock == clock) {
+      break;
+    }
+  }
+  if (i == wait_set->impl->clock_sample_count) {
+    ret = rcl_clock_get_now(clock, &samples[i].now);
+    if (ret != RCL_RET_OK) {
+      return ret;  // rcl error state should already be set.
+    }
+    samples[i].clock = clock;
+    ++(wait_set->impl->clock_sample_count);
+  }
+  *time_until_next_call = next_call_time - samples[i].now;
+  return RCL_RET_OK;
+}
+
+static void
+__wait_set_histogram_add(uint64_t * histogram, uint64_t value)
+{
+  size_t bucket = 0;
+  while (value > 0u && bucket < RCL_WAIT_SET_STATISTICS_HISTOGRAM_SIZE - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  ++histogram[bucket];
+}
+
+// Number of ready entities of each kind after one call to rmw_wait.
+typedef struct rcl_wait_set_ready_counts_s
+{
+  size_t subscriptions;
+  size_t guard_conditions;
+  size_t timers;
+  size_t clients;
+  size_t services;
+  size_t events;
+} rcl_wait_set_ready_counts_t;
+
+static void
+__wait_set_record_statistics(
+  rcl_wait_set_statistics_t * statistics,
+  const rcl_wait_set_ready_counts_t * ready,
+  bool timed_out,
+  rcutils_time_point_value_t start,
+  rcutils_time_point_value_t wait_start,
+  rcutils_time_point_value_t wait_end)
+{
+  rcutils_time_point_value_t end = wait_end;
+  if (RCUTILS_RET_OK != rcutils_steady_time_now(&end)) {
+    rcutils_reset_error();
+  }
+  const size_t ready_entities =
+    ready->subscriptions + ready->guard_conditions + ready->timers + ready->clients +
+    ready->services + ready->events;
+  ++(statistics->wait_count);
+  if (ready_entities > ready->timers) {
+    ++(statistics->entity_wakeups);
+  } else if (ready->timers > 0u) {
+    ++(statistics->timer_wakeups);
+  } else if (timed_out) {
+    ++(statistics->timeout_wakeups);
+  } else {
+    ++(statistics->spurious_wakeups);
+  }
+  statistics->ready_subscriptions += ready->subscriptions;
+  statistics->ready_guard_conditions += ready->guard_conditions;
+  statistics->ready_timers += ready->timers;
+  statistics->ready_clients += ready->clients;
+  statistics->ready_services += ready->services;
+  statistics->ready_events += ready->events;
+  const int64_t blocked_time = wait_end - wait_start;
+  const int64_t processing_time = (wait_start - start) + (end - wait_end);
+  statistics->blocked_time += blocked_time;
+  statistics->processing_time += processing_time;
+  __wait_set_histogram_add(
+    statistics->blocked_time_histogram, (uint64_t)RCUTILS_NS_TO_US(blocked_time));
+  __wait_set_histogram_add(
+    statistics->processing_time_histogram, (uint64_t)RCUTILS_NS_TO_US(processing_time));
+  __wait_set_histogram_add(statistics->ready_entities_histogram, ready_entities);
+}
+
+// Waiting consumes the triggers of the guard conditions, so the next trigger
+// of each of them must reach the middleware again once the wait returned.
+// Must run before the rcl handles which were not ready are set to NULL.
+static void
+__wait_set_update_pending_triggers(rcl_wait_set_t * wait_set, bool waited)
+{
+  void (* update)(const rcl_guard_condition_t *) =
+    waited ? rcl_guard_condition_finish_wait : rcl_guard_condition_begin_wait;
+  size_t i;
+  for (i = 0; i < wait_set->impl->guard_condition_index; ++i) {
+    update(wait_set->guard_conditions[i]);
+  }
+  for (i = 0; i < wait_set->impl->timer_index; ++i) {
+    if (NULL != wait_set->timers[i]) {
+      update(rcl_timer_get_guard_condition(wait_set->timers[i]));
+    }
+  }
+}
+
+// Order by decreasing priority, then increasing deadline, kind and index.
+static int
+__wait_set_compare_ready_entities(const void * lhs, const void * rhs)
+{
+  const rcl_wait_set_ready_entity_t * a = (const rcl_wait_set_ready_entity_t *)lhs;
+  const rcl_wait_set_ready_entity_t * b = (const rcl_wait_set_ready_entity_t *)rhs;
+  if (a->priority != b->priority) {
+    return a->priority > b->priority ? -1 : 1;
+  }
+  if (a->deadline != b->deadline) {
+    return a->deadline < b->deadline ? -1 : 1;
+  }
+  if (a->type != b->type) {
+    return a->type < b->type ? -1 : 1;
+  }
+  if (a->index != b->index) {
+    return a->index < b->index ? -1 : 1;
+  }
+  return 0;
+}
+
+static rmw_ret_t
+__wait_set_rmw_wait(rcl_wait_set_t * wait_set, const rmw_time_t * timeout_argument)
+{
+  return rmw_wait(
+    &wait_set->impl->rmw_subscriptions,
+    &wait_set->impl->rmw_guard_conditions,
+    &wait_set->impl->rmw_services,
+    &wait_set->impl->rmw_clients,
+    &wait_set->impl->rmw_events,
+    wait_set->impl->rmw_wait_set,
+    timeout_argument);
+}
+
+// Save the rmw arrays to the spin snapshot, or restore them from it.
+static void
+__wait_set_copy_spin_snapshot(rcl_wait_set_impl_t * impl, bool restore)
+{
+  void ** const arrays[] = {
+    impl->rmw_subscriptions.subscribers,
+    impl->rmw_guard_conditions.guard_conditions,
+    impl->rmw_clients.clients,
+    impl->rmw_services.services,
+    impl->rmw_events.events,
+  };
+  const size_t counts[] = {
+    impl->rmw_subscriptions.subscriber_count,
+    impl->rmw_guard_conditions.guard_condition_count,
+    impl->rmw_clients.client_count,
+    impl->rmw_services.service_count,
+    impl->rmw_events.event_count,
+  };
+  void ** snapshot = impl->spin_snapshot;
+  size_t i;
+  for (i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+    if (0u == counts[i]) {
+      continue;
+    }
+    if (restore) {
+      memcpy(arrays[i], snapshot, sizeof(void *) * counts[i]);
+    } else {
+      memcpy(snapshot, arrays[i], sizeof(void *) * counts[i]);
+    }
+    snapshot += counts[i];
+  }
+}
+
+static int64_t
+__wait_set_spin_budget(const rcl_wait_set_impl_t * impl)
+{
+  if (!impl->adaptive_spin) {
+    return impl->spin_budget;
+  }
+  const int64_t average = impl->average_wait_time;
+  if (average > impl->spin_budget) {
+    // Entities become ready too rarely for spinning to pay off.
+    return 0;
+  }
+  // Spin a little longer than the average, to also catch the slower wake ups.
+  const int64_t budget = average + average / 2;
+  return budget < impl->spin_budget ? budget : impl->spin_budget;
+}
+
 rcl_ret_t
 rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout)
 {
@@ -537,6 +1476,31 @@ rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout)
     RCL_SET_ERROR_MSG("wait set is empty");
     return RCL_RET_WAIT_SET_EMPTY;
   }
+  // The clock is only read if statistics or spinning are enabled.
+  const bool statistics_enabled = wait_set->impl->statistics_enabled;
+  const bool spin_enabled =
+    0 != wait_set->impl->spin_budget && NULL != wait_set->impl->spin_snapshot;
+  // Virtual time only replaces sleeping while the ROS time override is enabled.
+  rcl_clock_t * virtual_time_clock = wait_set->impl->virtual_time_clock;
+  bool virtual_time_active = false;
+  if (
+    NULL != virtual_time_clock &&
+    RCL_RET_OK != rcl_is_enabled_ros_time_override(virtual_time_clock, &virtual_time_active))
+  {
+    return RCL_RET_ERROR;  // The rcl error state should already be set.
+  }
+  int64_t virtual_deadline = INT64_MAX;
+  bool timer_ready = false;
+  rcutils_time_point_value_t start = 0;
+  rcutils_time_point_value_t wait_start = 0;
+  rcutils_time_point_value_t wait_end = 0;
+  if (statistics_enabled && RCUTILS_RET_OK != rcutils_steady_time_now(&start)) {
+    rcutils_reset_error();
+  }
+  if (wait_set->impl->persistent) {
+    __wait_set_reset_readiness(wait_set);
+  }
+  __wait_set_clear_ready_lists(wait_set);
   // Calculate the timeout argument.
   // By default, set the timer to block indefinitely if none of the below conditions are met.
   rmw_time_t * timeout_argument = NULL;
@@ -544,7 +1508,10 @@ rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout)
 
   bool is_timer_timeout = false;
   int64_t min_timeout = timeout > 0 ? timeout : INT64_MAX;
+  wait_set->impl->clock_sample_count = 0u;
   {  // scope to prevent i from colliding below
+    const size_t first_timer_gc = wait_set->impl->rmw_guard_conditions.guard_condition_count;
+    size_t num_shared_gcs = 0;
     uint64_t i = 0;
     for (i = 0; i < wait_set->impl->timer_index; ++i) {
       if (!wait_set->timers[i]) {
@@ -552,23 +1519,62 @@ rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout)
       }
       rmw_guard_conditions_t * rmw_gcs = &(wait_set->impl->rmw_guard_conditions);
       size_t gc_idx = wait_set->size_of_guard_conditions + i;
-      if (NULL != rmw_gcs->guard_conditions[gc_idx]) {
+      void * rmw_gc = rmw_gcs->guard_conditions[gc_idx];
+      if (NULL != rmw_gc && __timer_uses_clock_guard_condition(wait_set->timers[i])) {
+        // Shared guard conditions must only be waited on once, so they are kept
+        // in front of the other timer guard conditions, where they are few.
+        size_t j = 0;
+        while (j < num_shared_gcs && rmw_gcs->guard_conditions[first_timer_gc + j] != rmw_gc) {
+          ++j;
+        }
+        if (j == num_shared_gcs) {
+          rmw_gcs->guard_conditions[rmw_gcs->guard_condition_count] =
+            rmw_gcs->guard_conditions[first_timer_gc + num_shared_gcs];
+          rmw_gcs->guard_conditions[first_timer_gc + num_shared_gcs] = rmw_gc;
+          ++num_shared_gcs;
+          ++(rmw_gcs->guard_condition_count);
+        }
+      } else if (NULL != rmw_gc) {
         // This timer has a guard condition, so move it to make a legal wait set.
-        rmw_gcs->guard_conditions[rmw_gcs->guard_condition_count] =
-          rmw_gcs->guard_conditions[gc_idx];
+        rmw_gcs->guard_conditions[rmw_gcs->guard_condition_count] = rmw_gc;
         ++(rmw_gcs->guard_condition_count);
       }
       // use timer time to to set the rmw_wait timeout
-      // TODO(sloretz) fix spurious wake-ups on ROS_TIME timers with ROS_TIME enabled
       int64_t timer_timeout = INT64_MAX;
-      rcl_ret_t ret = rcl_timer_get_time_until_next_call(wait_set->timers[i], &timer_timeout);
+      rcl_ret_t ret = __wait_set_time_until_next_call(
+        wait_set, wait_set->timers[i], &timer_timeout);
       if (ret == RCL_RET_TIMER_CANCELED) {
-        wait_set->timers[i] = NULL;
+        // Its guard condition is waited on, so it is set to NULL after the wait.
         continue;
       }
       if (ret != RCL_RET_OK) {
         return ret;  // The rcl error state should already be set.
       }
+      if (timer_timeout <= 0) {
+        timer_ready = true;
+      } else if (virtual_time_active) {
+        rcl_clock_t * clock = NULL;
+        int64_t next_call_time = 0;
+        if (
+          RCL_RET_OK == rcl_timer_clock((rcl_timer_t *)wait_set->timers[i], &clock) &&
+          clock == virtual_time_clock &&
+          RCL_RET_OK == rcl_timer_get_next_call_time(wait_set->timers[i], &next_call_time) &&
+          next_call_time < virtual_deadline)
+        {
+          virtual_deadline = next_call_time;
+        }
+      }
+      if (timer_timeout > 0 && __timer_triggers_guard_condition_on_expiry(wait_set->timers[i])) {
+        continue;
+      }
+      // Waking up as late as the slack allows lets nearby deadlines share the wake up.
+      int64_t slack = 0;
+      if (
+        timer_timeout > 0 &&
+        RCL_RET_OK == rcl_timer_get_slack(wait_set->timers[i], &slack) && slack > 0)
+      {
+        timer_timeout = slack < INT64_MAX - timer_timeout ? timer_timeout + slack : INT64_MAX;
+      }
       if (timer_timeout < min_timeout) {
         is_timer_timeout = true;
         min_timeout = timer_timeout;
@@ -592,32 +1598,118 @@ rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout)
   }
 
   // Wait.
-  rmw_ret_t ret = rmw_wait(
-    &wait_set->impl->rmw_subscriptions,
-    &wait_set->impl->rmw_guard_conditions,
-    &wait_set->impl->rmw_services,
-    &wait_set->impl->rmw_clients,
-    &wait_set->impl->rmw_events,
-    wait_set->impl->rmw_wait_set,
-    timeout_argument);
+  __wait_set_update_pending_triggers(wait_set, false);
+  if (
+    (statistics_enabled || spin_enabled) &&
+    RCUTILS_RET_OK != rcutils_steady_time_now(&wait_start))
+  {
+    rcutils_reset_error();
+  }
+  rmw_ret_t ret = RMW_RET_TIMEOUT;
+  bool spun_until_ready = false;
+  if (INT64_MAX != virtual_deadline && !timer_ready && timeout != 0) {
+    // Only advance virtual time if nothing is ready yet.
+    if (NULL != wait_set->impl->spin_snapshot) {
+      const rmw_time_t zero_timeout = {0, 0};
+      __wait_set_copy_spin_snapshot(wait_set->impl, false);
+      ret = __wait_set_rmw_wait(wait_set, &zero_timeout);
+    }
+    if (RMW_RET_TIMEOUT != ret) {
+      spun_until_ready = true;
+    } else {
+      if (NULL != wait_set->impl->spin_snapshot) {
+        __wait_set_copy_spin_snapshot(wait_set->impl, true);
+      }
+      rcl_ret_t step_ret = rcl_set_ros_time_override(virtual_time_clock, virtual_deadline);
+      if (RCL_RET_OK != step_ret) {
+        return step_ret;  // The rcl error state should already be set.
+      }
+      // The timers due at the new time are ready, so the wait below only
+      // collects their guard conditions and whatever else became ready.
+      is_timer_timeout = true;
+      min_timeout = 0;
+      temporary_timeout_storage.sec = 0;
+      temporary_timeout_storage.nsec = 0;
+      timeout_argument = &temporary_timeout_storage;
+    }
+  }
+  int64_t spin_budget = 0;
+  if (spin_enabled && timeout != 0 && !spun_until_ready) {
+    spin_budget = __wait_set_spin_budget(wait_set->impl);
+    if (NULL != timeout_argument && min_timeout < spin_budget) {
+      spin_budget = min_timeout;
+    }
+  }
+  if (spin_budget > 0) {
+    // Poll without blocking, restoring the entities rmw_wait() set to NULL each time.
+    const rmw_time_t zero_timeout = {0, 0};
+    rcutils_time_point_value_t now = wait_start;
+    __wait_set_copy_spin_snapshot(wait_set->impl, false);
+    do {
+      ret = __wait_set_rmw_wait(wait_set, &zero_timeout);
+      if (RMW_RET_TIMEOUT != ret) {
+        spun_until_ready = true;
+        break;
+      }
+      __wait_set_copy_spin_snapshot(wait_set->impl, true);
+      if (RCUTILS_RET_OK != rcutils_steady_time_now(&now)) {
+        rcutils_reset_error();
+        break;
+      }
+    } while (now - wait_start < spin_budget);
+    if (!spun_until_ready && NULL != timeout_argument) {
+      // Only block for what is left of the timeout.
+      int64_t remaining = min_timeout - (now - wait_start);
+      if (remaining < 0) {
+        remaining = 0;
+      }
+      temporary_timeout_storage.sec = RCL_NS_TO_S(remaining);
+      temporary_timeout_storage.nsec = remaining % 1000000000;
+    }
+  }
+  if (!spun_until_ready) {
+    ret = __wait_set_rmw_wait(wait_set, timeout_argument);
+  }
+  __wait_set_update_pending_triggers(wait_set, true);
+  if (
+    (statistics_enabled || spin_enabled) &&
+    RCUTILS_RET_OK != rcutils_steady_time_now(&wait_end))
+  {
+    rcutils_reset_error();
+  }
+  if (spin_enabled && wait_set->impl->adaptive_spin && timeout != 0) {
+    wait_set->impl->average_wait_time +=
+      ((wait_end - wait_start) - wait_set->impl->average_wait_time) / 8;
+  }
 
   // Items that are not ready will have been set to NULL by rmw_wait.
   // We now update our handles accordingly.
 
   // Check for ready timers
   // and set not ready timers (which includes canceled timers) to NULL.
+  // The clocks are sampled again, since time has passed while waiting.
+  wait_set->impl->clock_sample_count = 0u;
+  rcl_wait_set_ready_counts_t ready = {0, 0, 0, 0, 0, 0};
   size_t i;
   for (i = 0; i < wait_set->impl->timer_index; ++i) {
     if (!wait_set->timers[i]) {
       continue;
     }
+    int64_t time_until_next_call = 0;
+    rcl_ret_t ret = __wait_set_time_until_next_call(
+      wait_set, wait_set->timers[i], &time_until_next_call);
     bool is_ready = false;
-    rcl_ret_t ret = rcl_timer_is_ready(wait_set->timers[i], &is_ready);
-    if (ret != RCL_RET_OK) {
+    if (ret == RCL_RET_OK) {
+      is_ready = (time_until_next_call <= 0);
+    } else if (ret != RCL_RET_TIMER_CANCELED) {
       return ret;  // The rcl error state should already be set.
     }
     if (!is_ready) {
       wait_set->timers[i] = NULL;
+    } else {
+      SET_MARK_READY(timer, i)
+      SET_MARK_PRIORITIZED(timer, RCL_WAIT_SET_TIMER, i)
+      ++(ready.timers);
     }
   }
   // Check for timeout, return RCL_RET_TIMEOUT only if it wasn't a timer.
@@ -626,47 +1718,95 @@ rcl_wait(rcl_wait_set_t * wait_set, int64_t timeout)
     return RCL_RET_ERROR;
   }
   // Set corresponding rcl subscription handles NULL.
-  for (i = 0; i < wait_set->size_of_subscriptions; ++i) {
+  // Slots past the number of added entities are already NULL.
+  for (i = 0; i < wait_set->impl->subscription_index; ++i) {
     bool is_ready = wait_set->impl->rmw_subscriptions.subscribers[i] != NULL;
     if (!is_ready) {
       wait_set->subscriptions[i] = NULL;
+    } else {
+      SET_MARK_READY(subscription, i)
+      SET_MARK_PRIORITIZED(subscription, RCL_WAIT_SET_SUBSCRIPTION, i)
+      ++(ready.subscriptions);
     }
   }
   // Set corresponding rcl guard_condition handles NULL.
-  for (i = 0; i < wait_set->size_of_guard_conditions; ++i) {
+  for (i = 0; i < wait_set->impl->guard_condition_index; ++i) {
     bool is_ready = wait_set->impl->rmw_guard_conditions.guard_conditions[i] != NULL;
     if (!is_ready) {
       wait_set->guard_conditions[i] = NULL;
+    } else {
+      SET_MARK_READY(guard_condition, i)
+      SET_MARK_PRIORITIZED(guard_condition, RCL_WAIT_SET_GUARD_CONDITION, i)
+      ++(ready.guard_conditions);
     }
   }
   // Set corresponding rcl client handles NULL.
-  for (i = 0; i < wait_set->size_of_clients; ++i) {
+  for (i = 0; i < wait_set->impl->client_index; ++i) {
     bool is_ready = wait_set->impl->rmw_clients.clients[i] != NULL;
     if (!is_ready) {
       wait_set->clients[i] = NULL;
+    } else {
+      SET_MARK_READY(client, i)
+      SET_MARK_PRIORITIZED(client, RCL_WAIT_SET_CLIENT, i)
+      ++(ready.clients);
     }
   }
   // Set corresponding rcl service handles NULL.
-  for (i = 0; i < wait_set->size_of_services; ++i) {
+  for (i = 0; i < wait_set->impl->service_index; ++i) {
     bool is_ready = wait_set->impl->rmw_services.services[i] != NULL;
     if (!is_ready) {
       wait_set->services[i] = NULL;
+    } else {
+      SET_MARK_READY(service, i)
+      SET_MARK_PRIORITIZED(service, RCL_WAIT_SET_SERVICE, i)
+      ++(ready.services);
     }
   }
   // Set corresponding rcl event handles NULL.
-  for (i = 0; i < wait_set->size_of_events; ++i) {
+  for (i = 0; i < wait_set->impl->event_index; ++i) {
     bool is_ready = wait_set->impl->rmw_events.events[i] != NULL;
     if (!is_ready) {
       wait_set->events[i] = NULL;
+    } else {
+      SET_MARK_READY(event, i)
+      SET_MARK_PRIORITIZED(event, RCL_WAIT_SET_EVENT, i)
+      ++(ready.events);
     }
   }
 
-  if (RMW_RET_TIMEOUT == ret && !is_timer_timeout) {
+  if (wait_set->impl->prioritized_ready_size > 1u) {
+    qsort(
+      wait_set->impl->prioritized_ready, wait_set->impl->prioritized_ready_size,
+      sizeof(rcl_wait_set_ready_entity_t), __wait_set_compare_ready_entities);
+  }
+
+  const bool timed_out = RMW_RET_TIMEOUT == ret && !is_timer_timeout;
+  if (statistics_enabled) {
+    __wait_set_record_statistics(
+      &wait_set->impl->statistics, &ready, timed_out, start, wait_start, wait_end);
+  }
+  if (timed_out) {
     return RCL_RET_TIMEOUT;
   }
   return RCL_RET_OK;
 }
 
+rcl_ret_t
+rcl_wait_until(rcl_wait_set_t * wait_set, rcl_time_point_value_t deadline)
+{
+  if (deadline < 0) {
+    return rcl_wait(wait_set, -1);
+  }
+  rcutils_time_point_value_t now;
+  if (RCUTILS_RET_OK != rcutils_steady_time_now(&now)) {
+    rcutils_error_string_t error = rcutils_get_error_string();
+    rcutils_reset_error();
+    RCL_SET_ERROR_MSG(error.str);
+    return RCL_RET_ERROR;
+  }
+  return rcl_wait(wait_set, deadline > now ? deadline - now : 0);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,72 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rcl/error_handling.h"
+#include "rcl/time.h"
+
+#include "rcutils/macros.h"
+
+using performance_test_fixture::PerformanceTest;
+
+namespace
+{
+void sample_clock(benchmark::State & st, rcl_clock_t * clock)
+{
+  rcl_time_point_value_t now = 0;
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    if (RCL_RET_OK != rcl_clock_get_now(clock, &now)) {
+      st.SkipWithError(rcl_get_error_string().str);
+      rcl_reset_error();
+      break;
+    }
+    benchmark::DoNotOptimize(now);
+  }
+}
+}  // namespace
+
+BENCHMARK_F(PerformanceTest, steady_clock_get_now)(benchmark::State & st)
+{
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_clock_t clock;
+  if (RCL_RET_OK != rcl_steady_clock_init(&clock, &allocator)) {
+    st.SkipWithError(rcl_get_error_string().str);
+    rcl_reset_error();
+    return;
+  }
+  reset_heap_counters();
+  sample_clock(st, &clock);
+  if (RCL_RET_OK != rcl_steady_clock_fini(&clock)) {
+    rcl_reset_error();
+  }
+}
+
+BENCHMARK_F(PerformanceTest, fast_steady_clock_get_now)(benchmark::State & st)
+{
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_clock_t clock;
+  if (RCL_RET_OK != rcl_fast_steady_clock_init(&clock, &allocator)) {
+    st.SkipWithError(rcl_get_error_string().str);
+    rcl_reset_error();
+    return;
+  }
+  st.SetLabel(rcl_clock_uses_tsc(&clock) ? "tsc" : "clock_gettime");
+  reset_heap_counters();
+  sample_clock(st, &clock);
+  if (RCL_RET_OK != rcl_steady_clock_fini(&clock)) {
+    rcl_reset_error();
+  }
+}
@@ -0,0 +1,135 @@
+// Copyright 2023 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <stdexcept>
+#include <string>
+
+#include "performance_test_fixture/performance_test_fixture.hpp"
+
+#include "rcl/error_handling.h"
+#include "rcl/rcl.h"
+
+#include "rcutils/macros.h"
+
+#include "test_msgs/msg/basic_types.h"
+
+using performance_test_fixture::PerformanceTest;
+
+namespace
+{
+constexpr size_t kSubscriptionCount = 16;
+
+void throw_on_error(rcl_ret_t ret)
+{
+  if (RCL_RET_OK != ret) {
+    std::string message = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error(message);
+  }
+}
+}  // namespace
+
+// Nothing is published, so every take comes back empty and each benchmark
+// measures the per subscription overhead of rcl around rmw_take_with_info().
+class TakePerformanceTest : public PerformanceTest
+{
+public:
+  void SetUp(benchmark::State & st) override
+  {
+    rcl_init_options_t init_options = rcl_get_zero_initialized_init_options();
+    throw_on_error(rcl_init_options_init(&init_options, rcl_get_default_allocator()));
+    context = rcl_get_zero_initialized_context();
+    rcl_ret_t ret = rcl_init(0, nullptr, &init_options, &context);
+    throw_on_error(rcl_init_options_fini(&init_options));
+    throw_on_error(ret);
+
+    node = rcl_get_zero_initialized_node();
+    rcl_node_options_t node_options = rcl_node_get_default_options();
+    throw_on_error(rcl_node_init(&node, "benchmark_take_node", "", &context, &node_options));
+
+    const rosidl_message_type_support_t * ts =
+      ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes);
+    throw_on_error(
+      rcl_wait_set_init(
+        &wait_set, kSubscriptionCount, 0, 0, 0, 0, 0, &context, rcl_get_default_allocator()));
+    for (size_t i = 0; i < kSubscriptionCount; ++i) {
+      std::string topic = "benchmark_take_" + std::to_string(i);
+      subscriptions[i] = rcl_get_zero_initialized_subscription();
+      rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+      throw_on_error(
+        rcl_subscription_init(
+          &subscriptions[i], &node, ts, topic.c_str(), &subscription_options));
+      throw_on_error(rcl_wait_set_add_subscription(&wait_set, &subscriptions[i], nullptr));
+      test_msgs__msg__BasicTypes__init(&messages[i]);
+      ros_messages[i] = &messages[i];
+    }
+
+    PerformanceTest::SetUp(st);
+  }
+
+  void TearDown(benchmark::State & st) override
+  {
+    PerformanceTest::TearDown(st);
+
+    for (size_t i = 0; i < kSubscriptionCount; ++i) {
+      test_msgs__msg__BasicTypes__fini(&messages[i]);
+      throw_on_error(rcl_subscription_fini(&subscriptions[i], &node));
+    }
+    throw_on_error(rcl_wait_set_fini(&wait_set));
+    throw_on_error(rcl_node_fini(&node));
+    throw_on_error(rcl_shutdown(&context));
+    throw_on_error(rcl_context_fini(&context));
+  }
+
+protected:
+  rcl_context_t context;
+  rcl_node_t node;
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_subscription_t subscriptions[kSubscriptionCount];
+  test_msgs__msg__BasicTypes messages[kSubscriptionCount];
+  void * ros_messages[kSubscriptionCount];
+  rmw_message_info_t message_infos[kSubscriptionCount];
+  rcl_ret_t results[kSubscriptionCount];
+};
+
+BENCHMARK_F(TakePerformanceTest, take_each)(benchmark::State & st)
+{
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    for (size_t i = 0; i < kSubscriptionCount; ++i) {
+      rcl_ret_t ret = rcl_take(
+        wait_set.subscriptions[i], ros_messages[i], &message_infos[i], nullptr);
+      if (RCL_RET_SUBSCRIPTION_TAKE_FAILED != ret) {
+        st.SkipWithError(rcl_get_error_string().str);
+        rcl_reset_error();
+        return;
+      }
+    }
+  }
+  st.SetItemsProcessed(st.iterations() * kSubscriptionCount);
+}
+
+BENCHMARK_F(TakePerformanceTest, take_many)(benchmark::State & st)
+{
+  for (auto _ : st) {
+    RCUTILS_UNUSED(_);
+    rcl_ret_t ret = rcl_take_many(&wait_set, ros_messages, message_infos, results, nullptr);
+    if (RCL_RET_SUBSCRIPTION_TAKE_FAILED != ret) {
+      st.SkipWithError(rcl_get_error_string().str);
+      rcl_reset_error();
+      return;
+    }
+  }
+  st.SetItemsProcessed(st.iterations() * kSubscriptionCount);
+}
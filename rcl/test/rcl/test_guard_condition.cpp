@@ -18,6 +18,7 @@
 
 #include "rcl/rcl.h"
 #include "rcl/guard_condition.h"
+#include "rcl/wait.h"
 
 #include "./failing_allocator_functions.hpp"
 #include "osrf_testing_tools_cpp/memory_tools/memory_tools.hpp"
@@ -241,3 +242,129 @@ TEST_F(TestGuardConditionFixture, test_rcl_guard_condition_bad_arg) {
   EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_trigger_guard_condition(&zero_guard_condition));
   rcl_reset_error();
 }
+
+/* Tests that triggers are only forwarded to the middleware once per wait.
+ */
+TEST_F(TestGuardConditionFixture, test_rcl_guard_condition_coalesced_triggers) {
+  rcl_init_options_t init_options = rcl_get_zero_initialized_init_options();
+  rcl_ret_t ret = rcl_init_options_init(&init_options, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ASSERT_EQ(RCL_RET_OK, rcl_init_options_fini(&init_options));
+  });
+  rcl_context_t context = rcl_get_zero_initialized_context();
+  ret = rcl_init(0, nullptr, &init_options, &context);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ASSERT_EQ(RCL_RET_OK, rcl_shutdown(&context));
+    ASSERT_EQ(RCL_RET_OK, rcl_context_fini(&context));
+  });
+  rcl_guard_condition_t guard_condition = rcl_get_zero_initialized_guard_condition();
+  ret = rcl_guard_condition_init(
+    &guard_condition, &context, rcl_guard_condition_get_default_options());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_guard_condition_fini(&guard_condition));
+  });
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(&wait_set, 0, 1, 0, 0, 0, 0, &context, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));
+  });
+
+  size_t rmw_triggers = 0u;
+  {
+    auto mock = mocking_utils::patch(
+      "lib:rcl", rmw_trigger_guard_condition, [&](auto) {
+        ++rmw_triggers;
+        return RMW_RET_OK;
+      });
+    EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+    EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+    EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+    EXPECT_EQ(1u, rmw_triggers);
+
+    // Waiting on the guard condition makes the next trigger reach the middleware again.
+    ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ret = rcl_wait(&wait_set, 0);
+    EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+    EXPECT_EQ(2u, rmw_triggers);
+  }
+
+  // A failed trigger is not remembered as pending.
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, 0);
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rcl", rmw_trigger_guard_condition, RMW_RET_ERROR);
+    EXPECT_EQ(RCL_RET_ERROR, rcl_trigger_guard_condition(&guard_condition));
+    rcl_reset_error();
+  }
+
+  // Repeated triggers still wake up exactly one wait.
+  EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+  EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(100));
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(&guard_condition, wait_set.guard_conditions[0]);
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+
+  // A trigger after a wait wakes up the next wait.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+    ret = rcl_wait_set_clear(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ret = rcl_wait(&wait_set, RCL_MS_TO_NS(100));
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(&guard_condition, wait_set.guard_conditions[0]);
+  }
+
+  // A trigger coalesced after the middleware consumed the forwarded one is not lost.
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rcl", rmw_trigger_guard_condition, RMW_RET_OK);
+    EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+  }
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  {
+    auto mock = mocking_utils::patch(
+      "lib:rcl", rmw_wait, [&](auto, auto, auto, auto, auto, auto, auto) {
+        EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+        return RMW_RET_OK;
+      });
+    ret = rcl_wait(&wait_set, RCL_MS_TO_NS(100));
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(100));
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(&guard_condition, wait_set.guard_conditions[0]);
+}
@@ -14,6 +14,8 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+
 #include "rcl/publisher.h"
 
 #include "rcl/rcl.h"
@@ -769,6 +771,142 @@ TEST_F(TestPublisherFixtureInit, test_mock_publish_serialized_message)
   }
 }
 
+// Publishing a batch reports a result per message and keeps going after a failure
+TEST_F(TestPublisherFixtureInit, test_publish_batch) {
+  test_msgs__msg__BasicTypes msgs[3];
+  for (size_t i = 0; i < 3; ++i) {
+    test_msgs__msg__BasicTypes__init(&msgs[i]);
+    msgs[i].int64_value = static_cast<int64_t>(i);
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 3; ++i) {
+      test_msgs__msg__BasicTypes__fini(&msgs[i]);
+    }
+  });
+  const void * ros_messages[3] = {&msgs[0], &msgs[1], &msgs[2]};
+  rcl_ret_t results[3] = {RCL_RET_ERROR, RCL_RET_ERROR, RCL_RET_ERROR};
+
+  rcl_publisher_t publisher_zero_init = rcl_get_zero_initialized_publisher();
+  EXPECT_EQ(
+    RCL_RET_PUBLISHER_INVALID,
+    rcl_publish_batch(&publisher_zero_init, ros_messages, 3, results, nullptr));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_publish_batch(&publisher, nullptr, 3, results, nullptr));
+  rcl_reset_error();
+
+  EXPECT_EQ(RCL_RET_OK, rcl_publish_batch(&publisher, ros_messages, 0, nullptr, nullptr));
+  rcl_ret_t ret = rcl_publish_batch(&publisher, ros_messages, 3, results, nullptr);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(RCL_RET_OK, results[i]);
+  }
+
+  ros_messages[1] = nullptr;
+  ret = rcl_publish_batch(&publisher, ros_messages, 3, results, nullptr);
+  EXPECT_EQ(RCL_RET_ERROR, ret);
+  EXPECT_TRUE(rcl_error_is_set());
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_OK, results[0]);
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, results[1]);
+  EXPECT_EQ(RCL_RET_OK, results[2]);
+
+  // The error of the first failing message is reported, once.
+  ros_messages[2] = nullptr;
+  ret = rcl_publish_batch(&publisher, ros_messages, 3, results, nullptr);
+  EXPECT_EQ(RCL_RET_ERROR, ret);
+  const std::string error = rcl_get_error_string().str;
+  rcl_reset_error();
+  EXPECT_EQ(0u, error.find("ros message in batch is null"));
+  EXPECT_EQ(std::string::npos, error.find("ros message in batch is null", 1u));
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, results[1]);
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, results[2]);
+
+  rcl_serialized_message_t serialized_msgs[2];
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  for (size_t i = 0; i < 2; ++i) {
+    serialized_msgs[i] = rmw_get_zero_initialized_serialized_message();
+    ASSERT_EQ(RMW_RET_OK, rmw_serialized_message_init(&serialized_msgs[i], 0u, &allocator));
+    ASSERT_EQ(RMW_RET_OK, rmw_serialize(&msgs[i], ts, &serialized_msgs[i]));
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 2; ++i) {
+      EXPECT_EQ(RMW_RET_OK, rmw_serialized_message_fini(&serialized_msgs[i]));
+    }
+  });
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_publish_serialized_batch(&publisher, nullptr, 2, results, nullptr));
+  rcl_reset_error();
+  ret = rcl_publish_serialized_batch(&publisher, serialized_msgs, 2, results, nullptr);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_OK, results[0]);
+  EXPECT_EQ(RCL_RET_OK, results[1]);
+
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rcl", rmw_publish_serialized_message, RMW_RET_BAD_ALLOC);
+    ret = rcl_publish_serialized_batch(&publisher, serialized_msgs, 2, results, nullptr);
+    EXPECT_EQ(RCL_RET_BAD_ALLOC, ret);
+    EXPECT_TRUE(rcl_error_is_set());
+    rcl_reset_error();
+    EXPECT_EQ(RCL_RET_BAD_ALLOC, results[0]);
+    EXPECT_EQ(RCL_RET_BAD_ALLOC, results[1]);
+  }
+}
+
+// Publishing counts messages, serialized bytes and errors
+TEST_F(TestPublisherFixtureInit, test_publisher_statistics) {
+  rcl_publisher_statistics_t statistics;
+  rcl_publisher_t publisher_zero_init = rcl_get_zero_initialized_publisher();
+  EXPECT_EQ(
+    RCL_RET_PUBLISHER_INVALID, rcl_publisher_get_statistics(&publisher_zero_init, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_publisher_get_statistics(&publisher, nullptr));
+  rcl_reset_error();
+
+  rcl_ret_t ret = rcl_publisher_get_statistics(&publisher, &statistics);
+  if (RCL_RET_UNSUPPORTED == ret) {
+    rcl_reset_error();
+    GTEST_SKIP() << "rcl was built without statistics";
+  }
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, statistics.published_count);
+  EXPECT_EQ(0u, statistics.published_serialized_bytes);
+  EXPECT_EQ(0u, statistics.publish_error_count);
+  EXPECT_EQ(0u, statistics.loaned_message_count);
+
+  test_msgs__msg__BasicTypes msg;
+  test_msgs__msg__BasicTypes__init(&msg);
+  rcl_serialized_message_t serialized_msg = rmw_get_zero_initialized_serialized_message();
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  ASSERT_EQ(RMW_RET_OK, rmw_serialized_message_init(&serialized_msg, 0u, &allocator));
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    test_msgs__msg__BasicTypes__fini(&msg);
+    EXPECT_EQ(RMW_RET_OK, rmw_serialized_message_fini(&serialized_msg));
+  });
+  ASSERT_EQ(RMW_RET_OK, rmw_serialize(&msg, ts, &serialized_msg));
+
+  EXPECT_EQ(RCL_RET_OK, rcl_publish(&publisher, &msg, nullptr)) << rcl_get_error_string().str;
+  const void * ros_messages[2] = {&msg, &msg};
+  EXPECT_EQ(RCL_RET_OK, rcl_publish_batch(&publisher, ros_messages, 2, nullptr, nullptr));
+  EXPECT_EQ(RCL_RET_OK, rcl_publish_serialized_message(&publisher, &serialized_msg, nullptr));
+  {
+    auto mock = mocking_utils::patch_and_return("lib:rcl", rmw_publish, RMW_RET_ERROR);
+    EXPECT_EQ(RCL_RET_ERROR, rcl_publish(&publisher, &msg, nullptr));
+    rcl_reset_error();
+  }
+
+  ASSERT_EQ(RCL_RET_OK, rcl_publisher_get_statistics(&publisher, &statistics));
+  EXPECT_EQ(4u, statistics.published_count);
+  EXPECT_EQ(serialized_msg.buffer_length, statistics.published_serialized_bytes);
+  EXPECT_EQ(1u, statistics.publish_error_count);
+  EXPECT_EQ(0u, statistics.loaned_message_count);
+}
+
 // Define dummy comparison operators for rcutils_allocator_t type for use with the Mimick Library
 MOCKING_UTILS_BOOL_OPERATOR_RETURNS_FALSE(rcutils_allocator_t, ==)
 MOCKING_UTILS_BOOL_OPERATOR_RETURNS_FALSE(rcutils_allocator_t, <)
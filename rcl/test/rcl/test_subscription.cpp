@@ -17,6 +17,7 @@
 #include <chrono>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "rcl/subscription.h"
 #include "rcl/rcl.h"
@@ -550,6 +551,562 @@ TEST_F(TestSubscriptionFixture, test_subscription_nominal_string_sequence) {
   }
 }
 
+/* Test taking from all the ready subscriptions of a wait set at once.
+ */
+TEST_F(TestSubscriptionFixture, test_subscription_take_many) {
+  rcl_ret_t ret;
+  rcl_publisher_t publisher = rcl_get_zero_initialized_publisher();
+  const rosidl_message_type_support_t * ts =
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes);
+  constexpr char topic[] = "rcl_test_subscription_take_many_chatter";
+  constexpr char quiet_topic[] = "rcl_test_subscription_take_many_quiet";
+  rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+  ret = rcl_publisher_init(&publisher, this->node_ptr, ts, topic, &publisher_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_publisher_fini(&publisher, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  // Two subscriptions receive the published message, the third one stays quiet.
+  rcl_subscription_t subscriptions[3];
+  const char * topics[3] = {topic, topic, quiet_topic};
+  for (size_t i = 0; i < 3; ++i) {
+    subscriptions[i] = rcl_get_zero_initialized_subscription();
+    rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+    ret = rcl_subscription_init(
+      &subscriptions[i], this->node_ptr, ts, topics[i], &subscription_options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 3; ++i) {
+      rcl_ret_t ret = rcl_subscription_fini(&subscriptions[i], this->node_ptr);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  });
+  ASSERT_TRUE(wait_for_established_subscription(&publisher, 10, 100));
+  {
+    test_msgs__msg__BasicTypes msg;
+    test_msgs__msg__BasicTypes__init(&msg);
+    msg.int64_value = 42;
+    ret = rcl_publish(&publisher, &msg, nullptr);
+    test_msgs__msg__BasicTypes__fini(&msg);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscriptions[0], context_ptr, 10, 100));
+  ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscriptions[1], context_ptr, 10, 100));
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(
+    &wait_set, 3, 0, 0, 0, 0, 0, context_ptr, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  for (size_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_subscription(&wait_set, &subscriptions[i], nullptr));
+  }
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(100));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+
+  test_msgs__msg__BasicTypes msgs[3];
+  void * ros_messages[3];
+  for (size_t i = 0; i < 3; ++i) {
+    test_msgs__msg__BasicTypes__init(&msgs[i]);
+    ros_messages[i] = &msgs[i];
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 3; ++i) {
+      test_msgs__msg__BasicTypes__fini(&msgs[i]);
+    }
+  });
+  rmw_message_info_t message_infos[3];
+  rcl_ret_t results[3];
+  size_t taken_count = 0u;
+
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_take_many(nullptr, ros_messages, message_infos, results, &taken_count));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_take_many(&wait_set, nullptr, message_infos, results, &taken_count));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_take_many(&wait_set, ros_messages, message_infos, nullptr, &taken_count));
+  rcl_reset_error();
+
+  ret = rcl_take_many(&wait_set, ros_messages, message_infos, results, &taken_count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(2u, taken_count);
+  EXPECT_EQ(RCL_RET_OK, results[0]);
+  EXPECT_EQ(RCL_RET_OK, results[1]);
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, results[2]);
+  EXPECT_EQ(42, msgs[0].int64_value);
+  EXPECT_EQ(42, msgs[1].int64_value);
+  EXPECT_EQ(0, msgs[2].int64_value);
+
+  // Everything was taken, so a second batch comes back empty.
+  ret = rcl_take_many(&wait_set, ros_messages, nullptr, results, &taken_count);
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, ret);
+  EXPECT_EQ(0u, taken_count);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, results[i]);
+  }
+}
+
+/* Test taking serialized messages into the pool of a subscription.
+ */
+TEST_F(TestSubscriptionFixture, test_subscription_serialized_sequence) {
+  using namespace std::chrono_literals;
+  rcl_ret_t ret;
+  rcl_publisher_t publisher = rcl_get_zero_initialized_publisher();
+  const rosidl_message_type_support_t * ts =
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, Strings);
+  constexpr char topic[] = "rcl_test_subscription_serialized_sequence_chatter";
+  rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+  ret = rcl_publisher_init(&publisher, this->node_ptr, ts, topic, &publisher_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_publisher_fini(&publisher, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  constexpr size_t pool_size = 4u;
+  constexpr size_t capacity = 64u;
+  rcl_subscription_t subscription = rcl_get_zero_initialized_subscription();
+  rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+  EXPECT_EQ(0u, subscription_options.serialized_message_pool_size);
+  EXPECT_EQ(0u, subscription_options.serialized_message_capacity);
+  subscription_options.serialized_message_pool_size = pool_size;
+  subscription_options.serialized_message_capacity = capacity;
+  ret = rcl_subscription_init(&subscription, this->node_ptr, ts, topic, &subscription_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_subscription_fini(&subscription, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  // A subscription without a pool has nothing to lend.
+  {
+    rcl_subscription_t no_pool_subscription = rcl_get_zero_initialized_subscription();
+    rcl_subscription_options_t no_pool_options = rcl_subscription_get_default_options();
+    ret = rcl_subscription_init(
+      &no_pool_subscription, this->node_ptr, ts, topic, &no_pool_options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    rcl_serialized_message_t * serialized_message = nullptr;
+    EXPECT_EQ(
+      RCL_RET_ERROR,
+      rcl_subscription_borrow_serialized_message(&no_pool_subscription, &serialized_message));
+    rcl_reset_error();
+    ret = rcl_subscription_fini(&no_pool_subscription, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+
+  ASSERT_TRUE(wait_for_established_subscription(&publisher, 10, 100));
+  constexpr char test_string[] = "testing";
+  {
+    test_msgs__msg__Strings msg;
+    test_msgs__msg__Strings__init(&msg);
+    ASSERT_TRUE(rosidl_runtime_c__String__assign(&msg.string_value, test_string));
+    for (size_t i = 0; i < 3; ++i) {
+      ret = rcl_publish(&publisher, &msg, nullptr);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+    test_msgs__msg__Strings__fini(&msg);
+  }
+
+  auto allocator = rcutils_get_default_allocator();
+  rmw_message_info_sequence_t message_infos;
+  ASSERT_EQ(RMW_RET_OK, rmw_message_info_sequence_init(&message_infos, 5, &allocator));
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rmw_message_info_sequence_fini(&message_infos);
+  });
+  rcl_serialized_message_t * serialized_messages[pool_size] = {};
+
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_take_serialized_sequence(&subscription, 5, nullptr, &message_infos, nullptr));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_take_serialized_sequence(&subscription, 6, serialized_messages, &message_infos, nullptr));
+  rcl_reset_error();
+
+  auto start = std::chrono::steady_clock::now();
+  size_t total_messages_taken = 0u;
+  do {
+    // `wait_for_subscription_to_be_ready` only ensures there's one message ready,
+    // so we need to loop to guarantee that we get the three published messages.
+    ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 1, 100));
+    ret = rcl_take_serialized_sequence(
+      &subscription, 5, &serialized_messages[total_messages_taken], &message_infos, nullptr);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    total_messages_taken += message_infos.size;
+  } while (total_messages_taken < 3 && std::chrono::steady_clock::now() < start + 10s);
+  ASSERT_EQ(3u, total_messages_taken);
+
+  for (size_t i = 0; i < total_messages_taken; ++i) {
+    ASSERT_NE(nullptr, serialized_messages[i]);
+    EXPECT_LT(0u, serialized_messages[i]->buffer_length);
+    test_msgs__msg__Strings msg;
+    test_msgs__msg__Strings__init(&msg);
+    ASSERT_EQ(RMW_RET_OK, rmw_deserialize(serialized_messages[i], ts, &msg));
+    EXPECT_EQ(
+      std::string(test_string), std::string(msg.string_value.data, msg.string_value.size));
+    test_msgs__msg__Strings__fini(&msg);
+  }
+
+  // Only one pooled message is left, and once it is borrowed the pool is exhausted.
+  ret = rcl_subscription_borrow_serialized_message(&subscription, &serialized_messages[3]);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_LE(capacity, serialized_messages[3]->buffer_capacity);
+  rcl_serialized_message_t * serialized_message = nullptr;
+  EXPECT_EQ(
+    RCL_RET_ERROR,
+    rcl_subscription_borrow_serialized_message(&subscription, &serialized_message));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_ERROR,
+    rcl_take_serialized_sequence(&subscription, 1, serialized_messages, &message_infos, nullptr));
+  rcl_reset_error();
+
+  for (size_t i = 0; i < pool_size; ++i) {
+    ret = rcl_subscription_return_serialized_message(&subscription, serialized_messages[i]);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(0u, serialized_messages[i]->buffer_length);
+    EXPECT_LE(capacity, serialized_messages[i]->buffer_capacity);
+  }
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_subscription_return_serialized_message(&subscription, serialized_messages[0]));
+  rcl_reset_error();
+  rcl_serialized_message_t foreign_message = rmw_get_zero_initialized_serialized_message();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_subscription_return_serialized_message(&subscription, &foreign_message));
+  rcl_reset_error();
+
+  // Nothing is left to take.
+  ret = rcl_take_serialized_sequence(
+    &subscription, 5, serialized_messages, &message_infos, nullptr);
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, message_infos.size);
+
+  // A take failing after another one succeeded hands out the message taken,
+  // and leaves no error behind.
+  {
+    size_t take_count = 0u;
+    auto mock = mocking_utils::patch(
+      "lib:rcl", rmw_take_serialized_message_with_info,
+      [&](auto, rcl_serialized_message_t * serialized_message, bool * taken, auto...) {
+        if (take_count++ > 0u) {
+          return RMW_RET_ERROR;
+        }
+        serialized_message->buffer_length = 1u;
+        *taken = true;
+        return RMW_RET_OK;
+      });
+    ret = rcl_take_serialized_sequence(
+      &subscription, 2, serialized_messages, &message_infos, nullptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(1u, message_infos.size);
+    EXPECT_FALSE(rcl_error_is_set());
+  }
+  ret = rcl_subscription_return_serialized_message(&subscription, serialized_messages[0]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+}
+
+static void
+delete_basic_types(void * ros_message, void * state)
+{
+  test_msgs__msg__BasicTypes__destroy(static_cast<test_msgs__msg__BasicTypes *>(ros_message));
+  ++*static_cast<size_t *>(state);
+}
+
+/* Test delivering shared messages to subscriptions of the same context.
+ */
+TEST_F(TestSubscriptionFixture, test_subscription_intra_process) {
+  using namespace std::chrono_literals;
+  rcl_ret_t ret;
+  const rosidl_message_type_support_t * ts =
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes);
+  constexpr char topic[] = "rcl_test_subscription_intra_process_chatter";
+  size_t deleted_count = 0u;
+
+  rcl_publisher_t publisher = rcl_get_zero_initialized_publisher();
+  rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+  EXPECT_FALSE(publisher_options.enable_intra_process);
+  publisher_options.enable_intra_process = true;
+  ret = rcl_publisher_init(&publisher, this->node_ptr, ts, topic, &publisher_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_publisher_fini(&publisher, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  // Two intra-process subscriptions with different depths, and one which only
+  // receives messages through the middleware.
+  rcl_subscription_t subscriptions[3];
+  const size_t depths[3] = {10u, 2u, 10u};
+  const bool intra_process[3] = {true, true, false};
+  for (size_t i = 0; i < 3; ++i) {
+    subscriptions[i] = rcl_get_zero_initialized_subscription();
+    rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+    EXPECT_FALSE(subscription_options.enable_intra_process);
+    subscription_options.qos.depth = depths[i];
+    subscription_options.enable_intra_process = intra_process[i];
+    ret = rcl_subscription_init(
+      &subscriptions[i], this->node_ptr, ts, topic, &subscription_options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 3; ++i) {
+      rcl_ret_t ret = rcl_subscription_fini(&subscriptions[i], this->node_ptr);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  });
+  EXPECT_NE(nullptr, rcl_subscription_get_intra_process_guard_condition(&subscriptions[0]));
+  EXPECT_EQ(nullptr, rcl_subscription_get_intra_process_guard_condition(&subscriptions[2]));
+  rcl_reset_error();
+
+  // The middleware only gets the message if it matched the third subscription.
+  auto start = std::chrono::steady_clock::now();
+  size_t subscription_count = 0u;
+  do {
+    ASSERT_EQ(RCL_RET_OK, rcl_publisher_get_subscription_count(&publisher, &subscription_count));
+    if (subscription_count < 3u) {
+      std::this_thread::sleep_for(10ms);
+    }
+  } while (subscription_count < 3u && std::chrono::steady_clock::now() < start + 10s);
+  ASSERT_EQ(3u, subscription_count);
+
+  for (int64_t i = 0; i < 3; ++i) {
+    test_msgs__msg__BasicTypes * msg = test_msgs__msg__BasicTypes__create();
+    ASSERT_NE(nullptr, msg);
+    msg->int64_value = i;
+    ret = rcl_publish_shared(&publisher, msg, delete_basic_types, &deleted_count);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  // The second subscription dropped the first message, which the first one still holds.
+  EXPECT_EQ(0u, deleted_count);
+
+  rcl_shared_message_t * shared_message = nullptr;
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_take_shared(&subscriptions[0], nullptr));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_ERROR, rcl_take_shared(&subscriptions[2], &shared_message));
+  rcl_reset_error();
+  std::vector<rcl_shared_message_t *> taken;
+  for (int64_t i = 0; i < 3; ++i) {
+    ret = rcl_take_shared(&subscriptions[0], &shared_message);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    auto msg = static_cast<const test_msgs__msg__BasicTypes *>(
+      rcl_shared_message_get_ros_message(shared_message));
+    EXPECT_EQ(i, msg->int64_value);
+    taken.push_back(shared_message);
+  }
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, rcl_take_shared(&subscriptions[0], &shared_message));
+  for (int64_t i = 1; i < 3; ++i) {
+    ret = rcl_take_shared(&subscriptions[1], &shared_message);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    auto msg = static_cast<const test_msgs__msg__BasicTypes *>(
+      rcl_shared_message_get_ros_message(shared_message));
+    EXPECT_EQ(i, msg->int64_value);
+    // Both subscriptions received the very same message.
+    EXPECT_EQ(rcl_shared_message_get_ros_message(taken[i]), msg);
+    rcl_shared_message_release(shared_message);
+  }
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, rcl_take_shared(&subscriptions[1], &shared_message));
+  EXPECT_EQ(0u, deleted_count);
+  for (rcl_shared_message_t * message : taken) {
+    rcl_shared_message_release(message);
+  }
+  EXPECT_EQ(3u, deleted_count);
+
+  // The third subscription received copies through the middleware.
+  size_t received_count = 0u;
+  start = std::chrono::steady_clock::now();
+  while (received_count < 3u && std::chrono::steady_clock::now() < start + 10s) {
+    ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscriptions[2], context_ptr, 10, 100));
+    test_msgs__msg__BasicTypes msg;
+    test_msgs__msg__BasicTypes__init(&msg);
+    ret = rcl_take(&subscriptions[2], &msg, nullptr, nullptr);
+    if (RCL_RET_OK == ret) {
+      EXPECT_EQ(static_cast<int64_t>(received_count), msg.int64_value);
+      ++received_count;
+    }
+    test_msgs__msg__BasicTypes__fini(&msg);
+  }
+  EXPECT_EQ(3u, received_count);
+
+  // Messages left in a queue are released when the subscription is finalized,
+  // and the message is deleted even if publishing fails.
+  rcl_publisher_t inter_process_publisher = rcl_get_zero_initialized_publisher();
+  publisher_options = rcl_publisher_get_default_options();
+  ret = rcl_publisher_init(
+    &inter_process_publisher, this->node_ptr, ts, topic, &publisher_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_publish_shared(
+    &inter_process_publisher, test_msgs__msg__BasicTypes__create(), delete_basic_types,
+    &deleted_count);
+  EXPECT_EQ(RCL_RET_ERROR, ret);
+  rcl_reset_error();
+  EXPECT_EQ(4u, deleted_count);
+  ret = rcl_publisher_fini(&inter_process_publisher, this->node_ptr);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_publish_shared(
+    &publisher, test_msgs__msg__BasicTypes__create(), delete_basic_types, &deleted_count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(4u, deleted_count);
+  ret = rcl_subscription_fini(&subscriptions[0], this->node_ptr);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(4u, deleted_count);
+  ret = rcl_subscription_fini(&subscriptions[1], this->node_ptr);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(5u, deleted_count);
+}
+
+/* Test that intra-process subscriptions only drop the copies of intra-process publishers.
+ */
+TEST_F(TestSubscriptionFixture, test_subscription_intra_process_local_publications) {
+  using namespace std::chrono_literals;
+  rcl_ret_t ret;
+  const rosidl_message_type_support_t * ts =
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes);
+  constexpr char topic[] = "rcl_test_subscription_intra_process_local_chatter";
+  size_t deleted_count = 0u;
+
+  rcl_publisher_t publishers[2];
+  const bool intra_process[2] = {true, false};
+  for (size_t i = 0; i < 2; ++i) {
+    publishers[i] = rcl_get_zero_initialized_publisher();
+    rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+    publisher_options.enable_intra_process = intra_process[i];
+    ret = rcl_publisher_init(&publishers[i], this->node_ptr, ts, topic, &publisher_options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 2; ++i) {
+      rcl_ret_t ret = rcl_publisher_fini(&publishers[i], this->node_ptr);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  });
+  rcl_subscription_t subscription = rcl_get_zero_initialized_subscription();
+  rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+  subscription_options.enable_intra_process = true;
+  ret = rcl_subscription_init(&subscription, this->node_ptr, ts, topic, &subscription_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_subscription_fini(&subscription, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  for (size_t i = 0; i < 2; ++i) {
+    ASSERT_TRUE(wait_for_established_subscription(&publishers[i], 10, 100));
+  }
+
+  // Only the message of the publisher which does not deliver by reference is taken.
+  for (int64_t i = 0; i < 2; ++i) {
+    test_msgs__msg__BasicTypes msg;
+    test_msgs__msg__BasicTypes__init(&msg);
+    msg.int64_value = i;
+    ret = rcl_publish(&publishers[i], &msg, nullptr);
+    test_msgs__msg__BasicTypes__fini(&msg);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  bool received = false;
+  auto start = std::chrono::steady_clock::now();
+  while (!received && std::chrono::steady_clock::now() < start + 10s) {
+    ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 10, 100));
+    test_msgs__msg__BasicTypes msg;
+    test_msgs__msg__BasicTypes__init(&msg);
+    ret = rcl_take(&subscription, &msg, nullptr, nullptr);
+    if (RCL_RET_OK == ret) {
+      EXPECT_EQ(1, msg.int64_value);
+      received = true;
+    } else {
+      EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, ret) << rcl_get_error_string().str;
+    }
+    test_msgs__msg__BasicTypes__fini(&msg);
+  }
+  EXPECT_TRUE(received);
+
+  // Shared messages of the intra-process publisher are delivered by reference.
+  ret = rcl_publish_shared(
+    &publishers[0], test_msgs__msg__BasicTypes__create(), delete_basic_types, &deleted_count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_shared_message_t * shared_message = nullptr;
+  ret = rcl_take_shared(&subscription, &shared_message);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_shared_message_release(shared_message);
+  EXPECT_EQ(1u, deleted_count);
+}
+
+/* Test that shared messages are only delivered with a compatible quality of service.
+ */
+TEST_F(TestSubscriptionFixture, test_subscription_intra_process_qos) {
+  rcl_ret_t ret;
+  const rosidl_message_type_support_t * ts =
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes);
+  constexpr char topic[] = "rcl_test_subscription_intra_process_qos_chatter";
+  size_t deleted_count = 0u;
+
+  rcl_publisher_t publisher = rcl_get_zero_initialized_publisher();
+  rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+  publisher_options.qos.reliability = RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT;
+  publisher_options.enable_intra_process = true;
+  ret = rcl_publisher_init(&publisher, this->node_ptr, ts, topic, &publisher_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_publisher_fini(&publisher, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  // A reliable subscription is incompatible with a best effort publisher.
+  rcl_subscription_t subscriptions[2];
+  const rmw_qos_reliability_policy_t reliabilities[2] = {
+    RMW_QOS_POLICY_RELIABILITY_RELIABLE, RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT};
+  for (size_t i = 0; i < 2; ++i) {
+    subscriptions[i] = rcl_get_zero_initialized_subscription();
+    rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+    subscription_options.qos.reliability = reliabilities[i];
+    subscription_options.enable_intra_process = true;
+    ret = rcl_subscription_init(
+      &subscriptions[i], this->node_ptr, ts, topic, &subscription_options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0; i < 2; ++i) {
+      rcl_ret_t ret = rcl_subscription_fini(&subscriptions[i], this->node_ptr);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  });
+
+  ret = rcl_publish_shared(
+    &publisher, test_msgs__msg__BasicTypes__create(), delete_basic_types, &deleted_count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_shared_message_t * shared_message = nullptr;
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, rcl_take_shared(&subscriptions[0], &shared_message));
+  ret = rcl_take_shared(&subscriptions[1], &shared_message);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, deleted_count);
+  rcl_shared_message_release(shared_message);
+  EXPECT_EQ(1u, deleted_count);
+}
+
 /* Basic nominal test of a subscription with take_serialize msg
  */
 TEST_F(TestSubscriptionFixture, test_subscription_serialized) {
@@ -707,6 +1264,115 @@ TEST_F(TestSubscriptionFixture, test_subscription_loaned) {
   }
 }
 
+TEST_F(TestSubscriptionFixture, test_subscription_loaned_message_pool) {
+  rcl_ret_t ret;
+  rcl_publisher_t publisher = rcl_get_zero_initialized_publisher();
+  const rosidl_message_type_support_t * ts =
+    ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, Strings);
+  constexpr char topic[] = "rcl_loaned_message_pool";
+  constexpr size_t pool_size = 2u;
+  rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+  EXPECT_EQ(0u, publisher_options.loaned_message_pool_size);
+  // Loan from the rcl pool whatever the middleware.
+  publisher_options.disable_loaned_message = true;
+  publisher_options.loaned_message_pool_size = pool_size;
+  ret = rcl_publisher_init(&publisher, this->node_ptr, ts, topic, &publisher_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_publisher_fini(&publisher, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  rcl_subscription_t subscription = rcl_get_zero_initialized_subscription();
+  rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
+  EXPECT_EQ(0u, subscription_options.loaned_message_pool_size);
+  subscription_options.disable_loaned_message = true;
+  subscription_options.loaned_message_pool_size = pool_size;
+  ret = rcl_subscription_init(&subscription, this->node_ptr, ts, topic, &subscription_options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    rcl_ret_t ret = rcl_subscription_fini(&subscription, this->node_ptr);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  EXPECT_TRUE(rcl_publisher_can_loan_messages(&publisher));
+  EXPECT_TRUE(rcl_subscription_can_loan_messages(&subscription));
+
+  // Pooled messages are only lent for the type of the publisher.
+  void * msg_mismatched = nullptr;
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_borrow_loaned_message(
+      &publisher, ROSIDL_GET_MSG_TYPE_SUPPORT(test_msgs, msg, BasicTypes), &msg_mismatched));
+  rcl_reset_error();
+  EXPECT_EQ(nullptr, msg_mismatched);
+
+  // The pool lends each of its messages once, and recycles returned ones.
+  test_msgs__msg__Strings * msgs_loaned[pool_size + 1] = {};
+  for (size_t i = 0; i < pool_size; ++i) {
+    ret = rcl_borrow_loaned_message(
+      &publisher, ts, reinterpret_cast<void **>(&msgs_loaned[i]));
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ASSERT_NE(nullptr, msgs_loaned[i]);
+  }
+  EXPECT_NE(msgs_loaned[0], msgs_loaned[1]);
+  EXPECT_EQ(
+    RCL_RET_BAD_ALLOC,
+    rcl_borrow_loaned_message(&publisher, ts, reinterpret_cast<void **>(&msgs_loaned[2])));
+  rcl_reset_error();
+  ret = rcl_return_loaned_message_from_publisher(&publisher, msgs_loaned[1]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_return_loaned_message_from_publisher(&publisher, msgs_loaned[1]));
+  rcl_reset_error();
+  test_msgs__msg__Strings not_loaned;
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_return_loaned_message_from_publisher(&publisher, &not_loaned));
+  rcl_reset_error();
+  ret = rcl_borrow_loaned_message(&publisher, ts, reinterpret_cast<void **>(&msgs_loaned[2]));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(msgs_loaned[1], msgs_loaned[2]);
+  ret = rcl_return_loaned_message_from_publisher(&publisher, msgs_loaned[2]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+
+  ASSERT_TRUE(wait_for_established_subscription(&publisher, 10, 100));
+  const char * test_string = "testing";
+  ASSERT_TRUE(rosidl_runtime_c__String__assign(&msgs_loaned[0]->string_value, test_string));
+  ret = rcl_publish_loaned_message(&publisher, msgs_loaned[0], nullptr);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  // The published message went back to the pool.
+  for (size_t i = 0; i < pool_size; ++i) {
+    ret = rcl_borrow_loaned_message(
+      &publisher, ts, reinterpret_cast<void **>(&msgs_loaned[i]));
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  for (size_t i = 0; i < pool_size; ++i) {
+    ret = rcl_return_loaned_message_from_publisher(&publisher, msgs_loaned[i]);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+
+  ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 10, 100));
+  test_msgs__msg__Strings * msg_taken = nullptr;
+  ret = rcl_take_loaned_message(
+    &subscription, reinterpret_cast<void **>(&msg_taken), nullptr, nullptr);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ASSERT_NE(nullptr, msg_taken);
+  EXPECT_EQ(
+    std::string(test_string),
+    std::string(msg_taken->string_value.data, msg_taken->string_value.size));
+  // Nothing is left to take, and the pooled message is not lost.
+  test_msgs__msg__Strings * msg_not_taken = nullptr;
+  EXPECT_EQ(
+    RCL_RET_SUBSCRIPTION_TAKE_FAILED,
+    rcl_take_loaned_message(
+      &subscription, reinterpret_cast<void **>(&msg_not_taken), nullptr, nullptr));
+  EXPECT_EQ(nullptr, msg_not_taken);
+  ret = rcl_return_loaned_message_from_subscription(&subscription, msg_taken);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+}
+
 TEST_F(TestSubscriptionFixture, test_subscription_option) {
   {
     rcl_subscription_options_t subscription_options = rcl_subscription_get_default_options();
@@ -945,7 +1611,9 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
     rcl_ret_t ret = rcl_subscription_fini(&subscription, this->node_ptr);
     EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
   });
-  bool is_cft_support = rcl_subscription_is_cft_enabled(&subscription);
+  // the filter is evaluated by rcl if the middleware cannot do it
+  ASSERT_TRUE(rcl_subscription_is_cft_enabled(&subscription));
+  bool is_cft_support = rcl_subscription_get_rmw_handle(&subscription)->is_cft_enabled;
   ASSERT_TRUE(wait_for_established_subscription(&publisher, 10, 1000));
 
   // publish with a non-filtered data
@@ -962,6 +1630,7 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
   if (is_cft_support) {
     ASSERT_FALSE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 10, 100));
   } else {
+    // the message is received, but dropped by rcl when taken
     ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 100, 100));
 
     test_msgs__msg__Strings msg;
@@ -971,10 +1640,7 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
       test_msgs__msg__Strings__fini(&msg);
     });
     ret = rcl_take(&subscription, &msg, nullptr, nullptr);
-    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
-    ASSERT_EQ(
-      std::string(test_string),
-      std::string(msg.string_value.data, msg.string_value.size));
+    ASSERT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, ret);
   }
 
   constexpr char test_filtered_string[] = "FilteredData";
@@ -1021,13 +1687,10 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
 
     ret = rcl_subscription_set_content_filter(
       &subscription, &options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
     if (is_cft_support) {
-      ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
       // waiting to allow for filter propagation
       std::this_thread::sleep_for(std::chrono::seconds(10));
-    } else {
-      ASSERT_EQ(RCL_RET_UNSUPPORTED, ret);
-      rcl_reset_error();
     }
 
     EXPECT_EQ(
@@ -1050,6 +1713,7 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
   if (is_cft_support) {
     ASSERT_FALSE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 10, 100));
   } else {
+    // the message is received, but dropped by rcl when taken
     ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 100, 100));
 
     test_msgs__msg__Strings msg;
@@ -1059,10 +1723,7 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
       test_msgs__msg__Strings__fini(&msg);
     });
     ret = rcl_take(&subscription, &msg, nullptr, nullptr);
-    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
-    ASSERT_EQ(
-      std::string(test_filtered_string),
-      std::string(msg.string_value.data, msg.string_value.size));
+    ASSERT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, ret);
   }
 
   constexpr char test_filtered_other_string[] = "FilteredOtherData";
@@ -1098,28 +1759,32 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
 
     ret = rcl_subscription_get_content_filter(
       &subscription, &content_filter_options);
-    if (is_cft_support) {
-      ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
 
-      rmw_subscription_content_filter_options_t * options =
-        &content_filter_options.rmw_subscription_content_filter_options;
-      ASSERT_STREQ(filter_expression2, options->filter_expression);
-      ASSERT_EQ(expression_parameters2_count, options->expression_parameters.size);
-      for (size_t i = 0; i < expression_parameters2_count; ++i) {
-        EXPECT_STREQ(
-          options->expression_parameters.data[i],
-          expression_parameters2[i]);
-      }
-      EXPECT_EQ(
-        RCL_RET_OK,
-        rcl_subscription_content_filter_options_fini(
-          &subscription,
-          &content_filter_options)
-      );
-    } else {
-      ASSERT_EQ(RCL_RET_UNSUPPORTED, ret);
-      rcl_reset_error();
+    rmw_subscription_content_filter_options_t * options =
+      &content_filter_options.rmw_subscription_content_filter_options;
+    ASSERT_STREQ(filter_expression2, options->filter_expression);
+    ASSERT_EQ(expression_parameters2_count, options->expression_parameters.size);
+    for (size_t i = 0; i < expression_parameters2_count; ++i) {
+      EXPECT_STREQ(
+        options->expression_parameters.data[i],
+        expression_parameters2[i]);
     }
+    EXPECT_EQ(
+      RCL_RET_OK,
+      rcl_subscription_content_filter_options_fini(
+        &subscription,
+        &content_filter_options)
+    );
+  }
+
+  // statistics of the filter evaluated by rcl
+  if (!is_cft_support) {
+    rcl_subscription_content_filter_statistics_t statistics;
+    ret = rcl_subscription_get_content_filter_statistics(&subscription, &statistics);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(2u, statistics.matched_count);
+    EXPECT_EQ(2u, statistics.filtered_count);
   }
 
   // reset filter
@@ -1137,16 +1802,13 @@ TEST_F(TestSubscriptionFixture, test_subscription_content_filtered) {
 
     ret = rcl_subscription_set_content_filter(
       &subscription, &options);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
     if (is_cft_support) {
-      ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
       // waiting to allow for filter propagation
       std::this_thread::sleep_for(std::chrono::seconds(10));
       ASSERT_TRUE(wait_for_established_subscription(&publisher, 10, 1000));
-      ASSERT_FALSE(rcl_subscription_is_cft_enabled(&subscription));
-    } else {
-      ASSERT_EQ(RCL_RET_UNSUPPORTED, ret);
-      rcl_reset_error();
     }
+    ASSERT_FALSE(rcl_subscription_is_cft_enabled(&subscription));
 
     EXPECT_EQ(
       RCL_RET_OK,
@@ -1269,11 +1931,9 @@ TEST_F(TestSubscriptionFixture, test_subscription_not_initialized_with_content_f
 
     ret = rcl_subscription_set_content_filter(
       &subscription, &options);
-    if (!is_cft_support) {
-      ASSERT_EQ(RCL_RET_UNSUPPORTED, ret);
-      rcl_reset_error();
-    } else {
-      ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ASSERT_TRUE(rcl_subscription_is_cft_enabled(&subscription));
+    if (is_cft_support) {
       // waiting to allow for filter propagation
       std::this_thread::sleep_for(std::chrono::seconds(10));
     }
@@ -1298,6 +1958,7 @@ TEST_F(TestSubscriptionFixture, test_subscription_not_initialized_with_content_f
   if (is_cft_support) {
     ASSERT_FALSE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 10, 100));
   } else {
+    // the message is received, but dropped by rcl when taken
     ASSERT_TRUE(wait_for_subscription_to_be_ready(&subscription, context_ptr, 100, 100));
 
     test_msgs__msg__BasicTypes msg;
@@ -1307,8 +1968,7 @@ TEST_F(TestSubscriptionFixture, test_subscription_not_initialized_with_content_f
       test_msgs__msg__BasicTypes__fini(&msg);
     });
     ret = rcl_take(&subscription, &msg, nullptr, nullptr);
-    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
-    ASSERT_TRUE(test_value == msg.int32_value);
+    ASSERT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, ret);
   }
 
   // publish filtered data
@@ -1632,13 +2292,15 @@ TEST_F(TestSubscriptionFixtureInit, test_bad_rcl_subscription_set_content_filter
   });
 
   {
+    // rcl evaluates the filter itself, which fails as there is no such field
     auto mock = mocking_utils::patch_and_return(
       "lib:rcl", rmw_subscription_set_content_filter, RMW_RET_UNSUPPORTED);
     EXPECT_EQ(
-      RMW_RET_UNSUPPORTED,
+      RCL_RET_INVALID_ARGUMENT,
       rcl_subscription_set_content_filter(
         &subscription, &options));
     rcl_reset_error();
+    EXPECT_FALSE(rcl_subscription_is_cft_enabled(&subscription));
   }
 
   {
@@ -1694,6 +2356,226 @@ TEST_F(TestSubscriptionFixtureInit, test_bad_rcl_subscription_get_content_filter
   }
 }
 
+/* Content filter evaluated by rcl, when the middleware does not support it.
+ */
+TEST_F(TestSubscriptionFixtureInit, test_subscription_rcl_content_filter) {
+  rcl_subscription_content_filter_statistics_t statistics;
+  EXPECT_EQ(
+    RCL_RET_SUBSCRIPTION_INVALID,
+    rcl_subscription_get_content_filter_statistics(nullptr, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_subscription_get_content_filter_statistics(&subscription, nullptr));
+  rcl_reset_error();
+
+  const char * filter_expression = "int32_value > %0 AND NOT (bool_value = TRUE)";
+  const char * expression_parameters[] = {"2"};
+  rcl_subscription_content_filter_options_t options =
+    rcl_get_zero_initialized_subscription_content_filter_options();
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_subscription_content_filter_options_init(
+      &subscription, filter_expression, 1, expression_parameters, &options)
+  ) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(
+      RCL_RET_OK,
+      rcl_subscription_content_filter_options_fini(&subscription, &options)
+    );
+  });
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rcl", rmw_subscription_set_content_filter, RMW_RET_UNSUPPORTED);
+    ASSERT_EQ(
+      RCL_RET_OK,
+      rcl_subscription_set_content_filter(&subscription, &options)
+    ) << rcl_get_error_string().str;
+  }
+  EXPECT_TRUE(rcl_subscription_is_cft_enabled(&subscription));
+
+  {
+    rcl_subscription_content_filter_options_t content_filter_options =
+      rcl_get_zero_initialized_subscription_content_filter_options();
+    ASSERT_EQ(
+      RCL_RET_OK,
+      rcl_subscription_get_content_filter(&subscription, &content_filter_options)
+    ) << rcl_get_error_string().str;
+    rmw_subscription_content_filter_options_t * rmw_options =
+      &content_filter_options.rmw_subscription_content_filter_options;
+    EXPECT_STREQ(filter_expression, rmw_options->filter_expression);
+    ASSERT_EQ(1u, rmw_options->expression_parameters.size);
+    EXPECT_STREQ("2", rmw_options->expression_parameters.data[0]);
+    EXPECT_EQ(
+      RCL_RET_OK,
+      rcl_subscription_content_filter_options_fini(&subscription, &content_filter_options)
+    );
+  }
+
+  struct
+  {
+    int32_t int32_value;
+    bool bool_value;
+  } received[] = {{1, false}, {3, true}, {4, false}, {5, false}};
+  size_t received_count = 0u;
+  // Once flooding, the middleware always has a message which does not match.
+  bool flooding = false;
+  size_t flooded_count = 0u;
+  auto mock = mocking_utils::patch(
+    "lib:rcl", rmw_take_with_info,
+    [&](auto, void * ros_message, bool * taken, auto...) {
+      auto msg = static_cast<test_msgs__msg__BasicTypes *>(ros_message);
+      if (flooding) {
+        msg->int32_value = 0;
+        msg->bool_value = false;
+        ++flooded_count;
+        *taken = true;
+        return RMW_RET_OK;
+      }
+      *taken = received_count < sizeof(received) / sizeof(received[0]);
+      if (*taken) {
+        msg->int32_value = received[received_count].int32_value;
+        msg->bool_value = received[received_count].bool_value;
+        ++received_count;
+      }
+      return RMW_RET_OK;
+    });
+
+  test_msgs__msg__BasicTypes msg;
+  ASSERT_TRUE(test_msgs__msg__BasicTypes__init(&msg));
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    test_msgs__msg__BasicTypes__fini(&msg);
+  });
+  // The first two messages are dropped, as they do not match.
+  ASSERT_EQ(RCL_RET_OK, rcl_take(&subscription, &msg, nullptr, nullptr));
+  EXPECT_EQ(4, msg.int32_value);
+  EXPECT_EQ(3u, received_count);
+  ASSERT_EQ(RCL_RET_OK, rcl_take(&subscription, &msg, nullptr, nullptr));
+  EXPECT_EQ(5, msg.int32_value);
+  EXPECT_EQ(
+    RCL_RET_SUBSCRIPTION_TAKE_FAILED, rcl_take(&subscription, &msg, nullptr, nullptr));
+
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_subscription_get_content_filter_statistics(&subscription, &statistics));
+  EXPECT_EQ(2u, statistics.matched_count);
+  EXPECT_EQ(2u, statistics.filtered_count);
+
+  // A take drops a bounded number of messages, and leaves the next ones to the next takes.
+  flooding = true;
+  EXPECT_EQ(
+    RCL_RET_SUBSCRIPTION_TAKE_FAILED, rcl_take(&subscription, &msg, nullptr, nullptr));
+  EXPECT_EQ(RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE, flooded_count);
+  flooding = false;
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_subscription_get_content_filter_statistics(&subscription, &statistics));
+  EXPECT_EQ(2u, statistics.matched_count);
+  EXPECT_EQ(2u + RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE, statistics.filtered_count);
+
+  // The dropped messages are counted apart from the takes which returned none.
+  rcl_subscription_statistics_t subscription_statistics;
+  ret = rcl_subscription_get_statistics(&subscription, &subscription_statistics);
+  if (RCL_RET_UNSUPPORTED == ret) {
+    rcl_reset_error();
+  } else {
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(2u, subscription_statistics.taken_count);
+    EXPECT_EQ(2u, subscription_statistics.take_failed_count);
+    EXPECT_EQ(
+      2u + RCL_SUBSCRIPTION_MAX_DROPPED_MESSAGES_PER_TAKE, subscription_statistics.dropped_count);
+  }
+
+  // An invalid expression is refused, and the current one is kept.
+  rcl_subscription_content_filter_options_t bad_options =
+    rcl_get_zero_initialized_subscription_content_filter_options();
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_subscription_content_filter_options_init(
+      &subscription, "int32_value >", 0, nullptr, &bad_options)
+  ) << rcl_get_error_string().str;
+  {
+    auto mock = mocking_utils::patch_and_return(
+      "lib:rcl", rmw_subscription_set_content_filter, RMW_RET_UNSUPPORTED);
+    EXPECT_EQ(
+      RCL_RET_INVALID_ARGUMENT,
+      rcl_subscription_set_content_filter(&subscription, &bad_options));
+    rcl_reset_error();
+  }
+  EXPECT_EQ(
+    RCL_RET_OK,
+    rcl_subscription_content_filter_options_fini(&subscription, &bad_options)
+  );
+  EXPECT_TRUE(rcl_subscription_is_cft_enabled(&subscription));
+}
+
+/* Taking counts messages, serialized bytes and takes which found no message.
+ */
+TEST_F(TestSubscriptionFixtureInit, test_subscription_statistics) {
+  rcl_subscription_statistics_t statistics;
+  EXPECT_EQ(
+    RCL_RET_SUBSCRIPTION_INVALID,
+    rcl_subscription_get_statistics(&subscription_zero_init, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_subscription_get_statistics(&subscription, nullptr));
+  rcl_reset_error();
+
+  ret = rcl_subscription_get_statistics(&subscription, &statistics);
+  if (RCL_RET_UNSUPPORTED == ret) {
+    rcl_reset_error();
+    GTEST_SKIP() << "rcl was built without statistics";
+  }
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, statistics.taken_count);
+  EXPECT_EQ(0u, statistics.taken_serialized_bytes);
+  EXPECT_EQ(0u, statistics.take_failed_count);
+  EXPECT_EQ(0u, statistics.loaned_message_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+
+  bool taken = true;
+  auto take_mock = mocking_utils::patch(
+    "lib:rcl", rmw_take_with_info,
+    [&](auto, auto, bool * taken_out, auto...) {
+      *taken_out = taken;
+      return RMW_RET_OK;
+    });
+  constexpr size_t serialized_length = 12u;
+  auto take_serialized_mock = mocking_utils::patch(
+    "lib:rcl", rmw_take_serialized_message_with_info,
+    [&](auto, rcl_serialized_message_t * serialized_message, bool * taken_out, auto...) {
+      serialized_message->buffer_length = serialized_length;
+      *taken_out = taken;
+      return RMW_RET_OK;
+    });
+
+  test_msgs__msg__BasicTypes msg;
+  ASSERT_TRUE(test_msgs__msg__BasicTypes__init(&msg));
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    test_msgs__msg__BasicTypes__fini(&msg);
+  });
+  rcl_serialized_message_t serialized_msg = rmw_get_zero_initialized_serialized_message();
+
+  EXPECT_EQ(RCL_RET_OK, rcl_take(&subscription, &msg, nullptr, nullptr));
+  EXPECT_EQ(RCL_RET_OK, rcl_take(&subscription, &msg, nullptr, nullptr));
+  EXPECT_EQ(
+    RCL_RET_OK, rcl_take_serialized_message(&subscription, &serialized_msg, nullptr, nullptr));
+  taken = false;
+  EXPECT_EQ(RCL_RET_SUBSCRIPTION_TAKE_FAILED, rcl_take(&subscription, &msg, nullptr, nullptr));
+  EXPECT_EQ(
+    RCL_RET_SUBSCRIPTION_TAKE_FAILED,
+    rcl_take_serialized_message(&subscription, &serialized_msg, nullptr, nullptr));
+
+  ASSERT_EQ(RCL_RET_OK, rcl_subscription_get_statistics(&subscription, &statistics));
+  EXPECT_EQ(3u, statistics.taken_count);
+  EXPECT_EQ(serialized_length, statistics.taken_serialized_bytes);
+  EXPECT_EQ(2u, statistics.take_failed_count);
+  EXPECT_EQ(0u, statistics.loaned_message_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+}
+
 TEST_F(TestSubscriptionFixture, test_init_fini_maybe_fail)
 {
   const rosidl_message_type_support_t * ts =
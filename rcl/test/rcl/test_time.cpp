@@ -765,9 +765,8 @@ TEST(rcl_time, add_remove_add_jump_callback) {
   EXPECT_EQ(RCL_RET_BAD_ALLOC, rcl_clock_add_jump_callback(&clock, threshold, cb, user_data3));
   rcl_reset_error();
 
-  // Remove callback but fail to shrink storage
-  EXPECT_EQ(RCL_RET_BAD_ALLOC, rcl_clock_remove_jump_callback(&clock, cb, user_data1));
-  rcl_reset_error();
+  // Removing a callback does not reallocate the storage
+  EXPECT_EQ(RCL_RET_OK, rcl_clock_remove_jump_callback(&clock, cb, user_data1));
 
   set_failing_allocator_is_failing(failing_allocator, false);
 
@@ -783,6 +782,199 @@ TEST(rcl_time, add_remove_add_jump_callback) {
   EXPECT_EQ(1u, clock.num_jump_callbacks);
 }
 
+TEST(rcl_time, ros_time_source) {
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_ros_time_source_t source = rcl_get_zero_initialized_ros_time_source();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_ros_time_source_init(nullptr, &allocator));
+  rcl_reset_error();
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_init(&source, &allocator)) <<
+    rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_ALREADY_INIT, rcl_ros_time_source_init(&source, &allocator));
+  rcl_reset_error();
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_ros_time_source_fini(&source)) << rcl_get_error_string().str;
+  });
+
+  constexpr size_t kNumClocks = 3u;
+  rcl_clock_t clocks[kNumClocks];
+  for (rcl_clock_t & clock : clocks) {
+    ASSERT_EQ(RCL_RET_OK, rcl_ros_clock_init(&clock, &allocator)) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (rcl_clock_t & clock : clocks) {
+      EXPECT_EQ(RCL_RET_OK, rcl_ros_clock_fini(&clock)) << rcl_get_error_string().str;
+    }
+  });
+
+  rcl_clock_t steady_clock;
+  ASSERT_EQ(RCL_RET_OK, rcl_steady_clock_init(&steady_clock, &allocator));
+  EXPECT_EQ(RCL_RET_ERROR, rcl_clock_attach_ros_time_source(&steady_clock, &source));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_OK, rcl_steady_clock_fini(&steady_clock));
+
+  rcl_time_jump_t time_jump;
+  rcl_jump_threshold_t threshold;
+  threshold.on_clock_change = true;
+  threshold.min_forward.nanoseconds = 1;
+  threshold.min_backward.nanoseconds = 0;
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_clock_add_jump_callback(&clocks[0], threshold, clock_callback, &time_jump)) <<
+    rcl_get_error_string().str;
+  for (rcl_clock_t & clock : clocks) {
+    ASSERT_EQ(RCL_RET_OK, rcl_clock_attach_ros_time_source(&clock, &source)) <<
+      rcl_get_error_string().str;
+  }
+  EXPECT_EQ(RCL_RET_ERROR, rcl_clock_attach_ros_time_source(&clocks[0], &source));
+  rcl_reset_error();
+  reset_callback_triggers();
+
+  // A single update of the source reaches every attached clock.
+  const rcl_time_point_value_t set_point1 = RCL_S_TO_NS(1);
+  const rcl_time_point_value_t set_point2 = RCL_S_TO_NS(2);
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_set_override(&source, set_point1));
+  EXPECT_FALSE(pre_callback_called);
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_enable_override(&source));
+  EXPECT_TRUE(pre_callback_called);
+  EXPECT_TRUE(post_callback_called);
+  EXPECT_EQ(RCL_ROS_TIME_ACTIVATED, time_jump.clock_change);
+  reset_callback_triggers();
+  for (rcl_clock_t & clock : clocks) {
+    rcl_time_point_value_t now = 0;
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_get_now(&clock, &now));
+    EXPECT_EQ(set_point1, now);
+    bool is_enabled = false;
+    EXPECT_EQ(RCL_RET_OK, rcl_is_enabled_ros_time_override(&clock, &is_enabled));
+    EXPECT_TRUE(is_enabled);
+  }
+
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_set_override(&source, set_point2));
+  EXPECT_TRUE(pre_callback_called);
+  EXPECT_TRUE(post_callback_called);
+  EXPECT_EQ(set_point2 - set_point1, time_jump.delta.nanoseconds);
+  EXPECT_EQ(RCL_ROS_TIME_NO_CHANGE, time_jump.clock_change);
+  reset_callback_triggers();
+  for (rcl_clock_t & clock : clocks) {
+    rcl_time_point_value_t now = 0;
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_get_now(&clock, &now));
+    EXPECT_EQ(set_point2, now);
+  }
+
+  // Updating an attached clock updates the source, and so every clock attached to it.
+  const rcl_time_point_value_t set_point3 = RCL_S_TO_NS(3);
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clocks[1], set_point3));
+  EXPECT_TRUE(pre_callback_called);
+  EXPECT_TRUE(post_callback_called);
+  EXPECT_EQ(set_point3 - set_point2, time_jump.delta.nanoseconds);
+  reset_callback_triggers();
+  for (rcl_clock_t & clock : clocks) {
+    rcl_time_point_value_t now = 0;
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_get_now(&clock, &now));
+    EXPECT_EQ(set_point3, now);
+  }
+  ASSERT_EQ(RCL_RET_OK, rcl_disable_ros_time_override(&clocks[1]));
+  EXPECT_EQ(RCL_ROS_TIME_DEACTIVATED, time_jump.clock_change);
+  bool is_enabled = true;
+  EXPECT_EQ(RCL_RET_OK, rcl_ros_time_source_is_override_enabled(&source, &is_enabled));
+  EXPECT_FALSE(is_enabled);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(&clocks[2]));
+  EXPECT_EQ(RCL_ROS_TIME_ACTIVATED, time_jump.clock_change);
+  reset_callback_triggers();
+
+  // A detached clock keeps the last values of the source.
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_detach_ros_time_source(&clocks[1]));
+  EXPECT_EQ(RCL_RET_ERROR, rcl_clock_detach_ros_time_source(&clocks[1]));
+  rcl_reset_error();
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_disable_override(&source));
+  EXPECT_TRUE(pre_callback_called);
+  EXPECT_EQ(RCL_ROS_TIME_DEACTIVATED, time_jump.clock_change);
+  is_enabled = true;
+  EXPECT_EQ(RCL_RET_OK, rcl_ros_time_source_is_override_enabled(&source, &is_enabled));
+  EXPECT_FALSE(is_enabled);
+  rcl_time_point_value_t now = 0;
+  EXPECT_EQ(RCL_RET_OK, rcl_clock_get_now(&clocks[1], &now));
+  EXPECT_EQ(set_point3, now);
+  EXPECT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clocks[1], set_point1));
+
+  // Finalizing a clock detaches it from the source.
+  EXPECT_EQ(RCL_RET_OK, rcl_ros_clock_fini(&clocks[2])) << rcl_get_error_string().str;
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_clock_init(&clocks[2], &allocator)) <<
+    rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_OK, rcl_clock_remove_jump_callback(&clocks[0], clock_callback, &time_jump));
+}
+
+TEST(rcl_time, ros_time_source_concurrent_attach) {
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_ros_time_source_t source = rcl_get_zero_initialized_ros_time_source();
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_init(&source, &allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_ros_time_source_fini(&source)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_time_source_enable_override(&source));
+
+  // Attaching enough clocks to grow the clock array races with the updates of the source.
+  constexpr size_t kNumClocks = 64u;
+  std::thread attach_thread([&]() {
+      for (int round = 0; round < 10; ++round) {
+        rcl_clock_t clocks[kNumClocks];
+        for (rcl_clock_t & clock : clocks) {
+          EXPECT_EQ(RCL_RET_OK, rcl_ros_clock_init(&clock, &allocator));
+          EXPECT_EQ(RCL_RET_OK, rcl_clock_attach_ros_time_source(&clock, &source));
+        }
+        for (rcl_clock_t & clock : clocks) {
+          EXPECT_EQ(RCL_RET_OK, rcl_ros_clock_fini(&clock));
+        }
+      }
+    });
+  for (int64_t i = 1; i <= 10000; ++i) {
+    EXPECT_EQ(RCL_RET_OK, rcl_ros_time_source_set_override(&source, i));
+  }
+  attach_thread.join();
+}
+
+TEST(rcl_time, fast_steady_clock) {
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_clock_t clock;
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_fast_steady_clock_init(nullptr, &allocator));
+  rcl_reset_error();
+  ASSERT_EQ(RCL_RET_OK, rcl_fast_steady_clock_init(&clock, &allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+  EXPECT_EQ(RCL_STEADY_TIME, clock.type);
+  EXPECT_TRUE(rcl_clock_valid(&clock));
+
+  rcl_clock_t steady_clock;
+  ASSERT_EQ(RCL_RET_OK, rcl_steady_clock_init(&steady_clock, &allocator));
+  EXPECT_FALSE(rcl_clock_uses_tsc(&steady_clock));
+
+  // The clock never goes backwards and stays in sync with the steady clock.
+  rcl_time_point_value_t last = 0;
+  for (int i = 0; i < 1000; ++i) {
+    rcl_time_point_value_t now = 0;
+    ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(&clock, &now));
+    EXPECT_LE(last, now);
+    last = now;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  rcl_time_point_value_t steady_before = 0;
+  rcl_time_point_value_t fast = 0;
+  rcl_time_point_value_t steady_after = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(&steady_clock, &steady_before));
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(&clock, &fast));
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(&steady_clock, &steady_after));
+  EXPECT_NEAR(
+    static_cast<double>(steady_before + (steady_after - steady_before) / 2),
+    static_cast<double>(fast), static_cast<double>(RCL_MS_TO_NS(1)));
+  EXPECT_EQ(RCL_RET_OK, rcl_steady_clock_fini(&steady_clock));
+}
+
 TEST(rcl_time, failed_get_now) {
   rcl_allocator_t allocator = rcl_get_default_allocator();
   rcl_clock_t uninitialized_clock;
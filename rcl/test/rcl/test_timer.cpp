@@ -14,9 +14,12 @@
 
 #include <gtest/gtest.h>
 #include <chrono>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "rcl/timer.h"
+#include "rcl/timer_engine.h"
 
 #include "rcl/rcl.h"
 
@@ -291,6 +294,196 @@ TEST_F(TestTimerFixture, test_two_timers) {
   EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
 }
 
+TEST_F(TestTimerFixture, test_timers_sharing_clock_guard_condition) {
+  rcl_clock_t clock;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_ret_t ret = rcl_clock_init(RCL_STEADY_TIME, &clock, &allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+
+  rcl_timer_options_t options = rcl_timer_get_default_options();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_timer_init_with_options(
+      nullptr, &clock, this->context_ptr, 0, nullptr, &options));
+  rcl_reset_error();
+  rcl_timer_t timer = rcl_get_zero_initialized_timer();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_timer_init_with_options(
+      &timer, &clock, this->context_ptr, 0, nullptr, nullptr));
+  rcl_reset_error();
+
+  options.share_clock_guard_condition = true;
+  ret = rcl_timer_init_with_options(&timer, &clock, this->context_ptr, 0, nullptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_timer_t timer2 = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init_with_options(
+    &timer2, &clock, this->context_ptr, RCL_S_TO_NS(1), nullptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_timer_t timer3 = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &timer3, &clock, this->context_ptr, RCL_S_TO_NS(1), nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer3)) << rcl_get_error_string().str;
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer2)) << rcl_get_error_string().str;
+    EXPECT_EQ(nullptr, clock.timer_guard_condition);
+  });
+
+  rcl_guard_condition_t * shared_gc = rcl_timer_get_guard_condition(&timer);
+  ASSERT_NE(nullptr, shared_gc);
+  EXPECT_EQ(shared_gc, rcl_timer_get_guard_condition(&timer2));
+  EXPECT_NE(shared_gc, rcl_timer_get_guard_condition(&timer3));
+  EXPECT_EQ(2u, clock.num_timer_guard_condition_users);
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(&wait_set, 0, 0, 3, 0, 0, 0, context_ptr, allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer, NULL));
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer2, NULL));
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer3, NULL));
+  // Resetting a timer triggers the shared guard condition, which wakes the
+  // wait set without making the other timers on the clock ready.
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_reset(&timer2)) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(100));
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(&timer, wait_set.timers[0]);
+  EXPECT_EQ(nullptr, wait_set.timers[1]);
+  EXPECT_EQ(nullptr, wait_set.timers[2]);
+
+  // The shared guard condition outlives the timers still using it.
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer)) << rcl_get_error_string().str;
+  EXPECT_EQ(1u, clock.num_timer_guard_condition_users);
+  EXPECT_EQ(shared_gc, rcl_timer_get_guard_condition(&timer2));
+}
+
+TEST_F(TestTimerFixture, test_timer_engine) {
+  rcl_timer_engine_t engine = rcl_get_zero_initialized_timer_engine();
+  rcl_ret_t ret = rcl_timer_engine_init(&engine, rcl_get_default_allocator());
+#ifndef __linux__
+  EXPECT_EQ(RCL_RET_UNSUPPORTED, ret);
+  rcl_reset_error();
+  return;
+#endif
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_engine_fini(&engine)) << rcl_get_error_string().str;
+  });
+  EXPECT_EQ(RCL_RET_ALREADY_INIT, rcl_timer_engine_init(&engine, rcl_get_default_allocator()));
+  rcl_reset_error();
+
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_clock_t steady_clock;
+  ret = rcl_clock_init(RCL_STEADY_TIME, &steady_clock, &allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_clock_t ros_clock;
+  ret = rcl_clock_init(RCL_ROS_TIME, &ros_clock, &allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&steady_clock)) << rcl_get_error_string().str;
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&ros_clock)) << rcl_get_error_string().str;
+  });
+
+  rcl_timer_t timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &timer, &steady_clock, this->context_ptr, RCL_MS_TO_NS(50), nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcl_timer_t ros_timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &ros_timer, &ros_clock, this->context_ptr, RCL_MS_TO_NS(50), nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer)) << rcl_get_error_string().str;
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&ros_timer)) << rcl_get_error_string().str;
+  });
+
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_engine_add_timer(nullptr, &timer));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_engine_add_timer(&engine, nullptr));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_UNSUPPORTED, rcl_timer_engine_add_timer(&engine, &ros_timer));
+  rcl_reset_error();
+  {
+    // The engine cannot wait on the time stamp counter, which drifts from the kernel clocks.
+    rcl_clock_t fast_clock;
+    ret = rcl_fast_steady_clock_init(&fast_clock, &allocator);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+    {
+      EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&fast_clock)) << rcl_get_error_string().str;
+    });
+    rcl_timer_t fast_timer = rcl_get_zero_initialized_timer();
+    ret = rcl_timer_init2(
+      &fast_timer, &fast_clock, this->context_ptr, RCL_MS_TO_NS(50), nullptr, allocator, true);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+    {
+      EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&fast_timer)) << rcl_get_error_string().str;
+    });
+    ret = rcl_timer_engine_add_timer(&engine, &fast_timer);
+    if (rcl_clock_uses_tsc(&fast_clock)) {
+      EXPECT_EQ(RCL_RET_UNSUPPORTED, ret);
+      rcl_reset_error();
+    } else {
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  }
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_engine_add_timer(&engine, &timer))
+    << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_engine_add_timer(&engine, &timer));
+  rcl_reset_error();
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(&wait_set, 0, 0, 1, 0, 0, 0, context_ptr, allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer, NULL));
+  // Consume the trigger of the timer guard condition done at initialization.
+  ret = rcl_wait(&wait_set, 0);
+  EXPECT_TRUE(RCL_RET_OK == ret || RCL_RET_TIMEOUT == ret);
+  rcl_reset_error();
+
+  // rcl_wait no longer takes its timeout from the timer, the engine wakes it up,
+  // once per period as long as the timer is called.
+  for (int period = 0; period < 5; ++period) {
+    SCOPED_TRACE("period " + std::to_string(period));
+    ASSERT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+    ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer, NULL));
+    auto start = std::chrono::steady_clock::now();
+    // The timeout is twenty periods, so that only the engine wakes the wait up in time.
+    ret = rcl_wait(&wait_set, RCL_S_TO_NS(1));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ASSERT_EQ(&timer, wait_set.timers[0]);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(500));
+    bool is_ready = false;
+    ASSERT_EQ(RCL_RET_OK, rcl_timer_is_ready(&timer, &is_ready)) << rcl_get_error_string().str;
+    EXPECT_TRUE(is_ready);
+    ASSERT_EQ(RCL_RET_OK, rcl_timer_call(&timer)) << rcl_get_error_string().str;
+  }
+
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_engine_remove_timer(&engine, &timer))
+    << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_NOT_FOUND, rcl_timer_engine_remove_timer(&engine, &timer));
+  rcl_reset_error();
+  // Finalizing a timer removes it from its engine.
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_engine_add_timer(&engine, &timer))
+    << rcl_get_error_string().str;
+}
+
 TEST_F(TestTimerFixture, test_two_timers_ready_before_timeout) {
   rcl_ret_t ret;
 
@@ -835,6 +1028,195 @@ TEST_F(TestTimerFixture, test_ros_time_wakes_wait) {
   EXPECT_LT(finish - start, std::chrono::milliseconds(100));
 }
 
+TEST_F(TestTimerFixture, test_ros_time_no_spurious_wake) {
+  rcl_clock_t clock;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_init(RCL_ROS_TIME, &clock, &allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(1)));
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(&clock)) << rcl_get_error_string().str;
+
+  rcl_timer_t timer = rcl_get_zero_initialized_timer();
+  rcl_ret_t ret = rcl_timer_init2(
+    &timer, &clock, this->context_ptr, RCL_MS_TO_NS(10), nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer)) << rcl_get_error_string().str;
+  });
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(&wait_set, 0, 0, 1, 0, 0, 0, context_ptr, allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer, NULL));
+
+  // ROS time does not advance, so 10ms of steady time must not end the wait.
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(200));
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+  rcl_reset_error();
+  EXPECT_EQ(nullptr, wait_set.timers[0]);
+
+  // Once ROS time passes the deadline, the timer is ready right away.
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &timer, NULL));
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(2)));
+  ret = rcl_wait(&wait_set, RCL_S_TO_NS(5));
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(&timer, wait_set.timers[0]);
+}
+
+TEST_F(TestTimerFixture, test_ros_time_timer_registry) {
+  rcl_clock_t clock;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_init(RCL_ROS_TIME, &clock, &allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(1)));
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(&clock)) << rcl_get_error_string().str;
+
+  // Timer i is due 100ms * (i + 1) after the start.
+  constexpr size_t kNumTimers = 10u;
+  std::vector<rcl_timer_t> timers(kNumTimers, rcl_get_zero_initialized_timer());
+  for (size_t i = 0u; i < kNumTimers; ++i) {
+    rcl_ret_t ret = rcl_timer_init2(
+      &timers[i], &clock, this->context_ptr, RCL_MS_TO_NS(100) * (i + 1), nullptr, allocator,
+      true);
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (rcl_timer_t & timer : timers) {
+      EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer)) << rcl_get_error_string().str;
+    }
+  });
+  // All timers share a single jump callback.
+  EXPECT_EQ(1u, clock.num_jump_callbacks);
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_ret_t ret = rcl_wait_set_init(
+    &wait_set, 0, kNumTimers, 0, 0, 0, 0, context_ptr, allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  // Return which timers woke the wait set through their guard condition.
+  auto triggered = [&]() {
+      std::vector<bool> result(kNumTimers, false);
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+      for (rcl_timer_t & timer : timers) {
+        if (NULL != timer.impl) {
+          EXPECT_EQ(
+            RCL_RET_OK,
+            rcl_wait_set_add_guard_condition(
+              &wait_set, rcl_timer_get_guard_condition(&timer), NULL));
+        }
+      }
+      rcl_ret_t ret = rcl_wait(&wait_set, 0);
+      if (RCL_RET_TIMEOUT == ret) {
+        rcl_reset_error();
+        return result;
+      }
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+      for (size_t i = 0u; i < wait_set.size_of_guard_conditions; ++i) {
+        for (size_t j = 0u; j < kNumTimers; ++j) {
+          if (NULL != timers[j].impl && NULL != wait_set.guard_conditions[i] &&
+            wait_set.guard_conditions[i] == rcl_timer_get_guard_condition(&timers[j]))
+          {
+            result[j] = true;
+          }
+        }
+      }
+      return result;
+    };
+
+  // Only the timers which became due are triggered.
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_MS_TO_NS(1350)));
+  std::vector<bool> expected(kNumTimers, false);
+  expected[0] = expected[1] = expected[2] = true;
+  EXPECT_EQ(expected, triggered());
+
+  // Timers stay ready until they are called, so the next jump triggers them again.
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_MS_TO_NS(1360)));
+  EXPECT_EQ(expected, triggered());
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_call(&timers[0])) << rcl_get_error_string().str;
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_MS_TO_NS(1370)));
+  expected[0] = false;
+  EXPECT_EQ(expected, triggered());
+
+  // A reset moving the next call earlier is still noticed.
+  int64_t old_period = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_exchange_period(&timers[9], RCL_MS_TO_NS(10), &old_period));
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_reset(&timers[9])) << rcl_get_error_string().str;
+  triggered();  // The reset itself triggers the guard condition.
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_MS_TO_NS(1390)));
+  expected[9] = true;
+  EXPECT_EQ(expected, triggered());
+
+  // Removing timers keeps the remaining ones ordered.
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timers[1])) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timers[9])) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timers[4])) << rcl_get_error_string().str;
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_MS_TO_NS(1750)));
+  expected.assign(kNumTimers, false);
+  expected[0] = expected[2] = expected[3] = expected[5] = expected[6] = true;
+  EXPECT_EQ(expected, triggered());
+  EXPECT_EQ(1u, clock.num_jump_callbacks);
+}
+
+TEST_F(TestTimerFixture, test_ros_time_timer_registry_concurrent_updates) {
+  rcl_clock_t clock;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_init(RCL_ROS_TIME, &clock, &allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(1)));
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(&clock)) << rcl_get_error_string().str;
+
+  // The first timer creates the registry, later ones may come and go during time updates.
+  rcl_timer_t first_timer = rcl_get_zero_initialized_timer();
+  ASSERT_EQ(
+    RCL_RET_OK, rcl_timer_init2(
+      &first_timer, &clock, this->context_ptr, RCL_MS_TO_NS(1), nullptr, allocator, true)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&first_timer)) << rcl_get_error_string().str;
+  });
+  std::thread timers_thread([&]() {
+      for (int i = 0; i < 1000; ++i) {
+        rcl_timer_t timer = rcl_get_zero_initialized_timer();
+        EXPECT_EQ(
+          RCL_RET_OK, rcl_timer_init2(
+            &timer, &clock, this->context_ptr, RCL_MS_TO_NS(i % 10 + 1), nullptr, allocator,
+            true)) << rcl_get_error_string().str;
+        EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer)) << rcl_get_error_string().str;
+      }
+    });
+  for (int64_t i = 0; i < 1000; ++i) {
+    // Alternate forward and backward jumps, which walk the registry differently.
+    const int64_t time = RCL_S_TO_NS(1) + RCL_MS_TO_NS(i % 2 ? i : i / 2);
+    EXPECT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, time)) <<
+      rcl_get_error_string().str;
+  }
+  timers_thread.join();
+  EXPECT_EQ(1u, clock.num_jump_callbacks);
+}
+
 TEST_F(TestPreInitTimer, test_timer_get_allocator) {
   const rcl_allocator_t * allocator_returned = rcl_timer_get_allocator(&timer);
   EXPECT_TRUE(rcutils_allocator_is_valid(allocator_returned));
@@ -885,6 +1267,32 @@ TEST_F(TestPreInitTimer, test_timer_call) {
   EXPECT_EQ(times_called, 4);
 }
 
+TEST_F(TestPreInitTimer, test_timer_get_next_call_time) {
+  int64_t next_call_time = 0;
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_get_next_call_time(nullptr, &next_call_time));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_get_next_call_time(&timer, nullptr));
+  rcl_reset_error();
+
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(&clock)) << rcl_get_error_string().str;
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(10)));
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_reset(&timer)) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_get_next_call_time(&timer, &next_call_time));
+  EXPECT_EQ(RCL_S_TO_NS(11), next_call_time);
+
+  // The next call time is absolute, so it does not move with the clock.
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(12)));
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_get_next_call_time(&timer, &next_call_time));
+  EXPECT_EQ(RCL_S_TO_NS(11), next_call_time);
+  int64_t time_until_next_call = 0;
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_get_time_until_next_call(&timer, &time_until_next_call));
+  EXPECT_EQ(-RCL_S_TO_NS(1), time_until_next_call);
+
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_cancel(&timer)) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_TIMER_CANCELED, rcl_timer_get_next_call_time(&timer, &next_call_time));
+  rcl_reset_error();
+}
+
 TEST_F(TestPreInitTimer, test_get_callback) {
   ASSERT_EQ(timer_callback_test, rcl_timer_get_callback(&timer)) << rcl_get_error_string().str;
 }
@@ -1073,6 +1481,235 @@ TEST_F(TestPreInitTimer, test_timer_info_detect_overrun) {
   EXPECT_EQ(times_called, 3);
 }
 
+TEST_F(TestPreInitTimer, test_timer_call_batch) {
+  const int64_t period = RCL_MS_TO_NS(10);
+  rcl_timer_t other_timer = rcl_get_zero_initialized_timer();
+  rcl_ret_t ret = rcl_timer_init2(
+    &other_timer, &clock, this->context_ptr, period, timer_callback_test,
+    rcl_get_default_allocator(), true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&other_timer)) << rcl_get_error_string().str;
+  });
+  rcl_timer_t canceled_timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &canceled_timer, &clock, this->context_ptr, period, timer_callback_test,
+    rcl_get_default_allocator(), true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&canceled_timer)) << rcl_get_error_string().str;
+  });
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_cancel(&canceled_timer)) << rcl_get_error_string().str;
+  int64_t old_period = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_exchange_period(&timer, period, &old_period));
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_reset(&timer));
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_reset(&other_timer));
+
+  int64_t next_call_time = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_get_next_call_time(&timer, &next_call_time));
+  int64_t other_next_call_time = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_get_next_call_time(&other_timer, &other_next_call_time));
+  const rcl_time_point_value_t now = next_call_time + 2 * period + period / 2;
+
+  rcl_timer_t * timers[] = {&timer, nullptr, &canceled_timer, &other_timer};
+  rcl_timer_call_info_t call_infos[4] = {};
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_timer_call_batch(nullptr, 4, now, call_infos));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_call_batch(timers, 4, now, nullptr));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_call_batch(timers, 4, -1, call_infos));
+  rcl_reset_error();
+
+  times_called = 0;
+  ret = rcl_timer_call_batch(timers, 4, now, call_infos);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(2, times_called);
+  EXPECT_EQ(&timer, timers[0]);
+  EXPECT_EQ(nullptr, timers[1]);
+  EXPECT_EQ(nullptr, timers[2]);
+  EXPECT_EQ(&other_timer, timers[3]);
+  EXPECT_EQ(next_call_time, call_infos[0].expected_call_time);
+  EXPECT_EQ(now, call_infos[0].actual_call_time);
+  EXPECT_EQ(other_next_call_time, call_infos[3].expected_call_time);
+  EXPECT_EQ(now, call_infos[3].actual_call_time);
+  // The missed periods are skipped, as for rcl_timer_call().
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_get_next_call_time(&timer, &next_call_time));
+  EXPECT_EQ(call_infos[0].expected_call_time + 3 * period, next_call_time);
+
+  // Timers using different clocks can not share a time sample.
+  rcl_clock_t steady_clock;
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_clock_init(RCL_STEADY_TIME, &steady_clock, &allocator)) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&steady_clock)) << rcl_get_error_string().str;
+  });
+  rcl_timer_t steady_timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &steady_timer, &steady_clock, this->context_ptr, period, timer_callback_test,
+    rcl_get_default_allocator(), true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&steady_timer)) << rcl_get_error_string().str;
+  });
+  rcl_timer_t * mixed_timers[] = {&timer, &steady_timer};
+  times_called = 0;
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_timer_call_batch(mixed_timers, 2, now, call_infos));
+  rcl_reset_error();
+  EXPECT_EQ(0, times_called);
+}
+
+TEST_F(TestTimerFixture, test_timer_slack) {
+  rcl_clock_t clock;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_init(RCL_STEADY_TIME, &clock, &allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+
+  rcl_timer_options_t options = rcl_timer_get_default_options();
+  EXPECT_EQ(0, options.slack);
+  options.slack = -1;
+  rcl_timer_t early_timer = rcl_get_zero_initialized_timer();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT,
+    rcl_timer_init_with_options(
+      &early_timer, &clock, this->context_ptr, RCL_MS_TO_NS(50), nullptr, &options));
+  rcl_reset_error();
+
+  // The early timer may be served as late as the late timer, so one wake up serves both.
+  options.slack = RCL_MS_TO_NS(100);
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_timer_init_with_options(
+      &early_timer, &clock, this->context_ptr, RCL_MS_TO_NS(50), nullptr, &options)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&early_timer)) << rcl_get_error_string().str;
+  });
+  int64_t slack = 0;
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_get_slack(&early_timer, &slack));
+  EXPECT_EQ(RCL_MS_TO_NS(100), slack);
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_get_slack(&early_timer, nullptr));
+  rcl_reset_error();
+
+  rcl_timer_t late_timer = rcl_get_zero_initialized_timer();
+  ASSERT_EQ(
+    RCL_RET_OK,
+    rcl_timer_init2(
+      &late_timer, &clock, this->context_ptr, RCL_MS_TO_NS(80), nullptr, allocator, true)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&late_timer)) << rcl_get_error_string().str;
+  });
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ASSERT_EQ(
+    RCL_RET_OK, rcl_wait_set_init(&wait_set, 0, 0, 2, 0, 0, 0, context_ptr, allocator)) <<
+    rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &early_timer, NULL));
+  ASSERT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &late_timer, NULL));
+  ASSERT_EQ(RCL_RET_OK, rcl_wait(&wait_set, RCL_S_TO_NS(1))) << rcl_get_error_string().str;
+  EXPECT_EQ(&early_timer, wait_set.timers[0]);
+  EXPECT_EQ(&late_timer, wait_set.timers[1]);
+}
+
+TEST_F(TestTimerFixture, test_timer_statistics) {
+  rcl_clock_t clock;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_ret_t ret = rcl_clock_init(RCL_STEADY_TIME, &clock, &allocator);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+  const int64_t period = RCL_MS_TO_NS(10);
+  rcl_timer_options_t options = rcl_timer_get_default_options();
+  options.statistics = true;
+  rcl_timer_t timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init_with_options(&timer, &clock, this->context_ptr, period, nullptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&timer)) << rcl_get_error_string().str;
+  });
+
+  rcl_timer_statistics_t statistics;
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_get_statistics(nullptr, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_get_statistics(&timer, nullptr));
+  rcl_reset_error();
+  ret = rcl_timer_get_statistics(&timer, &statistics);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, statistics.call_count);
+  EXPECT_EQ(0, statistics.mean_lateness);
+
+  // Call the timer at chosen times, to know its lateness exactly.
+  int64_t next_call_time = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_timer_get_next_call_time(&timer, &next_call_time));
+  rcl_timer_t * timers[] = {&timer};
+  rcl_timer_call_info_t call_info;
+  ret = rcl_timer_call_batch(timers, 1, next_call_time + RCL_US_TO_NS(1), &call_info);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  // Two and a half periods late, so the two periods in between are skipped.
+  ret = rcl_timer_call_batch(
+    timers, 1, next_call_time + period + 2 * period + period / 2, &call_info);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_record_callback_duration(&timer, 100));
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_record_callback_duration(&timer, 300));
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_timer_record_callback_duration(&timer, -1));
+  rcl_reset_error();
+
+  ret = rcl_timer_get_statistics(&timer, &statistics);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(2u, statistics.call_count);
+  EXPECT_EQ(2u, statistics.skipped_periods);
+  EXPECT_EQ(RCL_US_TO_NS(1), statistics.min_lateness);
+  EXPECT_EQ(2 * period + period / 2, statistics.max_lateness);
+  EXPECT_EQ((RCL_US_TO_NS(1) + 2 * period + period / 2) / 2, statistics.mean_lateness);
+  // 1us falls in [1, 2), 25000us in [2^14, 2^15).
+  EXPECT_EQ(1u, statistics.lateness_histogram[1]);
+  EXPECT_EQ(1u, statistics.lateness_histogram[15]);
+  EXPECT_EQ(2u, statistics.callback_count);
+  EXPECT_EQ(100, statistics.min_callback_duration);
+  EXPECT_EQ(300, statistics.max_callback_duration);
+  EXPECT_EQ(200, statistics.mean_callback_duration);
+
+  ret = rcl_timer_reset_statistics(&timer);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_timer_get_statistics(&timer, &statistics);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, statistics.call_count);
+  EXPECT_EQ(0u, statistics.callback_count);
+
+  // Statistics are not recorded unless enabled.
+  rcl_timer_t other_timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &other_timer, &clock, this->context_ptr, period, nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_ERROR, rcl_timer_get_statistics(&other_timer, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_ERROR, rcl_timer_reset_statistics(&other_timer));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_ERROR, rcl_timer_record_callback_duration(&other_timer, 100));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&other_timer)) << rcl_get_error_string().str;
+}
+
 TEST_F(TestPreInitTimer, test_time_since_last_call) {
   rcl_time_point_value_t time_sice_next_call_start = 0u;
   rcl_time_point_value_t time_sice_next_call_end = 0u;
@@ -618,6 +618,565 @@ TEST_F(WaitSetTestFixture, add_with_index) {
   }
 }
 
+// Test that members of a persistent wait set survive rcl_wait
+TEST_F(WaitSetTestFixture, persistent_wait_set) {
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.persistent = true;
+  rcl_ret_t ret = rcl_wait_set_init_with_options(
+    &wait_set, 0, 2, 0, 0, 0, 0, context_ptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  rcl_guard_condition_t guard_conditions[2];
+  for (size_t i = 0u; i < 2u; ++i) {
+    guard_conditions[i] = rcl_get_zero_initialized_guard_condition();
+    ret = rcl_guard_condition_init(
+      &guard_conditions[i], this->context_ptr, rcl_guard_condition_get_default_options());
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_conditions[i], NULL);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0u; i < 2u; ++i) {
+      ret = rcl_guard_condition_fini(&guard_conditions[i]);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  });
+
+  // Wait several times without clearing and re-adding the guard conditions.
+  for (size_t i = 0u; i < 3u; ++i) {
+    const size_t triggered = i % 2u;
+    ret = rcl_trigger_guard_condition(&guard_conditions[triggered]);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(&guard_conditions[triggered], wait_set.guard_conditions[triggered]);
+    EXPECT_EQ(nullptr, wait_set.guard_conditions[1u - triggered]);
+  }
+  ret = rcl_wait(&wait_set, 0);
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+  rcl_reset_error();
+
+  // Removing a guard condition moves the last member into its slot.
+  ret = rcl_wait_set_remove_guard_condition(&wait_set, &guard_conditions[0]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_remove_guard_condition(&wait_set, &guard_conditions[0]);
+  EXPECT_EQ(RCL_RET_NOT_FOUND, ret);
+  rcl_reset_error();
+  ret = rcl_trigger_guard_condition(&guard_conditions[0]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_trigger_guard_condition(&guard_conditions[1]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(&guard_conditions[1], wait_set.guard_conditions[0]);
+  EXPECT_EQ(nullptr, wait_set.guard_conditions[1]);
+
+  // Clearing removes every member.
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_remove_guard_condition(&wait_set, &guard_conditions[1]);
+  EXPECT_EQ(RCL_RET_NOT_FOUND, ret);
+  rcl_reset_error();
+}
+
+// Test that rcl_wait fills the ready lists when they are enabled
+TEST_F(WaitSetTestFixture, ready_lists) {
+  const size_t kNumEntities = 3u;
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.ready_lists = true;
+  rcl_ret_t ret = rcl_wait_set_init_with_options(
+    &wait_set, 0, kNumEntities, 0, 0, 0, 0, context_ptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  ASSERT_NE(nullptr, wait_set.ready_guard_conditions.indices);
+  EXPECT_EQ(nullptr, wait_set.ready_subscriptions.indices);
+
+  rcl_guard_condition_t guard_conditions[kNumEntities];
+  for (size_t i = 0u; i < kNumEntities; ++i) {
+    guard_conditions[i] = rcl_get_zero_initialized_guard_condition();
+    ret = rcl_guard_condition_init(
+      &guard_conditions[i], this->context_ptr, rcl_guard_condition_get_default_options());
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (size_t i = 0u; i < kNumEntities; ++i) {
+      ret = rcl_guard_condition_fini(&guard_conditions[i]);
+      EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    }
+  });
+  for (size_t i = 0u; i < kNumEntities; ++i) {
+    ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_conditions[i], NULL);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  ret = rcl_trigger_guard_condition(&guard_conditions[0]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_trigger_guard_condition(&guard_conditions[2]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ASSERT_EQ(2u, wait_set.ready_guard_conditions.size);
+  EXPECT_EQ(0u, wait_set.ready_guard_conditions.indices[0]);
+  EXPECT_EQ(2u, wait_set.ready_guard_conditions.indices[1]);
+  EXPECT_EQ(0u, wait_set.ready_subscriptions.size);
+
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, wait_set.ready_guard_conditions.size);
+}
+
+// Test that rcl_wait records statistics when they are enabled
+TEST_F(WaitSetTestFixture, wait_set_statistics) {
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.statistics = true;
+  rcl_ret_t ret = rcl_wait_set_init_with_options(
+    &wait_set, 0, 1, 0, 0, 0, 0, context_ptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  rcl_guard_condition_t guard_cond = rcl_get_zero_initialized_guard_condition();
+  ret = rcl_guard_condition_init(
+    &guard_cond, this->context_ptr, rcl_guard_condition_get_default_options());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_guard_condition_fini(&guard_cond);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  rcl_wait_set_statistics_t statistics;
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_wait_set_get_statistics(nullptr, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_wait_set_get_statistics(&wait_set, nullptr));
+  rcl_reset_error();
+
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_trigger_guard_condition(&guard_cond);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+
+  ret = rcl_wait_set_get_statistics(&wait_set, &statistics);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(2u, statistics.wait_count);
+  EXPECT_EQ(1u, statistics.entity_wakeups);
+  EXPECT_EQ(1u, statistics.timeout_wakeups);
+  EXPECT_EQ(0u, statistics.timer_wakeups);
+  EXPECT_EQ(0u, statistics.spurious_wakeups);
+  EXPECT_EQ(1u, statistics.ready_guard_conditions);
+  EXPECT_EQ(0u, statistics.ready_subscriptions);
+  // The timeout was spent blocked in the middleware.
+  EXPECT_GE(statistics.blocked_time, RCL_MS_TO_NS(10));
+  EXPECT_GE(statistics.processing_time, 0);
+  uint64_t blocked_waits = 0u;
+  uint64_t wakeups = 0u;
+  for (size_t i = 0u; i < RCL_WAIT_SET_STATISTICS_HISTOGRAM_SIZE; ++i) {
+    blocked_waits += statistics.blocked_time_histogram[i];
+    wakeups += statistics.ready_entities_histogram[i];
+  }
+  EXPECT_EQ(2u, blocked_waits);
+  EXPECT_EQ(2u, wakeups);
+  EXPECT_EQ(1u, statistics.ready_entities_histogram[0]);
+  EXPECT_EQ(1u, statistics.ready_entities_histogram[1]);
+
+  ret = rcl_wait_set_reset_statistics(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_get_statistics(&wait_set, &statistics);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, statistics.wait_count);
+  EXPECT_EQ(0, statistics.blocked_time);
+
+  // Statistics are not recorded unless enabled.
+  rcl_wait_set_t other_wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(
+    &other_wait_set, 0, 1, 0, 0, 0, 0, context_ptr, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(RCL_RET_ERROR, rcl_wait_set_get_statistics(&other_wait_set, &statistics));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_ERROR, rcl_wait_set_reset_statistics(&other_wait_set));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&other_wait_set)) << rcl_get_error_string().str;
+}
+
+// Test waiting until an absolute steady time
+TEST_F(WaitSetTestFixture, wait_until) {
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_ret_t ret =
+    rcl_wait_set_init(&wait_set, 0, 1, 0, 0, 0, 0, context_ptr, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  rcl_guard_condition_t guard_cond = rcl_get_zero_initialized_guard_condition();
+  ret = rcl_guard_condition_init(
+    &guard_cond, this->context_ptr, rcl_guard_condition_get_default_options());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_guard_condition_fini(&guard_cond);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, rcl_wait_until(nullptr, 0));
+  rcl_reset_error();
+
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  rcutils_time_point_value_t start;
+  ASSERT_EQ(RCUTILS_RET_OK, rcutils_steady_time_now(&start));
+  ret = rcl_wait_until(&wait_set, start + RCL_MS_TO_NS(10));
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+  rcutils_time_point_value_t now;
+  ASSERT_EQ(RCUTILS_RET_OK, rcutils_steady_time_now(&now));
+  EXPECT_GE(now, start + RCL_MS_TO_NS(10));
+
+  // A deadline in the past does not block.
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_until(&wait_set, start);
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+
+  // Something ready is reported before the deadline.
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_trigger_guard_condition(&guard_cond);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_until(&wait_set, -1);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(&guard_cond, wait_set.guard_conditions[0]);
+}
+
+// Test that a spinning wait set still wakes up, and still honours its timeout
+TEST_F(WaitSetTestFixture, spin_then_block) {
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.spin_budget = -1;
+  rcl_ret_t ret = rcl_wait_set_init_with_options(
+    &wait_set, 0, 1, 0, 0, 0, 0, context_ptr, &options);
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, ret);
+  rcl_reset_error();
+
+  options.spin_budget = RCL_MS_TO_NS(5);
+  options.adaptive_spin = true;
+  ret = rcl_wait_set_init_with_options(&wait_set, 0, 1, 0, 0, 0, 0, context_ptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  rcl_guard_condition_t guard_cond = rcl_get_zero_initialized_guard_condition();
+  ret = rcl_guard_condition_init(
+    &guard_cond, this->context_ptr, rcl_guard_condition_get_default_options());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_guard_condition_fini(&guard_cond);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+
+  // Nothing becomes ready, so the whole timeout elapses although part of it was spent spinning.
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(20));
+  std::chrono::nanoseconds waited = std::chrono::steady_clock::now() - before;
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+  EXPECT_GE(waited.count(), RCL_MS_TO_NS(20));
+  EXPECT_EQ(nullptr, wait_set.guard_conditions[0]);
+
+  // Triggering from another thread wakes the wait set up, whether it spins or blocks.
+  for (int i = 0; i < 5; ++i) {
+    ret = rcl_wait_set_clear(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    std::thread trigger_thread(
+      [&guard_cond]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        EXPECT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_cond));
+      });
+    ret = rcl_wait(&wait_set, RCL_S_TO_NS(1));
+    trigger_thread.join();
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+    EXPECT_EQ(&guard_cond, wait_set.guard_conditions[0]);
+  }
+
+  // A zero timeout never spins, and leaves the wait set as rmw_wait() does.
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, 0);
+  EXPECT_EQ(RCL_RET_TIMEOUT, ret) << rcl_get_error_string().str;
+}
+
+// Test that the ready entities are reported by priority, then deadline
+TEST_F(WaitSetTestFixture, prioritized_ready) {
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.priorities = true;
+  rcl_ret_t ret = rcl_wait_set_init_with_options(
+    &wait_set, 0, 4, 0, 0, 0, 0, context_ptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  rcl_guard_condition_t guard_conds[4];
+  for (rcl_guard_condition_t & guard_cond : guard_conds) {
+    guard_cond = rcl_get_zero_initialized_guard_condition();
+    ret = rcl_guard_condition_init(
+      &guard_cond, this->context_ptr, rcl_guard_condition_get_default_options());
+    ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    for (rcl_guard_condition_t & guard_cond : guard_conds) {
+      EXPECT_EQ(RCL_RET_OK, rcl_guard_condition_fini(&guard_cond)) << rcl_get_error_string().str;
+    }
+  });
+
+  // Nothing was added at this index yet.
+  ret = rcl_wait_set_set_priority(&wait_set, RCL_WAIT_SET_GUARD_CONDITION, 0, 1, 0);
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, ret);
+  rcl_reset_error();
+
+  for (rcl_guard_condition_t & guard_cond : guard_conds) {
+    ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  // Index 0 keeps the default priority, index 3 is not ready.
+  ret = rcl_wait_set_set_priority(&wait_set, RCL_WAIT_SET_GUARD_CONDITION, 1, 5, 100);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_set_priority(&wait_set, RCL_WAIT_SET_GUARD_CONDITION, 2, 5, 10);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_set_priority(&wait_set, RCL_WAIT_SET_GUARD_CONDITION, 3, 10, 0);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  for (size_t i = 0u; i < 3u; ++i) {
+    ret = rcl_trigger_guard_condition(&guard_conds[i]);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  }
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+
+  const rcl_wait_set_ready_entity_t * entities = nullptr;
+  size_t count = 0u;
+  ret = rcl_wait_set_get_prioritized_ready(&wait_set, &entities, &count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ASSERT_EQ(3u, count);
+  EXPECT_EQ(RCL_WAIT_SET_GUARD_CONDITION, entities[0].type);
+  EXPECT_EQ(2u, entities[0].index);
+  EXPECT_EQ(5, entities[0].priority);
+  EXPECT_EQ(10, entities[0].deadline);
+  EXPECT_EQ(1u, entities[1].index);
+  EXPECT_EQ(0u, entities[2].index);
+  EXPECT_EQ(RCL_WAIT_SET_DEFAULT_PRIORITY, entities[2].priority);
+  EXPECT_EQ(RCL_WAIT_SET_NO_DEADLINE, entities[2].deadline);
+
+  // Clearing the wait set also resets the priorities.
+  ret = rcl_wait_set_clear(&wait_set);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_get_prioritized_ready(&wait_set, &entities, &count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(0u, count);
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_conds[2], NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_trigger_guard_condition(&guard_conds[2]);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ret = rcl_wait_set_get_prioritized_ready(&wait_set, &entities, &count);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  ASSERT_EQ(1u, count);
+  EXPECT_EQ(RCL_WAIT_SET_DEFAULT_PRIORITY, entities[0].priority);
+
+  // Priorities are not available unless enabled.
+  rcl_wait_set_t other_wait_set = rcl_get_zero_initialized_wait_set();
+  ret = rcl_wait_set_init(
+    &other_wait_set, 0, 1, 0, 0, 0, 0, context_ptr, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  EXPECT_EQ(
+    RCL_RET_ERROR,
+    rcl_wait_set_set_priority(&other_wait_set, RCL_WAIT_SET_GUARD_CONDITION, 0, 1, 0));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_ERROR, rcl_wait_set_get_prioritized_ready(&other_wait_set, &entities, &count));
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&other_wait_set)) << rcl_get_error_string().str;
+}
+
+// Test that removing from a wait set which is not persistent fails
+TEST_F(WaitSetTestFixture, virtual_time) {
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  rcl_clock_t steady_clock;
+  ASSERT_EQ(RCL_RET_OK, rcl_steady_clock_init(&steady_clock, &allocator));
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_options_t options = rcl_wait_set_get_default_options();
+  options.virtual_time_clock = &steady_clock;
+  rcl_ret_t ret = rcl_wait_set_init_with_options(
+    &wait_set, 0, 1, 2, 0, 0, 0, context_ptr, &options);
+  EXPECT_EQ(RCL_RET_INVALID_ARGUMENT, ret);
+  rcl_reset_error();
+  EXPECT_EQ(RCL_RET_OK, rcl_steady_clock_fini(&steady_clock));
+
+  rcl_clock_t clock;
+  ASSERT_EQ(RCL_RET_OK, rcl_ros_clock_init(&clock, &allocator)) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_ros_clock_fini(&clock)) << rcl_get_error_string().str;
+  });
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(&clock, RCL_S_TO_NS(1)));
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(&clock));
+
+  options.virtual_time_clock = &clock;
+  ret = rcl_wait_set_init_with_options(&wait_set, 0, 1, 2, 0, 0, 0, context_ptr, &options);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set)) << rcl_get_error_string().str;
+  });
+  rcl_timer_t fast_timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &fast_timer, &clock, context_ptr, RCL_MS_TO_NS(100), nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&fast_timer)) << rcl_get_error_string().str;
+  });
+  rcl_timer_t slow_timer = rcl_get_zero_initialized_timer();
+  ret = rcl_timer_init2(
+    &slow_timer, &clock, context_ptr, RCL_MS_TO_NS(250), nullptr, allocator, true);
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_timer_fini(&slow_timer)) << rcl_get_error_string().str;
+  });
+  rcl_guard_condition_t guard_cond = rcl_get_zero_initialized_guard_condition();
+  ret = rcl_guard_condition_init(
+    &guard_cond, this->context_ptr, rcl_guard_condition_get_default_options());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    EXPECT_EQ(RCL_RET_OK, rcl_guard_condition_fini(&guard_cond)) << rcl_get_error_string().str;
+  });
+
+  auto wait = [&]() {
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL));
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &fast_timer, NULL));
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_add_timer(&wait_set, &slow_timer, NULL));
+      return rcl_wait(&wait_set, RCL_S_TO_NS(10));
+    };
+  auto now = [&clock]() {
+      rcl_time_point_value_t now = 0;
+      EXPECT_EQ(RCL_RET_OK, rcl_clock_get_now(&clock, &now));
+      return now;
+    };
+
+  // Each wait jumps straight to the next timer deadline instead of sleeping.
+  struct
+  {
+    rcl_time_point_value_t deadline;
+    rcl_timer_t * timer;
+    size_t index;
+  } steps[] = {
+    {RCL_MS_TO_NS(1100), &fast_timer, 0u},
+    {RCL_MS_TO_NS(1200), &fast_timer, 0u},
+    {RCL_MS_TO_NS(1250), &slow_timer, 1u},
+    {RCL_MS_TO_NS(1300), &fast_timer, 0u},
+  };
+  std::chrono::steady_clock::time_point before = std::chrono::steady_clock::now();
+  for (const auto & step : steps) {
+    ASSERT_EQ(RCL_RET_OK, wait()) << rcl_get_error_string().str;
+    EXPECT_EQ(step.deadline, now());
+    EXPECT_EQ(step.timer, wait_set.timers[step.index]);
+    EXPECT_EQ(nullptr, wait_set.timers[1u - step.index]);
+    EXPECT_EQ(nullptr, wait_set.guard_conditions[0]);
+    // A timer which is still ready keeps the time from advancing.
+    if (RCL_MS_TO_NS(1100) == step.deadline) {
+      ASSERT_EQ(RCL_RET_OK, wait()) << rcl_get_error_string().str;
+      EXPECT_EQ(step.deadline, now());
+      EXPECT_EQ(step.timer, wait_set.timers[step.index]);
+    }
+    ASSERT_EQ(RCL_RET_OK, rcl_timer_call(step.timer)) << rcl_get_error_string().str;
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::seconds(1));
+
+  // Anything already ready is returned without advancing the time.
+  ASSERT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_cond));
+  const rcl_time_point_value_t before_trigger = now();
+  ASSERT_EQ(RCL_RET_OK, wait()) << rcl_get_error_string().str;
+  EXPECT_EQ(before_trigger, now());
+  EXPECT_EQ(&guard_cond, wait_set.guard_conditions[0]);
+}
+
+TEST_F(WaitSetTestFixture, remove_from_non_persistent_wait_set) {
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_ret_t ret =
+    rcl_wait_set_init(&wait_set, 0, 1, 0, 0, 0, 0, context_ptr, rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_wait_set_fini(&wait_set);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  rcl_guard_condition_t guard_cond = rcl_get_zero_initialized_guard_condition();
+  ret = rcl_guard_condition_init(
+    &guard_cond, this->context_ptr, rcl_guard_condition_get_default_options());
+  ASSERT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  OSRF_TESTING_TOOLS_CPP_SCOPE_EXIT(
+  {
+    ret = rcl_guard_condition_fini(&guard_cond);
+    EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+  });
+  ret = rcl_wait_set_add_guard_condition(&wait_set, &guard_cond, NULL);
+  EXPECT_EQ(RCL_RET_OK, ret) << rcl_get_error_string().str;
+
+  EXPECT_EQ(
+    RCL_RET_WAIT_SET_INVALID, rcl_wait_set_remove_guard_condition(&wait_set, &guard_cond));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_wait_set_remove_guard_condition(nullptr, &guard_cond));
+  rcl_reset_error();
+  EXPECT_EQ(
+    RCL_RET_INVALID_ARGUMENT, rcl_wait_set_init_with_options(
+      &wait_set, 0, 1, 0, 0, 0, 0, context_ptr, nullptr));
+  rcl_reset_error();
+}
+
 // Extra invalid arguments not tested
 TEST_F(WaitSetTestFixture, wait_set_valid_arguments) {
   rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();